@@ -605,8 +605,10 @@ public:
             assert(!mask);
 
             auto rule = [&](Value *inop, Value *newip) -> Value * {
-              Value *shadow = BuilderZ.CreateICmpNE(
-                  gutils->getNewFromOriginal(I.getOperand(0)), inop);
+              Value *shadow = gutils->getRuntimeActivityFlag(I.getOperand(0));
+              if (!shadow)
+                shadow = BuilderZ.CreateICmpNE(
+                    gutils->getNewFromOriginal(I.getOperand(0)), inop);
               newip = BuilderZ.CreateSelect(
                   shadow, newip, Constant::getNullValue(newip->getType()));
               return newip;
@@ -846,11 +848,13 @@ public:
 
             if (!gutils->isConstantValue(I.getOperand(0))) {
               if (EnzymeRuntimeActivityCheck && !merge) {
-                Value *shadow = Builder2.CreateICmpNE(
-                    lookup(gutils->getNewFromOriginal(I.getOperand(0)),
-                           Builder2),
-                    lookup(gutils->invertPointerM(I.getOperand(0), Builder2),
-                           Builder2));
+                Value *shadow = gutils->getRuntimeActivityFlag(I.getOperand(0));
+                if (!shadow)
+                  shadow = Builder2.CreateICmpNE(
+                      lookup(gutils->getNewFromOriginal(I.getOperand(0)),
+                             Builder2),
+                      lookup(gutils->invertPointerM(I.getOperand(0), Builder2),
+                             Builder2));
 
                 BasicBlock *current = Builder2.GetInsertBlock();
                 BasicBlock *conditional = gutils->addReverseBlock(
@@ -9447,6 +9451,7 @@ public:
     }
 
     Value *tape = nullptr;
+    Value *tapeFrame = nullptr;
     CallInst *augmentcall = nullptr;
     Value *cachereplace = nullptr;
 
@@ -9547,6 +9552,33 @@ public:
               TR.analyzer.interprocedural, /*return is used*/ subretused,
               shadowReturnUsed, nextTypeInfo, overwritten_args, false,
               gutils->getWidth(), gutils->AtomicAdd);
+          // A combined derivative outlives both passes of the call, so the
+          // tape of a recursive callee can be kept here instead of in a
+          // malloc. Only this outermost level gets its own forward pass, the
+          // recursion within it still uses the anonymous tape.
+          if (Mode == DerivativeMode::ReverseModeCombined &&
+              EnzymeLiftSubcallTape && subdata->tapeType &&
+              subdata->isComplete) {
+            auto &byValue = gutils->Logic.CreateAugmentedPrimal(
+                cast<Function>(called), subretType, argsInverted,
+                TR.analyzer.interprocedural, /*return is used*/ subretused,
+                shadowReturnUsed, nextTypeInfo, overwritten_args, false,
+                gutils->getWidth(), gutils->AtomicAdd, /*omp*/ false,
+                /*tapeByValue*/ true);
+            // Both share the reverse pass, which reads the tape by layout
+            Type *byValueTape = nullptr;
+            auto tidx = byValue.returns.find(AugmentedStruct::Tape);
+            if (!byValue.tapeType && tidx != byValue.returns.end())
+              byValueTape = (tidx->second == -1)
+                                ? byValue.fn->getReturnType()
+                                : cast<StructType>(byValue.fn->getReturnType())
+                                      ->getElementType(tidx->second);
+            if (byValueTape == subdata->tapeType &&
+                byValue.tapeIndices == subdata->tapeIndices)
+              subdata = &byValue;
+            else
+              gutils->Logic.eraseAugmentedPrimal(byValue);
+          }
           if (Mode == DerivativeMode::ReverseModePrimal) {
             assert(augmentedReturn);
             auto subaugmentations =
@@ -9856,7 +9888,10 @@ public:
         truetape->setMetadata("enzyme_mustcache",
                               MDNode::get(truetape->getContext(), {}));
 
-        CreateDealloc(BuilderZ, tape);
+        if (fnandtapetype->tapeOnStack)
+          tapeFrame = tape;
+        else
+          freeAnonymousTape(BuilderZ, tape);
         tape = truetape;
       }
     } else {
@@ -10020,6 +10055,12 @@ public:
 #endif
     diffes->setCallingConv(call.getCallingConv());
     diffes->setDebugLoc(gutils->getNewFromOriginal(call.getDebugLoc()));
+    // The frame and the ones pushed by calls nested within it were consumed
+    if (tapeFrame)
+      Builder2.CreateCall(getTapePopFn(*gutils->newFunc->getParent()),
+                          Builder2.CreatePointerCast(
+                              gutils->lookupM(tapeFrame, Builder2),
+                              Type::getInt8PtrTy(call.getContext())));
 #if LLVM_VERSION_MAJOR >= 9
     for (auto pair : gradByVal) {
       diffes->addParamAttr(pair.first, Attribute::getWithByValType(
@@ -180,6 +180,8 @@ void EnzymeLogicErasePreprocessedFunctions(EnzymeLogicRef Ref) {
   auto &Logic = eunwrap(Ref);
   for (const auto &pair : Logic.PPC.cache)
     pair.second->eraseFromParent();
+  for (const auto &pair : Logic.PPC.commonCache)
+    pair.second->eraseFromParent();
 }
 
 void FreeEnzymeLogic(EnzymeLogicRef Ref) { delete (EnzymeLogic *)Ref; }
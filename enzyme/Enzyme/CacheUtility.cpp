@@ -27,6 +27,8 @@
 #include "CacheUtility.h"
 #include "FunctionUtils.h"
 
+#include "llvm/IR/MDBuilder.h"
+
 using namespace llvm;
 
 /// Pack 8 bools together in a single byte
@@ -39,6 +41,31 @@ llvm::cl::opt<bool> EnzymeZeroCache("enzyme-zero-cache", cl::init(false),
                                     cl::Hidden,
                                     cl::desc("Zero initialize the cache"));
 
+llvm::cl::opt<int> EnzymeCacheFloatWidth(
+    "enzyme-cache-fp-width", cl::init(0), cl::Hidden,
+    cl::desc("Store cached floating point values wider than this many bits "
+             "truncated to a float of this width (32 or 16), 0 disables"));
+
+llvm::cl::opt<bool>
+    EnzymeCacheBFloat("enzyme-cache-bfloat", cl::init(false), cl::Hidden,
+                      cl::desc("Use bfloat rather than half for 16 bit "
+                               "floating point cache storage"));
+
+llvm::cl::opt<bool> EnzymeOutOfCoreCache(
+    "enzyme-out-of-core-cache", cl::init(false), cl::Hidden,
+    cl::desc("Allocate statically sized loop caches with "
+             "__enzyme_spill_alloc and prefetch them in reverse order"));
+
+llvm::cl::opt<bool> EnzymeTapeArena(
+    "enzyme-tape-arena", cl::init(false), cl::Hidden,
+    cl::desc("Allocate loop caches and anonymous tapes from the caller "
+             "provided arena of include/enzyme/tapearena.h"));
+
+llvm::cl::opt<bool> EnzymeProgressiveFreeCache(
+    "enzyme-progressive-free-cache", cl::init(false), cl::Hidden,
+    cl::desc("Allocate the caches of nested loops once per iteration of the "
+             "outermost loop, freeing each as its reverse completes"));
+
 llvm::cl::opt<bool>
     EnzymePrintPerf("enzyme-print-perf", cl::init(false), cl::Hidden,
                     cl::desc("Enable Enzyme to print performance info"));
@@ -51,6 +78,136 @@ llvm::cl::opt<bool> EfficientMaxCache(
 
 CacheUtility::~CacheUtility() {}
 
+MDNode *CacheUtility::getCacheAliasScope() {
+  if (!CacheAliasScope) {
+    MDBuilder MDB(newFunc->getContext());
+    MDNode *domain = MDB.createAnonymousAliasScopeDomain(
+        (" cache: %" + newFunc->getName()).str());
+    CacheAliasScope = MDB.createAnonymousAliasScope(domain, "cache");
+  }
+  return CacheAliasScope;
+}
+
+void CacheUtility::setCacheAliasScope(Instruction *I) {
+  auto scope = MDNode::get(I->getContext(), {getCacheAliasScope()});
+  I->setMetadata(
+      LLVMContext::MD_alias_scope,
+      MDNode::concatenate(I->getMetadata(LLVMContext::MD_alias_scope), scope));
+}
+
+Type *CacheUtility::getCompressedCacheType(Type *T) const {
+  if (EnzymeCacheFloatWidth == 0 || !T->getScalarType()->isFloatingPointTy())
+    return nullptr;
+  if (T->getScalarSizeInBits() <= (unsigned)EnzymeCacheFloatWidth)
+    return nullptr;
+  Type *ST;
+  switch (EnzymeCacheFloatWidth) {
+  case 32:
+    ST = Type::getFloatTy(T->getContext());
+    break;
+  case 16:
+#if LLVM_VERSION_MAJOR >= 11
+    if (EnzymeCacheBFloat) {
+      ST = Type::getBFloatTy(T->getContext());
+      break;
+    }
+#endif
+    ST = Type::getHalfTy(T->getContext());
+    break;
+  default:
+    llvm::errs() << "unsupported cache floating point width "
+                 << EnzymeCacheFloatWidth << "\n";
+    llvm_unreachable("unsupported cache floating point width");
+  }
+  if (auto VT = dyn_cast<VectorType>(T))
+#if LLVM_VERSION_MAJOR >= 11
+    return VectorType::get(ST, VT->getElementCount());
+#else
+    return VectorType::get(ST, VT->getNumElements());
+#endif
+  return ST;
+}
+
+static Function *getTapeRuntimeFn(Module &M, StringRef Name, FunctionType *FT) {
+#if LLVM_VERSION_MAJOR >= 9
+  Function *F = cast<Function>(M.getOrInsertFunction(Name, FT).getCallee());
+#else
+  Function *F = cast<Function>(M.getOrInsertFunction(Name, FT));
+#endif
+  F->addFnAttr(Attribute::NoUnwind);
+  return F;
+}
+
+Function *getSpillAllocFn(Module &M) {
+  auto &Ctx = M.getContext();
+  Function *F = getTapeRuntimeFn(
+      M, "__enzyme_spill_alloc",
+      FunctionType::get(Type::getInt8PtrTy(Ctx), {Type::getInt64Ty(Ctx)},
+                        false));
+#if LLVM_VERSION_MAJOR >= 14
+  F->addRetAttr(Attribute::NoAlias);
+#else
+  F->addAttribute(AttributeList::ReturnIndex, Attribute::NoAlias);
+#endif
+  return F;
+}
+
+Function *getSpillFreeFn(Module &M) {
+  auto &Ctx = M.getContext();
+  return getTapeRuntimeFn(M, "__enzyme_spill_free",
+                          FunctionType::get(Type::getVoidTy(Ctx),
+                                            {Type::getInt8PtrTy(Ctx)}, false));
+}
+
+Function *getSpillPrefetchFn(Module &M) {
+  auto &Ctx = M.getContext();
+  Type *types[] = {Type::getInt8PtrTy(Ctx), Type::getInt8PtrTy(Ctx),
+                   Type::getInt64Ty(Ctx)};
+  Function *F =
+      getTapeRuntimeFn(M, "__enzyme_spill_prefetch",
+                       FunctionType::get(Type::getVoidTy(Ctx), types, false));
+  // Reads the length of the mapping in its header and otherwise only advises
+  // the kernel, the contents of the cache are unchanged
+  F->addFnAttr(Attribute::InaccessibleMemOrArgMemOnly);
+#if LLVM_VERSION_MAJOR >= 12
+  F->addFnAttr(Attribute::WillReturn);
+#endif
+  F->addParamAttr(0, Attribute::NoCapture);
+  F->addParamAttr(0, Attribute::ReadOnly);
+  F->addParamAttr(1, Attribute::NoCapture);
+  F->addParamAttr(1, Attribute::ReadNone);
+  return F;
+}
+
+Function *getArenaAllocFn(Module &M) {
+  auto &Ctx = M.getContext();
+  Function *F = getTapeRuntimeFn(
+      M, "__enzyme_tape_arena_alloc",
+      FunctionType::get(Type::getInt8PtrTy(Ctx), {Type::getInt64Ty(Ctx)},
+                        false));
+#if LLVM_VERSION_MAJOR >= 14
+  F->addRetAttr(Attribute::NoAlias);
+#else
+  F->addAttribute(AttributeList::ReturnIndex, Attribute::NoAlias);
+#endif
+  return F;
+}
+
+Function *getArenaReallocFn(Module &M) {
+  auto &Ctx = M.getContext();
+  Type *types[] = {Type::getInt8PtrTy(Ctx), Type::getInt64Ty(Ctx)};
+  return getTapeRuntimeFn(
+      M, "__enzyme_tape_arena_realloc",
+      FunctionType::get(Type::getInt8PtrTy(Ctx), types, false));
+}
+
+Function *getArenaFreeFn(Module &M) {
+  auto &Ctx = M.getContext();
+  return getTapeRuntimeFn(M, "__enzyme_tape_arena_free",
+                          FunctionType::get(Type::getVoidTy(Ctx),
+                                            {Type::getInt8PtrTy(Ctx)}, false));
+}
+
 /// Erase this instruction both from LLVM modules and any local data-structures
 void CacheUtility::erase(Instruction *I) {
   assert(I);
@@ -64,6 +221,8 @@ void CacheUtility::erase(Instruction *I) {
     scopeFrees.erase(AI);
     scopeAllocs.erase(AI);
     scopeInstructions.erase(AI);
+    CompressedCaches.erase(AI);
+    OutOfCoreCaches.erase(AI);
   }
   scopeMap.erase(I);
   SE.eraseValueFromMap(I);
@@ -829,9 +988,18 @@ AllocaInst *CacheUtility::createCacheForScope(LimitContext ctx, Type *T,
     alloc->setAlignment(align);
 #endif
   }
-  if (EnzymeZeroCache && sublimits.size() == 0)
-    scopeInstructions[alloc].push_back(
-        entryBuilder.CreateStore(Constant::getNullValue(types.back()), alloc));
+  if (EnzymeZeroCache && sublimits.size() == 0) {
+    auto zerostore =
+        entryBuilder.CreateStore(Constant::getNullValue(types.back()), alloc);
+    setCacheAliasScope(zerostore);
+    scopeInstructions[alloc].push_back(zerostore);
+  }
+
+  // Only the outermost chunk is spilled, as it is allocated once for the
+  // whole scope rather than once per iteration of an enclosing loop
+  if (EnzymeOutOfCoreCache && sublimits.size() != 0 &&
+      sublimits.back().second.back().first.maxLimit)
+    OutOfCoreCaches.insert(alloc);
 
   Value *storeInto = alloc;
 
@@ -886,9 +1054,37 @@ AllocaInst *CacheUtility::createCacheForScope(LimitContext ctx, Type *T,
       // Statically allocate memory for all iterations if possible
       if (sublimits[i].second.back().first.maxLimit) {
         Instruction *ZeroInst = nullptr;
-        Value *firstallocation = CreateAllocation(
-            allocationBuilder, myType, size, name + "_malloccache", &malloccall,
-            /*ZeroMem*/ EnzymeZeroCache ? &ZeroInst : nullptr);
+        Value *firstallocation;
+        if (OutOfCoreCaches.count(alloc) && i == (int)sublimits.size() - 1) {
+          // Fresh mappings are zero, so no memset is required
+          malloccall = allocationBuilder.CreateCall(
+              getSpillAllocFn(*newFunc->getParent()),
+              allocationBuilder.CreateMul(size, byteSizeOfType, "",
+                                          /*NUW*/ true, /*NSW*/ true),
+              name + "_spillcache");
+          firstallocation = allocationBuilder.CreatePointerCast(
+              malloccall, types[i + 1], name + "_malloccache");
+        } else if (EnzymeTapeArena) {
+          Value *bytes = allocationBuilder.CreateMul(
+              size, byteSizeOfType, "", /*NUW*/ true, /*NSW*/ true);
+          malloccall = allocationBuilder.CreateCall(
+              getArenaAllocFn(*newFunc->getParent()), bytes,
+              name + "_arenacache");
+          if (EnzymeZeroCache)
+            ZeroInst = allocationBuilder.CreateMemSet(
+                malloccall, allocationBuilder.getInt8(0), bytes,
+#if LLVM_VERSION_MAJOR >= 10
+                MaybeAlign(alignSize));
+#else
+                alignSize);
+#endif
+          firstallocation = allocationBuilder.CreatePointerCast(
+              malloccall, types[i + 1], name + "_malloccache");
+        } else
+          firstallocation = CreateAllocation(
+              allocationBuilder, myType, size, name + "_malloccache",
+              &malloccall,
+              /*ZeroMem*/ EnzymeZeroCache ? &ZeroInst : nullptr);
 
         scopeInstructions[alloc].push_back(malloccall);
         if (firstallocation != malloccall)
@@ -956,7 +1152,9 @@ AllocaInst *CacheUtility::createCacheForScope(LimitContext ctx, Type *T,
         CallInst *realloccall = nullptr;
         auto reallocation = CreateReAllocation(
             build, allocation, myType, containedloops.back().first.incvar, size,
-            name + "_realloccache", &realloccall, EnzymeZeroCache && i == 0);
+            name + "_realloccache", &realloccall, EnzymeZeroCache && i == 0,
+            EnzymeTapeArena ? getArenaReallocFn(*newFunc->getParent())
+                            : nullptr);
 
         scopeInstructions[alloc].push_back(cast<Instruction>(reallocation));
 
@@ -1163,6 +1361,12 @@ CacheUtility::SubLimitType CacheUtility::getSubLimits(bool inForwardPass,
       // For dynamic loops, the preheader is now forced to be the preheader
       // of that loop
       allocationPreheaders[i] = contexts[i].preheader;
+    } else if (EnzymeProgressiveFreeCache &&
+               (unsigned)i == contexts.size() - 2 &&
+               !(ctx.ForceSingleIteration && i == 0)) {
+      // Start a new chunk within every iteration of the outermost loop, so
+      // that the reverse pass can free it once that iteration is reversed
+      allocationPreheaders[i] = contexts[i].preheader;
     } else {
       // Otherwise try to use the preheader of the loop just outside this
       // one to allocate all iterations across both loops together
@@ -1406,6 +1610,7 @@ void CacheUtility::storeInstructionInCache(LimitContext ctx,
 #else
       Value *loadChunk = v.CreateLoad(loc);
 #endif
+      setCacheAliasScope(cast<LoadInst>(loadChunk));
       auto cleared = v.CreateAnd(loadChunk, mask);
 
       auto toset = v.CreateShl(
@@ -1415,6 +1620,20 @@ void CacheUtility::storeInstructionInCache(LimitContext ctx,
     }
   }
 
+  // Compressed caches hold a narrower type than the value itself, round or
+  // truncate on the way in. The truncation is recorded with the store so
+  // that both are removed together if the cache is replaced.
+  auto found = CompressedCaches.find(cache);
+  bool compressed = found != CompressedCaches.end();
+  if (compressed) {
+    if (val->getType()->isIntOrIntVectorTy())
+      tostore = v.CreateTrunc(val, found->second);
+    else
+      tostore = v.CreateFPTrunc(val, found->second);
+    if (auto I = dyn_cast<Instruction>(tostore))
+      scopeInstructions[cache].push_back(I);
+  }
+
 #if LLVM_VERSION_MAJOR >= 15
   if (tostore->getContext().supportsTypedPointers()) {
 #endif
@@ -1431,7 +1650,7 @@ void CacheUtility::storeInstructionInCache(LimitContext ctx,
 
   // If the value stored doesnt change (per efficient bool cache),
   // mark it as invariant
-  if (tostore == val) {
+  if (tostore == val || compressed) {
     if (ValueInvariantGroups.find(cache) == ValueInvariantGroups.end()) {
       MDNode *invgroup = MDNode::getDistinct(cache->getContext(), {});
       ValueInvariantGroups[cache] = invgroup;
@@ -1446,10 +1665,14 @@ void CacheUtility::storeInstructionInCache(LimitContext ctx,
                        ctx.Block->getParent()
                                ->getParent()
                                ->getDataLayout()
-                               .getTypeAllocSizeInBits(val->getType()) /
+                               .getTypeAllocSizeInBits(tostore->getType()) /
                            8);
   unsigned align = getCacheAlignment((unsigned)byteSizeOfType->getZExtValue());
-  storeinst->setMetadata(LLVMContext::MD_tbaa, TBAA);
+  // The access type of the original value does not describe the narrowed
+  // storage.
+  if (!compressed)
+    storeinst->setMetadata(LLVMContext::MD_tbaa, TBAA);
+  setCacheAliasScope(storeinst);
 #if LLVM_VERSION_MAJOR >= 10
   storeinst->setAlignment(Align(align));
 #else
@@ -1602,6 +1825,26 @@ Value *CacheUtility::getCachePointer(bool inForwardPass, IRBuilder<> &BuilderM,
       if (storeInInstructionsMap && isa<AllocaInst>(cache))
         scopeInstructions[cast<AllocaInst>(cache)].push_back(
             cast<Instruction>(next));
+
+      // The reverse pass walks a spilled chunk from its end, let the runtime
+      // read ahead of it. This costs a call per lookup, which the runtime
+      // returns from after a few arithmetic operations unless the element
+      // is the first one read in its chunk.
+      if (!inForwardPass && !storeInInstructionsMap &&
+          i == (int)sublimits.size() - 1 && isa<AllocaInst>(cache) &&
+          OutOfCoreCaches.count(cast<AllocaInst>(cache))) {
+        auto GEP = cast<GetElementPtrInst>(next);
+        auto i8p = Type::getInt8PtrTy(next->getContext());
+        Value *args[] = {
+            BuilderM.CreatePointerCast(GEP->getPointerOperand(), i8p),
+            BuilderM.CreatePointerCast(GEP, i8p),
+            ConstantInt::get(
+                Type::getInt64Ty(next->getContext()),
+                newFunc->getParent()->getDataLayout().getTypeAllocSizeInBits(
+                    GEP->getResultElementType()) /
+                    8)};
+        BuilderM.CreateCall(getSpillPrefetchFn(*newFunc->getParent()), args);
+      }
     }
     assert(next->getType()->isPointerTy());
   }
@@ -1614,9 +1857,17 @@ llvm::Value *CacheUtility::loadFromCachePointer(Type *T,
                                                 llvm::IRBuilder<> &BuilderM,
                                                 llvm::Value *cptr,
                                                 llvm::Value *cache) {
+  // Compressed caches are read at their storage type and widened below
+  Type *ST = T;
+  if (auto AI = dyn_cast<AllocaInst>(cache)) {
+    auto found = CompressedCaches.find(AI);
+    if (found != CompressedCaches.end())
+      ST = found->second;
+  }
+
   // Retrieve the actual result
 #if LLVM_VERSION_MAJOR > 7
-  auto result = BuilderM.CreateLoad(T, cptr);
+  auto result = BuilderM.CreateLoad(ST, cptr);
 #else
   auto result = BuilderM.CreateLoad(cptr);
 #endif
@@ -1629,6 +1880,7 @@ llvm::Value *CacheUtility::loadFromCachePointer(Type *T,
   CacheLookups.insert(result);
   result->setMetadata(LLVMContext::MD_invariant_group,
                       ValueInvariantGroups[cache]);
+  setCacheAliasScope(result);
   ConstantInt *byteSizeOfType = ConstantInt::get(
       Type::getInt64Ty(cache->getContext()),
       newFunc->getParent()->getDataLayout().getTypeAllocSizeInBits(
@@ -1641,6 +1893,12 @@ llvm::Value *CacheUtility::loadFromCachePointer(Type *T,
   result->setAlignment(align);
 #endif
 
+  if (ST != T) {
+    // Narrowed integers were proven non-negative at their full width
+    if (T->isIntOrIntVectorTy())
+      return BuilderM.CreateZExt(result, T);
+    return BuilderM.CreateFPExt(result, T);
+  }
   return result;
 }
 
@@ -1657,8 +1915,14 @@ Value *CacheUtility::lookupValueFromCache(
 
   // Optionally apply the additional offset
   if (extraOffset) {
+    Type *ST = T;
+    if (auto AI = dyn_cast<AllocaInst>(cache)) {
+      auto found = CompressedCaches.find(AI);
+      if (found != CompressedCaches.end())
+        ST = found->second;
+    }
 #if LLVM_VERSION_MAJOR > 7
-    cptr = BuilderM.CreateGEP(T, cptr, extraOffset);
+    cptr = BuilderM.CreateGEP(ST, cptr, extraOffset);
 #else
     cptr = BuilderM.CreateGEP(cptr, extraOffset);
 #endif
@@ -45,8 +45,33 @@ extern "C" {
 extern llvm::cl::opt<bool> EfficientBoolCache;
 
 extern llvm::cl::opt<bool> EnzymeZeroCache;
+
+/// Store cached floating point values wider than this many bits truncated to
+/// a floating point type of this width
+extern llvm::cl::opt<int> EnzymeCacheFloatWidth;
+
+/// Back statically sized loop caches by file mappings from the tape spilling
+/// runtime rather than by malloc
+extern llvm::cl::opt<bool> EnzymeOutOfCoreCache;
+
+/// Split loop caches below the outermost loop of a nest so they are freed
+/// progressively during the reverse pass
+extern llvm::cl::opt<bool> EnzymeProgressiveFreeCache;
+
+/// Carve loop caches and anonymous tapes out of a caller provided arena
+extern llvm::cl::opt<bool> EnzymeTapeArena;
 }
 
+/// Declarations of the tape spilling runtime, see include/enzyme/tapespill.h
+llvm::Function *getSpillAllocFn(llvm::Module &M);
+llvm::Function *getSpillFreeFn(llvm::Module &M);
+llvm::Function *getSpillPrefetchFn(llvm::Module &M);
+
+/// Declarations of the tape arena runtime, see include/enzyme/tapearena.h
+llvm::Function *getArenaAllocFn(llvm::Module &M);
+llvm::Function *getArenaReallocFn(llvm::Module &M);
+llvm::Function *getArenaFreeFn(llvm::Module &M);
+
 /// Container for all loop information to synthesize gradients
 struct LoopContext {
   /// Canonical induction variable of the loop
@@ -284,6 +309,13 @@ private:
   std::map<llvm::Value *, llvm::MDNode *> ValueInvariantGroups;
 
 protected:
+  /// Alias scope of the memory holding cached values. Accesses Enzyme
+  /// creates to primal or shadow memory are marked as not aliasing it.
+  llvm::MDNode *CacheAliasScope = nullptr;
+  llvm::MDNode *getCacheAliasScope();
+  /// Mark an access to cache memory with the cache alias scope
+  void setCacheAliasScope(llvm::Instruction *I);
+
   /// A map of values being cached to their underlying allocation/limit context
   std::map<llvm::Value *,
            std::pair<llvm::AssertingVH<llvm::AllocaInst>, LimitContext>>
@@ -308,12 +340,24 @@ protected:
            llvm::SmallVector<llvm::AssertingVH<llvm::CallInst>, 4>>
       scopeAllocs;
 
+  /// A map of allocations whose cached floating point or integer values are
+  /// stored truncated to the type they are stored as. Integers are zero
+  /// extended on lookup.
+  std::map<llvm::AllocaInst *, llvm::Type *> CompressedCaches;
+
+  /// Caches whose outermost chunk is allocated by the tape spilling runtime
+  llvm::SmallPtrSet<llvm::AllocaInst *, 4> OutOfCoreCaches;
+
   /// Perform the final load from the cache, applying requisite invariant
   /// group and alignment
   llvm::Value *loadFromCachePointer(llvm::Type *T, llvm::IRBuilder<> &BuilderM,
                                     llvm::Value *cptr, llvm::Value *cache);
 
 public:
+  /// Return the type values of Type T are stored as in a compressed cache, or
+  /// null if they are stored at full precision
+  llvm::Type *getCompressedCacheType(llvm::Type *T) const;
+
   /// Create a cache of Type T at the given LimitContext. If allocateInternal is
   /// set this will allocate the requesite memory. If extraSize is set,
   /// allocations will be a factor of extraSize larger
@@ -572,7 +572,19 @@ CallInst *DiffeGradientUtils::freeCache(BasicBlock *forwardPreheader,
   forfree->setAlignment(align);
 #endif
 
-  CallInst *ci = CreateDealloc(tbuild, forfree);
+  CallInst *ci;
+  if (OutOfCoreCaches.count(alloc) && i == (int)sublimits.size() - 1)
+    ci = tbuild.CreateCall(
+        getSpillFreeFn(*newFunc->getParent()),
+        tbuild.CreatePointerCast(forfree,
+                                 Type::getInt8PtrTy(forfree->getContext())));
+  else if (EnzymeTapeArena)
+    ci = tbuild.CreateCall(
+        getArenaFreeFn(*newFunc->getParent()),
+        tbuild.CreatePointerCast(forfree,
+                                 Type::getInt8PtrTy(forfree->getContext())));
+  else
+    ci = CreateDealloc(tbuild, forfree);
   if (ci) {
     if (newFunc->getSubprogram())
       ci->setDebugLoc(DILocation::get(newFunc->getContext(), 0, 0,
@@ -911,6 +923,7 @@ void DiffeGradientUtils::addToInvertedPtrDiffe(Instruction *orig,
         if (j != (ssize_t)idx)
           MDs.push_back(getDerivativeAliasScope(origptr, j));
       }
+      MDs.push_back(getCacheAliasScope());
       if (auto MD = orig->getMetadata(LLVMContext::MD_noalias)) {
         auto MDN = cast<MDNode>(MD);
         for (auto &o : MDN->operands())
@@ -35,6 +35,7 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/IR/ValueMap.h"
 
 #include "llvm/Passes/PassBuilder.h"
 
@@ -53,6 +54,7 @@
 
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/FunctionComparator.h"
 #if LLVM_VERSION_MAJOR >= 11
 #include "llvm/Analysis/InlineAdvisor.h"
 #include "llvm/IR/AbstractCallSite.h"
@@ -75,6 +77,15 @@
 
 #include "llvm/Transforms/Utils.h"
 
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/Scalar/EarlyCSE.h"
+#include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Scalar/LICM.h"
+#include "llvm/Transforms/Scalar/LoopPassManager.h"
+#include "llvm/Transforms/Scalar/SROA.h"
+#include "llvm/Transforms/Scalar/SimplifyCFG.h"
+#include "llvm/Transforms/Vectorize/LoopVectorize.h"
+
 #if LLVM_VERSION_MAJOR >= 13
 #include "llvm/Transforms/IPO/Attributor.h"
 #include "llvm/Transforms/IPO/OpenMPOpt.h"
@@ -92,10 +103,26 @@ llvm::cl::opt<bool>
     EnzymePostOpt("enzyme-postopt", cl::init(false), cl::Hidden,
                   cl::desc("Run enzymepostprocessing optimizations"));
 
+llvm::cl::opt<bool> EnzymePostOptModule(
+    "enzyme-postopt-module", cl::init(false), cl::Hidden,
+    cl::desc("Run the post processing optimizations over the whole module "
+             "rather than only over the generated functions and their "
+             "callers"));
+
 llvm::cl::opt<bool> EnzymeAttributor("enzyme-attributor", cl::init(false),
                                      cl::Hidden,
                                      cl::desc("Run attributor post Enzyme"));
 
+llvm::cl::opt<bool> EnzymeMergeGenerated(
+    "enzyme-merge-generated", cl::init(false), cl::Hidden,
+    cl::desc("Collapse structurally identical functions generated by Enzyme "
+             "into a single definition"));
+
+llvm::cl::opt<bool> EnzymeSpecializeConstants(
+    "enzyme-specialize-constants", cl::init(false), cl::Hidden,
+    cl::desc("Differentiate a copy of the function specialized to the "
+             "constant integer arguments of each Enzyme call"));
+
 llvm::cl::opt<bool> EnzymeOMPOpt("enzyme-omp-opt", cl::init(false), cl::Hidden,
                                  cl::desc("Whether to enable openmp opt"));
 
@@ -474,6 +501,12 @@ static bool ReplaceOriginalCall(IRBuilder<> &Builder, Value *ret,
 class EnzymeBase {
 public:
   EnzymeLogic Logic;
+  /// Functions whose Enzyme calls were lowered during the current run.
+  SmallPtrSet<Function *, 4> loweredFunctions;
+  /// Copies of differentiated functions with constant integer arguments
+  /// substituted, by the function and the constant passed for each argument.
+  std::map<std::pair<Function *, std::vector<Constant *>>, Function *>
+      specializations;
   EnzymeBase(bool PostOpt)
       : Logic(EnzymePostOpt.getNumOccurrences() ? EnzymePostOpt : PostOpt) {
     // initializeLowerAutodiffIntrinsicPass(*PassRegistry::getPassRegistry());
@@ -1016,6 +1049,52 @@ public:
                               differentialReturn, retType});
   }
 
+  /// Return a copy of fn in which every integer argument the Enzyme call
+  /// passes as a constant is replaced by that constant, or fn itself if
+  /// there is none. The copy keeps the signature of fn, so the call is
+  /// lowered unchanged, while its derivative is generated, and cached, for
+  /// those constants: loops bounded by them get exact trip counts, fixed size
+  /// caches, and can be fully unrolled or vectorized. Calls with the same
+  /// constants share the copy and hence the derivative. The known values of
+  /// type analysis are not used for this as they are not exact.
+  Function *specializeConstantArguments(Function *fn,
+                                        ArrayRef<DIFFE_TYPE> constants,
+                                        ArrayRef<Value *> args) {
+    if (fn->empty() || hasMetadata(fn, "enzyme_augment") ||
+        hasMetadata(fn, "enzyme_gradient") ||
+        hasMetadata(fn, "enzyme_derivative"))
+      return fn;
+
+    std::vector<Constant *> known;
+    bool any = false;
+    size_t j = 0;
+    for (auto &arg : fn->args()) {
+      Constant *C = nullptr;
+      if (arg.getType()->isIntegerTy() && j < args.size())
+        C = dyn_cast<ConstantInt>(args[j]);
+      any |= C != nullptr;
+      known.push_back(C);
+      auto ty = constants[arg.getArgNo()];
+      j += (ty == DIFFE_TYPE::DUP_ARG || ty == DIFFE_TYPE::DUP_NONEED) ? 2 : 1;
+    }
+    if (!any)
+      return fn;
+
+    auto &found = specializations[std::make_pair(fn, known)];
+    if (found)
+      return found;
+
+    ValueToValueMapTy VMap;
+    Function *NewF = CloneFunction(fn, VMap);
+    NewF->setName(fn->getName() + ".spec");
+    NewF->setLinkage(GlobalValue::InternalLinkage);
+    for (auto &arg : fn->args())
+      if (auto C = known[arg.getArgNo()])
+        VMap[&arg]->replaceAllUsesWith(C);
+    found = NewF;
+    return NewF;
+  }
+
   static FnTypeInfo
   populate_overwritten_args(TypeAnalysis &TA, llvm::Function *fn,
                             DerivativeMode mode,
@@ -1276,6 +1355,13 @@ public:
     auto differentialReturn = options->differentialReturn;
     auto retType = options->retType;
 
+    // Split modes hand a tape between separate calls, which would each need
+    // to specialize identically
+    if (EnzymeSpecializeConstants &&
+        (mode == DerivativeMode::ReverseModeCombined ||
+         mode == DerivativeMode::ForwardMode))
+      fn = specializeConstantArguments(fn, constants, args);
+
     TypeAnalysis TA(Logic.PPC.FAM);
     std::vector<bool> overwritten_args;
     FnTypeInfo type_args =
@@ -2255,11 +2341,22 @@ public:
 #endif
     }
 
+    if (Changed)
+      loweredFunctions.insert(&F);
     return Changed;
   }
 
   bool run(Module &M) {
     Logic.clear();
+    loweredFunctions.clear();
+    specializations.clear();
+
+    // Functions defined before differentiation. Anything defined afterwards
+    // was generated by Enzyme and is the target of the post optimizations.
+    ValueMap<const Function *, bool> preexisting;
+    for (Function &F : M)
+      if (!F.empty())
+        preexisting[&F] = true;
 
     bool changed = false;
     for (Function &F : M) {
@@ -2461,7 +2558,14 @@ public:
 
     for (const auto &pair : Logic.PPC.cache)
       pair.second->eraseFromParent();
+    for (const auto &pair : Logic.PPC.commonCache)
+      pair.second->eraseFromParent();
     Logic.clear();
+    // Specialized copies are only referenced by the caches just cleared
+    for (const auto &pair : specializations)
+      if (pair.second->use_empty())
+        pair.second->eraseFromParent();
+    specializations.clear();
 
     if (changed && Logic.PostOpt) {
       PassBuilder PB;
@@ -2474,17 +2578,40 @@ public:
       PB.registerLoopAnalyses(LAM);
       PB.registerCGSCCAnalyses(CGAM);
       PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+#if LLVM_VERSION_MAJOR >= 12
+      if (!EnzymePostOptModule) {
+        SetVector<Function *> targets;
+        for (Function &F : M) {
+          if (F.empty() || preexisting.count(&F))
+            continue;
+          targets.insert(&F);
+        }
+        // Callers of generated functions, including the ones whose Enzyme
+        // calls were replaced, may now simplify as well.
+        for (Function &F : M)
+          if (loweredFunctions.count(&F) && !F.empty())
+            targets.insert(&F);
+        for (size_t i = 0, e = targets.size(); i < e; i++)
+          for (auto U : targets[i]->users())
+            if (auto I = dyn_cast<Instruction>(U))
+              targets.insert(I->getParent()->getParent());
+        optimizeGenerated(targets.getArrayRef(), FAM);
+      } else
+#endif
+      {
 #if LLVM_VERSION_MAJOR >= 14
-      auto PM = PB.buildModuleSimplificationPipeline(OptimizationLevel::O2,
-                                                     ThinOrFullLTOPhase::None);
+        auto PM = PB.buildModuleSimplificationPipeline(
+            OptimizationLevel::O2, ThinOrFullLTOPhase::None);
 #elif LLVM_VERSION_MAJOR >= 12
-      auto PM = PB.buildModuleSimplificationPipeline(
-          PassBuilder::OptimizationLevel::O2, ThinOrFullLTOPhase::None);
+        auto PM = PB.buildModuleSimplificationPipeline(
+            PassBuilder::OptimizationLevel::O2, ThinOrFullLTOPhase::None);
 #else
-      auto PM = PB.buildModuleSimplificationPipeline(
-          PassBuilder::OptimizationLevel::O2, PassBuilder::ThinLTOPhase::None);
+        auto PM = PB.buildModuleSimplificationPipeline(
+            PassBuilder::OptimizationLevel::O2,
+            PassBuilder::ThinLTOPhase::None);
 #endif
-      PM.run(M, MAM);
+        PM.run(M, MAM);
+      }
 #if LLVM_VERSION_MAJOR >= 13
       if (EnzymeOMPOpt) {
         OpenMPOptPass().run(M, MAM);
@@ -2496,8 +2623,118 @@ public:
       }
 #endif
     }
+
+    // Run last so the post optimizations have already canonicalized any
+    // difference that does not matter, such as dead uses of unused flags.
+    if (changed && EnzymeMergeGenerated)
+      mergeGenerated(M, preexisting);
     return changed;
   }
+
+  /// Replace every function generated by this run with the first generated
+  /// function it is structurally identical to. Derivatives differing only in
+  /// cache key fields which did not affect their code, e.g. type information
+  /// or flags that ended up unused, are emitted once. Merging callees can
+  /// make callers identical, so repeat until nothing changes.
+  static void
+  mergeGenerated(Module &M,
+                 const ValueMap<const Function *, bool> &preexisting) {
+    SmallPtrSet<Function *, 4> thunks;
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      // The comparator treats all pointers as equal, while a duplicate can
+      // only be substituted by a function of precisely its type.
+      std::map<std::pair<FunctionComparator::FunctionHash, FunctionType *>,
+               SmallVector<Function *, 1>>
+          buckets;
+      for (Function &F : M) {
+        if (F.empty() || preexisting.count(&F) || !F.hasLocalLinkage() ||
+            thunks.count(&F))
+          continue;
+        buckets[std::make_pair(FunctionComparator::functionHash(F),
+                               F.getFunctionType())]
+            .push_back(&F);
+      }
+
+      GlobalNumberState numbers;
+      SmallVector<std::pair<Function *, Function *>, 4> replacements;
+      for (auto &pair : buckets) {
+        SmallVector<Function *, 1> unique;
+        for (Function *F : pair.second) {
+          Function *rep = nullptr;
+          for (Function *U : unique)
+            if (FunctionComparator(U, F, &numbers).compare() == 0) {
+              rep = U;
+              break;
+            }
+          if (rep)
+            replacements.emplace_back(F, rep);
+          else
+            unique.push_back(F);
+        }
+      }
+
+      for (auto &pair : replacements) {
+        Function *F = pair.first;
+        Function *rep = pair.second;
+        merged = true;
+        // Anything comparing the address of the duplicate against another
+        // function must still see a distinct function, keep a forwarding
+        // thunk for it.
+        if (!F->hasGlobalUnnamedAddr() && F->hasAddressTaken()) {
+          thunks.insert(F);
+          auto linkage = F->getLinkage();
+          F->deleteBody();
+          F->setLinkage(linkage);
+          IRBuilder<> B(BasicBlock::Create(F->getContext(), "entry", F));
+          SmallVector<Value *, 4> args;
+          for (auto &arg : F->args())
+            args.push_back(&arg);
+          CallInst *call = B.CreateCall(rep, args);
+          call->setCallingConv(rep->getCallingConv());
+          call->setTailCall();
+          if (F->getReturnType()->isVoidTy())
+            B.CreateRetVoid();
+          else
+            B.CreateRet(call);
+          continue;
+        }
+        F->replaceAllUsesWith(rep);
+        F->eraseFromParent();
+      }
+    }
+  }
+
+#if LLVM_VERSION_MAJOR >= 12
+  /// Function pipeline for derivative code: scalarize tape and shadow
+  /// structs, hoist loop invariant cache loads out of the reverse loops, and
+  /// vectorize the reverse loops once they are in canonical form.
+  static void optimizeGenerated(ArrayRef<Function *> targets,
+                                FunctionAnalysisManager &FAM) {
+    FunctionPassManager FPM;
+#if LLVM_VERSION_MAJOR >= 14 && !defined(FLANG)
+    FPM.addPass(SROAPass());
+#else
+    FPM.addPass(SROA());
+#endif
+    FPM.addPass(EarlyCSEPass(/*UseMemorySSA*/ true));
+    FPM.addPass(InstCombinePass());
+    FPM.addPass(SimplifyCFGPass());
+    FPM.addPass(createFunctionToLoopPassAdaptor(
+        LICMPass(), /*UseMemorySSA*/ true, /*UseBlockFrequencyInfo*/ false));
+#if LLVM_VERSION_MAJOR >= 14 && !defined(FLANG)
+    FPM.addPass(GVNPass());
+#else
+    FPM.addPass(GVN());
+#endif
+    FPM.addPass(LoopVectorizePass());
+    FPM.addPass(InstCombinePass());
+    FPM.addPass(SimplifyCFGPass());
+    for (auto F : targets)
+      FPM.run(*F, FAM);
+  }
+#endif
 };
 
 class EnzymeOldPM : public EnzymeBase, public ModulePass {
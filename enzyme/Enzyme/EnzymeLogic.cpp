@@ -51,6 +51,7 @@
 
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
 
 #include "llvm/Analysis/BasicAliasAnalysis.h"
 #include "llvm/Analysis/GlobalsModRef.h"
@@ -96,9 +97,78 @@ cl::opt<bool> EnzymeJuliaAddrLoad(
     "enzyme-julia-addr-load", cl::init(false), cl::Hidden,
     cl::desc("Mark all loads resulting in an addr(13)* to be legal to redo"));
 
+cl::opt<bool> EnzymeShadowRegisterReduction(
+    "enzyme-shadow-register-reduction", cl::init(false), cl::Hidden,
+    cl::desc("Accumulate shadow updates to loop invariant addresses of a "
+             "reverse loop in a register, storing them once at loop exit"));
+
+cl::opt<bool> EnzymeTapeStack(
+    "enzyme-tape-stack", cl::init(false), cl::Hidden,
+    cl::desc("Push the tapes of recursive augmented calls onto a LIFO stack "
+             "provided by the runtime in include/enzyme/tapestack.h instead "
+             "of allocating each of them with malloc"));
+
+cl::opt<bool> EnzymeLiftSubcallTape(
+    "enzyme-lift-subcall-tape", cl::init(false), cl::Hidden,
+    cl::desc("Have a combined derivative call a separate augmented forward "
+             "pass of a recursive function which returns its tape by value, "
+             "keeping it in the caller rather than in a malloc"));
+
 LLVMValueRef (*EnzymeFixupReturn)(LLVMBuilderRef, LLVMValueRef) = nullptr;
 }
 
+static Function *getTapeStackFn(Module &M, StringRef Name, FunctionType *FT) {
+#if LLVM_VERSION_MAJOR >= 9
+  Function *F = cast<Function>(M.getOrInsertFunction(Name, FT).getCallee());
+#else
+  Function *F = cast<Function>(M.getOrInsertFunction(Name, FT));
+#endif
+  F->addFnAttr(Attribute::NoUnwind);
+  return F;
+}
+
+Function *getTapePushFn(Module &M) {
+  auto &Ctx = M.getContext();
+  Function *F = getTapeStackFn(
+      M, "__enzyme_tape_push",
+      FunctionType::get(Type::getInt8PtrTy(Ctx), {Type::getInt64Ty(Ctx)},
+                        false));
+#if LLVM_VERSION_MAJOR >= 14
+  F->addRetAttr(Attribute::NoAlias);
+#else
+  F->addAttribute(AttributeList::ReturnIndex, Attribute::NoAlias);
+#endif
+  return F;
+}
+
+Function *getTapePopFn(Module &M) {
+  auto &Ctx = M.getContext();
+  return getTapeStackFn(M, "__enzyme_tape_pop",
+                        FunctionType::get(Type::getVoidTy(Ctx),
+                                          {Type::getInt8PtrTy(Ctx)}, false));
+}
+
+/// Free the anonymous tape of an augmented call once it has been loaded
+CallInst *freeAnonymousTape(IRBuilder<> &B, Value *tape) {
+  if (EnzymeTapeArena)
+    return B.CreateCall(
+        getArenaFreeFn(*B.GetInsertBlock()->getModule()),
+        B.CreatePointerCast(tape, Type::getInt8PtrTy(tape->getContext())));
+  return CreateDealloc(B, tape);
+}
+
+/// Release a tape frame pushed by a recursive augmented call once the
+/// derivative consuming it returns. Frames of the calls nested within it are
+/// pushed after it and stay live until then.
+static void popTapeFrameAtReturns(Function *F, Value *Frame) {
+  Function *Pop = getTapePopFn(*F->getParent());
+  for (auto &BB : *F)
+    if (auto RI = dyn_cast_or_null<ReturnInst>(BB.getTerminator())) {
+      IRBuilder<> B(RI);
+      B.CreateCall(Pop, B.CreatePointerCast(Frame, B.getInt8PtrTy()));
+    }
+}
+
 struct CacheAnalysis {
 
   const ValueMap<const CallInst *, SmallPtrSet<const CallInst *, 1>>
@@ -1547,6 +1617,339 @@ void cleanupInversionAllocs(DiffeGradientUtils *gutils, BasicBlock *entry) {
   }
 }
 
+namespace {
+/// An increment `*ptr += dif` of a shadow, emitted by addToInvertedPtrDiffe
+/// either as an atomicrmw fadd or as a load, fadd and store of `ptr`.
+struct ShadowUpdate {
+  Instruction *update = nullptr;
+  LoadInst *load = nullptr;
+  BinaryOperator *add = nullptr;
+
+  Value *getPointer() const {
+    if (auto SI = dyn_cast<StoreInst>(update))
+      return SI->getPointerOperand();
+    return cast<AtomicRMWInst>(update)->getPointerOperand();
+  }
+  Type *getType() const {
+    if (auto SI = dyn_cast<StoreInst>(update))
+      return SI->getValueOperand()->getType();
+    return cast<AtomicRMWInst>(update)->getValOperand()->getType();
+  }
+};
+} // namespace
+
+static bool matchShadowUpdate(Instruction &I, ShadowUpdate &SU) {
+  if (auto RMW = dyn_cast<AtomicRMWInst>(&I)) {
+#if LLVM_VERSION_MAJOR >= 9
+    if (RMW->getOperation() != AtomicRMWInst::FAdd || RMW->isVolatile() ||
+        !RMW->use_empty())
+      return false;
+    SU.update = RMW;
+    return true;
+#else
+    return false;
+#endif
+  }
+  auto SI = dyn_cast<StoreInst>(&I);
+  if (!SI || !SI->isSimple())
+    return false;
+  // Accumulating in a register changes the order of the additions.
+  auto add = dyn_cast<BinaryOperator>(SI->getValueOperand());
+  if (!add || add->getOpcode() != Instruction::FAdd ||
+      !add->hasAllowReassoc() || !add->hasOneUse() ||
+      add->getParent() != SI->getParent())
+    return false;
+  for (size_t i = 0; i < 2; i++) {
+    auto LI = dyn_cast<LoadInst>(add->getOperand(i));
+    if (LI && LI->isSimple() && LI->hasOneUse() &&
+        LI->getPointerOperand() == SI->getPointerOperand() &&
+        LI->getParent() == SI->getParent()) {
+      SU.update = SI;
+      SU.load = LI;
+      SU.add = add;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Returns whether `V` is invariant in `L`, or can be made so by hoisting
+/// side-effect free instructions to its preheader.
+static bool isHoistable(Loop *L, Value *V) {
+  if (L->isLoopInvariant(V))
+    return true;
+  auto I = dyn_cast<Instruction>(V);
+  if (!I || isa<PHINode>(I) || I->mayReadFromMemory() ||
+      !isSafeToSpeculativelyExecute(I))
+    return false;
+  for (auto &op : I->operands())
+    if (!isHoistable(L, op))
+      return false;
+  return true;
+}
+
+/// Keep the partial sums of shadow updates to loop invariant addresses of a
+/// reverse loop in a register, rather than loading and storing (or atomically
+/// updating) the shadow in every iteration. Each such address is given an
+/// accumulator which is zeroed in the preheader and added into the shadow once
+/// at every exit of the loop, and is subsequently promoted by mem2reg.
+static void registerReduceShadowUpdates(DiffeGradientUtils *gutils,
+                                        PreProcessCache &PPC) {
+  if (!EnzymeShadowRegisterReduction)
+    return;
+  Function *F = gutils->newFunc;
+  PPC.FAM.invalidate(*F, PreservedAnalyses::none());
+  auto &DT = PPC.FAM.getResult<DominatorTreeAnalysis>(*F);
+  auto &LI = PPC.FAM.getResult<LoopAnalysis>(*F);
+  auto &AA = PPC.FAM.getResult<AAManager>(*F);
+
+  // Visit inner loops first, such that the updates flushed at the exit of an
+  // inner loop may in turn be accumulated by the enclosing one.
+  auto loops = LI.getLoopsInPreorder();
+  for (Loop *L : llvm::reverse(loops)) {
+    if (gutils->isOriginalBlock(*L->getHeader()))
+      continue;
+
+    MapVector<Value *, SmallVector<ShadowUpdate, 1>> updates;
+    for (auto BB : L->blocks())
+      for (auto &I : *BB) {
+        ShadowUpdate SU;
+        if (matchShadowUpdate(I, SU))
+          updates[SU.getPointer()].push_back(SU);
+      }
+    if (updates.empty())
+      continue;
+
+    SmallVector<BasicBlock *, 4> exiting;
+    L->getExitingBlocks(exiting);
+
+    SmallVector<std::pair<Value *, SmallVector<ShadowUpdate, 1>>, 1> legal;
+    for (auto &pair : updates) {
+      auto &SUs = pair.second;
+      bool atomic = isa<AtomicRMWInst>(SUs[0].update);
+      Type *T = SUs[0].getType();
+      if (llvm::any_of(SUs, [&](const ShadowUpdate &SU) {
+            return isa<AtomicRMWInst>(SU.update) != atomic ||
+                   SU.getType() != T;
+          }))
+        continue;
+
+      // Derivatives kept in stack slots are already promoted by mem2reg.
+      auto obj =
+#if LLVM_VERSION_MAJOR >= 12
+          getUnderlyingObject(pair.first, 100);
+#else
+          GetUnderlyingObject(pair.first, F->getParent()->getDataLayout(),
+                              100);
+#endif
+      if (isa<AllocaInst>(obj))
+        continue;
+
+      if (!isHoistable(L, pair.first))
+        continue;
+
+      // The shadow may only be accessed at the exits if it was updated in
+      // every execution of the loop.
+      if (!llvm::any_of(SUs, [&](const ShadowUpdate &SU) {
+            return llvm::all_of(exiting, [&](BasicBlock *E) {
+              return DT.dominates(SU.update->getParent(), E);
+            });
+          }))
+        continue;
+
+      SmallPtrSet<Instruction *, 4> members;
+      for (auto &SU : SUs) {
+        members.insert(SU.update);
+        if (SU.load)
+          members.insert(SU.load);
+      }
+      auto Loc = MemoryLocation::get(SUs[0].update);
+      bool interferes = false;
+      for (auto BB : L->blocks()) {
+        for (auto &I : *BB) {
+          if (!I.mayReadOrWriteMemory() || members.count(&I))
+            continue;
+          if (isModOrRefSet(AA.getModRefInfo(&I, Loc))) {
+            interferes = true;
+            break;
+          }
+        }
+        if (interferes)
+          break;
+      }
+      if (!interferes)
+        legal.push_back(pair);
+    }
+    if (legal.empty())
+      continue;
+
+    if (!L->getLoopPreheader())
+#if LLVM_VERSION_MAJOR >= 9
+      InsertPreheaderForLoop(L, &DT, &LI, nullptr, /*PreserveLCSSA*/ false);
+#else
+      InsertPreheaderForLoop(L, &DT, &LI, /*PreserveLCSSA*/ false);
+#endif
+    BasicBlock *preheader = L->getLoopPreheader();
+    if (!preheader)
+      continue;
+
+    // The address is typically recomputed in the loop by the reverse pass,
+    // hoist it to the preheader.
+    for (auto &pair : legal) {
+      bool changed = false;
+      bool hoisted = L->makeLoopInvariant(pair.first, changed);
+      (void)hoisted;
+      assert(hoisted);
+    }
+
+    if (!L->hasDedicatedExits())
+#if LLVM_VERSION_MAJOR >= 9
+      formDedicatedExitBlocks(L, &DT, &LI, nullptr, /*PreserveLCSSA*/ false);
+#else
+      formDedicatedExitBlocks(L, &DT, &LI, /*PreserveLCSSA*/ false);
+#endif
+    if (!L->hasDedicatedExits())
+      continue;
+    SmallVector<BasicBlock *, 4> exits;
+    L->getUniqueExitBlocks(exits);
+
+    for (auto &pair : legal) {
+      Value *ptr = pair.first;
+      auto &SUs = pair.second;
+      Type *T = SUs[0].getType();
+
+      IRBuilder<> EB(&F->getEntryBlock().front());
+      auto acc = EB.CreateAlloca(T, nullptr, ptr->getName() + "'rr");
+      IRBuilder<> PB(preheader->getTerminator());
+      PB.CreateStore(Constant::getNullValue(T), acc);
+
+      for (auto E : exits) {
+        IRBuilder<> B(&*E->getFirstInsertionPt());
+#if LLVM_VERSION_MAJOR > 7
+        Value *sum = B.CreateLoad(T, acc);
+#else
+        Value *sum = B.CreateLoad(acc);
+#endif
+        if (!SUs[0].load) {
+          auto flush = SUs[0].update->clone();
+          flush->setOperand(1, sum);
+          B.Insert(flush);
+          continue;
+        }
+        auto prev = SUs[0].load->clone();
+        B.Insert(prev);
+        auto add = SUs[0].add->clone();
+        for (size_t i = 0; i < 2; i++)
+          add->setOperand(i, add->getOperand(i) == SUs[0].load ? prev : sum);
+        B.Insert(add);
+        auto flush = SUs[0].update->clone();
+        flush->setOperand(0, add);
+        B.Insert(flush);
+      }
+
+      for (auto &SU : SUs) {
+        IRBuilder<> B(SU.update);
+        if (SU.load) {
+          B.SetInsertPoint(SU.load);
+#if LLVM_VERSION_MAJOR > 7
+          auto prev = B.CreateLoad(T, acc);
+#else
+          auto prev = B.CreateLoad(acc);
+#endif
+          SU.load->replaceAllUsesWith(prev);
+          SU.load->eraseFromParent();
+          B.SetInsertPoint(SU.update);
+          B.CreateStore(SU.add, acc);
+        } else {
+          B.setFastMathFlags(getFast());
+#if LLVM_VERSION_MAJOR > 7
+          Value *prev = B.CreateLoad(T, acc);
+#else
+          Value *prev = B.CreateLoad(acc);
+#endif
+          Value *dif = cast<AtomicRMWInst>(SU.update)->getValOperand();
+          B.CreateStore(B.CreateFAdd(prev, dif), acc);
+        }
+        SU.update->eraseFromParent();
+      }
+    }
+  }
+  PPC.FAM.invalidate(*F, PreservedAnalyses::none());
+}
+
+/// Specialize a derivative containing hoisted runtime activity checks for the
+/// common case that every checked argument is distinct from its shadow. The
+/// function is cloned with the checks folded to true and the original body is
+/// kept as the fallback, so the checks are performed once at entry rather
+/// than at every access. Returns the specialized clone, if one was created.
+static Function *versionOnRuntimeActivity(Function *nf,
+                                          ArrayRef<WeakTrackingVH> flags) {
+  if (!EnzymeRuntimeActivityVersioning || nf->isVarArg())
+    return nullptr;
+  for (auto &arg : nf->args())
+    if (arg.hasByValAttr() || arg.hasInAllocaAttr() ||
+        arg.hasPreallocatedAttr())
+      return nullptr;
+
+  SmallVector<Instruction *, 2> checks;
+  for (auto &flag : flags) {
+    auto cmp = dyn_cast_or_null<ICmpInst>(flag);
+    if (!cmp || cmp->getParent() != &nf->getEntryBlock() ||
+        !isa<Argument>(cmp->getOperand(0)) ||
+        !isa<Argument>(cmp->getOperand(1)))
+      continue;
+    checks.push_back(cmp);
+  }
+  if (checks.empty())
+    return nullptr;
+
+  ValueToValueMapTy VMap;
+  Function *distinct = CloneFunction(nf, VMap);
+  distinct->setName(nf->getName() + "_distinct");
+  distinct->setLinkage(Function::LinkageTypes::InternalLinkage);
+  for (auto check : checks) {
+    auto cloned = cast<Instruction>(VMap[check]);
+    cloned->replaceAllUsesWith(ConstantInt::getTrue(nf->getContext()));
+    cloned->eraseFromParent();
+  }
+
+  BasicBlock *body = &nf->getEntryBlock();
+  BasicBlock *dispatch =
+      BasicBlock::Create(nf->getContext(), "dispatch", nf, body);
+  BasicBlock *fast =
+      BasicBlock::Create(nf->getContext(), "dispatch.distinct", nf, body);
+
+  // Static allocas must remain in the entry block.
+  SmallVector<AllocaInst *, 4> AIs;
+  for (auto &I : *body)
+    if (auto AI = dyn_cast<AllocaInst>(&I))
+      if (isa<ConstantInt>(AI->getArraySize()))
+        AIs.push_back(AI);
+  for (auto AI : AIs)
+    AI->moveBefore(*dispatch, dispatch->end());
+
+  IRBuilder<> B(dispatch);
+  Value *allDistinct = nullptr;
+  for (auto check : checks) {
+    check->moveBefore(*dispatch, dispatch->end());
+    allDistinct = allDistinct ? B.CreateAnd(allDistinct, check) : check;
+  }
+  B.CreateCondBr(allDistinct, fast, body);
+
+  B.SetInsertPoint(fast);
+  SmallVector<Value *, 4> args;
+  for (auto &arg : nf->args())
+    args.push_back(&arg);
+  auto call = B.CreateCall(distinct, args);
+  call->setCallingConv(nf->getCallingConv());
+  call->setTailCall();
+  if (nf->getReturnType()->isVoidTy())
+    B.CreateRetVoid();
+  else
+    B.CreateRet(call);
+  return distinct;
+}
+
 static FnTypeInfo preventTypeAnalysisLoops(const FnTypeInfo &oldTypeInfo_,
                                            llvm::Function *todiff) {
   FnTypeInfo oldTypeInfo = oldTypeInfo_;
@@ -1736,7 +2139,8 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
     Function *todiff, DIFFE_TYPE retType, ArrayRef<DIFFE_TYPE> constant_args,
     TypeAnalysis &TA, bool returnUsed, bool shadowReturnUsed,
     const FnTypeInfo &oldTypeInfo_, const std::vector<bool> _overwritten_args,
-    bool forceAnonymousTape, unsigned width, bool AtomicAdd, bool omp) {
+    bool forceAnonymousTape, unsigned width, bool AtomicAdd, bool omp,
+    bool tapeByValue) {
   if (returnUsed)
     assert(!todiff->getReturnType()->isEmptyTy() &&
            !todiff->getReturnType()->isVoidTy());
@@ -1754,7 +2158,7 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
                            returnUsed,    shadowReturnUsed,
                            oldTypeInfo,   forceAnonymousTape,
                            AtomicAdd,     omp,
-                           width};
+                           width,         tapeByValue};
 
   auto found = AugmentedCachedFunctions.find(tup);
   if (found != AugmentedCachedFunctions.end()) {
@@ -1817,7 +2221,7 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
       auto &aug = CreateAugmentedPrimal(
           todiff, retType, next_constant_args, TA, returnUsed, shadowReturnUsed,
           oldTypeInfo_, _overwritten_args, forceAnonymousTape, width, AtomicAdd,
-          omp);
+          omp, tapeByValue);
 
       FunctionType *FTy =
           FunctionType::get(aug.fn->getReturnType(), dupargs,
@@ -2369,6 +2773,10 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
       AugmentedCachedFunctions.find(tup)->second.fn->getNumUses() > 0 ||
       forceAnonymousTape;
   bool noTape = MallocTypes.size() == 0 && !forceAnonymousTape;
+  // Only tapes of calls made by other derivatives are released in LIFO order,
+  // the user may consume a tape of the split mode in any order
+  bool tapeOnStack = EnzymeTapeStack && !forceAnonymousTape;
+  AugmentedCachedFunctions.find(tup)->second.tapeOnStack = tapeOnStack;
 
   StructType *sty = cast<StructType>(gutils->newFunc->getReturnType());
   SmallVector<Type *, 4> RetTypes(sty->elements().begin(),
@@ -2500,12 +2908,23 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
           NewF->getParent()->getDataLayout().getTypeAllocSizeInBits(tapeType);
       Value *memory;
       if (size != 0) {
-        CallInst *malloccall = nullptr;
-        Instruction *zero = nullptr;
-        tapeMemory = CreateAllocation(
-            ib, tapeType, ConstantInt::get(i64, 1), "tapemem", &malloccall,
-            EnzymeZeroCache ? &zero : nullptr, /*isDefault*/ true);
-        memory = malloccall;
+        if (tapeOnStack || EnzymeTapeArena) {
+          Module &M = *NewF->getParent();
+          memory = ib.CreateCall(tapeOnStack ? getTapePushFn(M)
+                                             : getArenaAllocFn(M),
+                                 ConstantInt::get(i64, size / 8), "tapemem");
+          tapeMemory = ib.CreatePointerCast(memory,
+                                            PointerType::getUnqual(tapeType));
+          if (EnzymeZeroCache)
+            ZeroMemory(ib, tapeType, tapeMemory, /*isTape*/ true);
+        } else {
+          CallInst *malloccall = nullptr;
+          Instruction *zero = nullptr;
+          tapeMemory = CreateAllocation(
+              ib, tapeType, ConstantInt::get(i64, 1), "tapemem", &malloccall,
+              EnzymeZeroCache ? &zero : nullptr, /*isDefault*/ true);
+          memory = malloccall;
+        }
       } else {
         memory = ConstantPointerNull::get(
             getDefaultAnonymousTapeType(NewF->getContext()));
@@ -2774,6 +3193,22 @@ const AugmentedReturn &EnzymeLogic::CreateAugmentedPrimal(
   return AugmentedCachedFunctions.find(tup)->second;
 }
 
+void EnzymeLogic::eraseAugmentedPrimal(const AugmentedReturn &aug) {
+  for (auto it = AugmentedCachedFunctions.begin();
+       it != AugmentedCachedFunctions.end(); ++it) {
+    if (&it->second != &aug)
+      continue;
+    // An entry still being generated is looked up again once it completes
+    if (!aug.isComplete)
+      return;
+    Function *fn = it->second.fn;
+    AugmentedCachedFunctions.erase(it);
+    if (fn->use_empty())
+      fn->eraseFromParent();
+    return;
+  }
+}
+
 void createTerminator(DiffeGradientUtils *gutils, BasicBlock *oBB,
                       DIFFE_TYPE retType, ReturnType retVal) {
   TypeResults &TR = gutils->TR;
@@ -3343,6 +3778,7 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
       cal->setCallingConv(aug.fn->getCallingConv());
 
       llvm::Value *tape = nullptr;
+      llvm::Value *tapeFrame = nullptr;
 
       if (aug.returns.find(AugmentedStruct::Tape) != aug.returns.end()) {
         auto tapeIdx = aug.returns.find(AugmentedStruct::Tape)->second;
@@ -3369,7 +3805,10 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
           auto size = NewF->getParent()->getDataLayout().getTypeAllocSizeInBits(
               aug.tapeType);
           if (size != 0) {
-            CreateDealloc(bb, tape);
+            if (aug.tapeOnStack)
+              tapeFrame = tape;
+            else
+              freeAnonymousTape(bb, tape);
           }
         }
         tape = truetape;
@@ -3399,6 +3838,9 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
       }
       auto revcal = bb.CreateCall(revfn, revargs);
       revcal->setCallingConv(revfn->getCallingConv());
+      if (tapeFrame)
+        bb.CreateCall(getTapePopFn(*NewF->getParent()),
+                      bb.CreatePointerCast(tapeFrame, bb.getInt8PtrTy()));
 
       if (NewF->getReturnType()->isEmptyTy()) {
         bb.CreateRet(UndefValue::get(NewF->getReturnType()));
@@ -3758,6 +4200,7 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
                                   unnecessaryInstructions, gutils, TLI);
 
   Value *additionalValue = nullptr;
+  Value *tapeFrame = nullptr;
   if (key.additionalType) {
     auto v = gutils->newFunc->arg_end();
     v--;
@@ -3785,12 +4228,15 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
                               MDNode::get(truetape->getContext(), {}));
 
         if (!omp && gutils->FreeMemory) {
-          CreateDealloc(BuilderZ, additionalValue);
+          if (augmenteddata->tapeOnStack)
+            tapeFrame = additionalValue;
+          else
+            freeAnonymousTape(BuilderZ, additionalValue);
         }
         additionalValue = truetape;
       } else {
         if (gutils->FreeMemory) {
-          CreateDealloc(BuilderZ, additionalValue);
+          freeAnonymousTape(BuilderZ, additionalValue);
         }
         additionalValue = UndefValue::get(augmenteddata->tapeType);
       }
@@ -3961,6 +4407,9 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
 
   gutils->eraseFictiousPHIs();
 
+  if (tapeFrame)
+    popTapeFrameAtReturns(gutils->newFunc, tapeFrame);
+
   BasicBlock *entry = &gutils->newFunc->getEntryBlock();
 
   auto Arch =
@@ -4048,7 +4497,9 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
     }
   }
 
+  gutils->annotateParallelReverseLoops();
   cleanupInversionAllocs(gutils, entry);
+  registerReduceShadowUpdates(gutils, PPC);
   clearFunctionAttributes(gutils->newFunc);
 
   if (llvm::verifyFunction(*gutils->newFunc, &llvm::errs())) {
@@ -4058,6 +4509,9 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
   }
 
   auto nf = gutils->newFunc;
+  SmallVector<WeakTrackingVH, 2> activityFlags;
+  for (auto &pair : gutils->runtimeActivityFlags)
+    activityFlags.push_back(pair.second);
   delete gutils;
 
   PPC.LowerAllocAddr(nf);
@@ -4069,6 +4523,9 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
   PPC.AlwaysInline(nf);
   if (Arch == Triple::nvptx || Arch == Triple::nvptx64)
     PPC.ReplaceReallocs(nf, /*mem2reg*/ true);
+  Function *distinct = nullptr;
+  if (!omp)
+    distinct = versionOnRuntimeActivity(nf, activityFlags);
 
   if (prevFunction) {
     prevFunction->replaceAllUsesWith(nf);
@@ -4079,8 +4536,11 @@ Function *EnzymeLogic::CreatePrimalAndGradient(
   // parallel so the adjointgenerator can successfully extract the allocation
   // and frees and hoist them into the parent. Optimizing before then may
   // make the IR different to traverse, and thus impossible to find the allocs.
-  if (PostOpt && !omp)
+  if (PostOpt && !omp) {
     PPC.optimizeIntermediate(nf);
+    if (distinct)
+      PPC.optimizeIntermediate(distinct);
+  }
   if (EnzymePrint) {
     llvm::errs() << *nf << "\n";
   }
@@ -4330,6 +4790,7 @@ Function *EnzymeLogic::CreateForwardDiff(
                                   unnecessaryInstructions, gutils, TLI);
 
   AdjointGenerator<const AugmentedReturn *> *maker;
+  Value *tapeFrame = nullptr;
 
   std::unique_ptr<const std::map<Instruction *, bool>> can_modref_map;
   if (mode == DerivativeMode::ForwardModeSplit) {
@@ -4386,7 +4847,10 @@ Function *EnzymeLogic::CreateForwardDiff(
                                 MDNode::get(truetape->getContext(), {}));
 
           if (!omp && gutils->FreeMemory) {
-            CreateDealloc(BuilderZ, additionalValue);
+            if (augmenteddata->tapeOnStack)
+              tapeFrame = additionalValue;
+            else
+              freeAnonymousTape(BuilderZ, additionalValue);
           }
           additionalValue = truetape;
         } else {
@@ -4395,7 +4859,7 @@ Function *EnzymeLogic::CreateForwardDiff(
                             ->getDataLayout()
                             .getTypeAllocSizeInBits(augmenteddata->tapeType);
             if (size != 0) {
-              CreateDealloc(BuilderZ, additionalValue);
+              freeAnonymousTape(BuilderZ, additionalValue);
             }
           }
           additionalValue = UndefValue::get(augmenteddata->tapeType);
@@ -4446,6 +4910,9 @@ Function *EnzymeLogic::CreateForwardDiff(
 
   gutils->eraseFictiousPHIs();
 
+  if (tapeFrame)
+    popTapeFrameAtReturns(gutils->newFunc, tapeFrame);
+
   BasicBlock *entry = &gutils->newFunc->getEntryBlock();
 
   auto Arch =
@@ -4461,6 +4928,9 @@ Function *EnzymeLogic::CreateForwardDiff(
   }
 
   auto nf = gutils->newFunc;
+  SmallVector<WeakTrackingVH, 2> activityFlags;
+  for (auto &pair : gutils->runtimeActivityFlags)
+    activityFlags.push_back(pair.second);
   delete gutils;
   delete maker;
 
@@ -4473,9 +4943,13 @@ Function *EnzymeLogic::CreateForwardDiff(
   PPC.AlwaysInline(nf);
   if (Arch == Triple::nvptx || Arch == Triple::nvptx64)
     PPC.ReplaceReallocs(nf, /*mem2reg*/ true);
+  Function *distinct = versionOnRuntimeActivity(nf, activityFlags);
 
-  if (PostOpt)
+  if (PostOpt) {
     PPC.optimizeIntermediate(nf);
+    if (distinct)
+      PPC.optimizeIntermediate(distinct);
+  }
   if (EnzymePrint) {
     llvm::errs() << *nf << "\n";
   }
@@ -114,6 +114,10 @@ public:
 
   std::set<ssize_t> tapeIndiciesToFree;
 
+  //! Whether the anonymous tape is pushed onto the runtime's tape stack and
+  //! must be popped, rather than freed, once consumed
+  bool tapeOnStack;
+
   bool isComplete;
 
   AugmentedReturn(
@@ -124,7 +128,7 @@ public:
       std::map<llvm::Instruction *, bool> can_modref_map)
       : fn(fn), tapeType(tapeType), tapeIndices(tapeIndices), returns(returns),
         overwritten_args_map(overwritten_args_map),
-        can_modref_map(can_modref_map), isComplete(false) {}
+        can_modref_map(can_modref_map), tapeOnStack(false), isComplete(false) {}
 };
 
 struct ReverseCacheKey {
@@ -252,6 +256,7 @@ public:
     bool AtomicAdd;
     bool omp;
     unsigned width;
+    bool tapeByValue;
 
     inline bool operator<(const AugmentedCacheKey &rhs) const {
       if (fn < rhs.fn)
@@ -317,6 +322,11 @@ public:
       if (rhs.width < width)
         return false;
 
+      if (tapeByValue < rhs.tapeByValue)
+        return true;
+      if (rhs.tapeByValue < tapeByValue)
+        return false;
+
       // equal
       return false;
     }
@@ -338,13 +348,20 @@ public:
   ///  loads in the generated function (and thus cannot be cached). \p
   ///  forceAnonymousTape forces the tape to be an i8* rather than the true tape
   ///  structure \p AtomicAdd is whether to perform all adjoint updates to
-  ///  memory in an atomic way
+  ///  memory in an atomic way. \p tapeByValue requests a separate entry
+  ///  point for a caller that keeps the tape itself, so that a recursive
+  ///  function returns its outermost tape by value rather than in an i8*
   const AugmentedReturn &CreateAugmentedPrimal(
       llvm::Function *todiff, DIFFE_TYPE retType,
       llvm::ArrayRef<DIFFE_TYPE> constant_args, TypeAnalysis &TA,
       bool returnUsed, bool shadowReturnUsed, const FnTypeInfo &typeInfo,
       const std::vector<bool> _overwritten_args, bool forceAnonymousTape,
-      unsigned width, bool AtomicAdd, bool omp = false);
+      unsigned width, bool AtomicAdd, bool omp = false,
+      bool tapeByValue = false);
+
+  /// Erase an augmented forward pass which ended up without any caller,
+  /// together with its cache entry
+  void eraseAugmentedPrimal(const AugmentedReturn &aug);
 
   std::map<ReverseCacheKey, llvm::Function *> ReverseCachedFunctions;
 
@@ -469,8 +486,19 @@ public:
 extern "C" {
 extern llvm::cl::opt<bool> looseTypeAnalysis;
 extern llvm::cl::opt<bool> nonmarkedglobals_inactiveloads;
+
+/// Return the tape of a recursive subcall of a combined derivative by value
+/// instead of allocating it
+extern llvm::cl::opt<bool> EnzymeLiftSubcallTape;
 };
 
+/// Declarations of the tape stack runtime, see include/enzyme/tapestack.h
+llvm::Function *getTapePushFn(llvm::Module &M);
+llvm::Function *getTapePopFn(llvm::Module &M);
+
+/// Free the anonymous tape of an augmented call once it has been loaded
+llvm::CallInst *freeAnonymousTape(llvm::IRBuilder<> &B, llvm::Value *tape);
+
 class GradientUtils;
 bool shouldAugmentCall(llvm::CallInst *op, const GradientUtils *gutils);
 
@@ -133,6 +133,20 @@ cl::opt<int>
     EnzymeInlineCount("enzyme-inline-count", cl::init(10000), cl::Hidden,
                       cl::desc("Limit of number of functions to inline"));
 
+cl::opt<bool> EnzymeInlineCostModel(
+    "enzyme-inline-cost-model", cl::init(false), cl::Hidden,
+    cl::desc("Inline the callees of autodiff whose augmented call overhead "
+             "outweighs their code growth"));
+
+cl::opt<int> EnzymeInlineThreshold(
+    "enzyme-inline-threshold", cl::init(40), cl::Hidden,
+    cl::desc("Largest callee, in instructions, the inline cost model inlines "
+             "outside of loops"));
+
+cl::opt<int> EnzymeInlineHotFactor(
+    "enzyme-inline-hot-factor", cl::init(4), cl::Hidden,
+    cl::desc("Factor the inline threshold is scaled by for calls in loops"));
+
 cl::opt<bool> EnzymeCoalese("enzyme-coalese", cl::init(false), cl::Hidden,
                             cl::desc("Whether to coalese memory allocations"));
 
@@ -1020,10 +1034,63 @@ static void SimplifyMPIQueries(Function &NewF, FunctionAnalysisManager &FAM) {
   FAM.invalidate(NewF, PA);
 }
 
-/// Perform recursive inlinining on NewF up to the given limit
-static void ForceRecursiveInlining(Function *NewF, size_t Limit) {
+/// Whether inlining the call CI, whose callee has already been deemed
+/// inlinable, is cheaper than differentiating it as a separate call. Each
+/// augmented call carries a fixed overhead: a tape struct, usually a malloc
+/// of it, and an indirect reverse call that the callee's body can no longer
+/// be optimized across. That overhead is paid once per execution, so callees
+/// called from within loops are allowed to be proportionally larger.
+/// Original is the function CI's caller was cloned from.
+static bool ShouldInlineForDifferentiation(CallInst *CI, LoopInfo &LI,
+                                           Function *Original) {
+  Function *called = CI->getCalledFunction();
+
+  // The only caller apart from the original, which is not differentiated, so
+  // inlining removes the callee's derivative rather than duplicating it
+  if (called->hasLocalLinkage()) {
+    size_t uses = 0;
+    for (auto U : called->users())
+      if (!isa<Instruction>(U) ||
+          cast<Instruction>(U)->getParent()->getParent() != Original)
+        uses++;
+    if (uses == 1)
+      return true;
+  }
+
+  int64_t threshold = EnzymeInlineThreshold;
+  if (LI.getLoopFor(CI->getParent()))
+    threshold *= EnzymeInlineHotFactor;
+
+  // Setting up the arguments and the call itself goes away when inlined
+  int64_t size = -(int64_t)called->arg_size() - 1;
+  for (auto &BB : *called)
+    for (auto &I : BB) {
+      if (isa<DbgInfoIntrinsic>(&I))
+        continue;
+      size++;
+      if (size > threshold) {
+        LLVM_DEBUG(llvm::dbgs() << "not inlining large " << called->getName()
+                                << " into " << *CI << "\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+/// Perform recursive inlinining on NewF up to the given limit. Unless Force
+/// is set, only calls the inline cost model deems profitable are inlined,
+/// which requires the function NewF was cloned from as Original.
+static void ForceRecursiveInlining(Function *NewF, size_t Limit,
+                                   bool Force = true,
+                                   Function *Original = nullptr) {
   std::map<const Function *, RecurType> RecurResults;
   for (size_t count = 0; count < Limit; count++) {
+    std::unique_ptr<DominatorTree> DT;
+    std::unique_ptr<LoopInfo> LI;
+    if (!Force) {
+      DT = std::make_unique<DominatorTree>(*NewF);
+      LI = std::make_unique<LoopInfo>(*DT);
+    }
     for (auto &BB : *NewF) {
       for (auto &I : BB) {
         if (auto CI = dyn_cast<CallInst>(&I)) {
@@ -1048,6 +1115,8 @@ static void ForceRecursiveInlining(Function *NewF, size_t Limit) {
                        << CI->getCalledFunction()->getName() << "\n");
             continue;
           }
+          if (!Force && !ShouldInlineForDifferentiation(CI, *LI, Original))
+            continue;
           InlineFunctionInfo IFI;
 #if LLVM_VERSION_MAJOR >= 11
           InlineFunction(*CI, IFI);
@@ -1238,24 +1307,15 @@ void setFullWillReturn(Function *NewF) {
 #endif
 }
 
-Function *PreProcessCache::preprocessForClone(Function *F,
-                                              DerivativeMode mode) {
-
-  if (mode == DerivativeMode::ReverseModeGradient)
-    mode = DerivativeMode::ReverseModePrimal;
-  if (mode == DerivativeMode::ForwardModeSplit)
-    mode = DerivativeMode::ReverseModePrimal;
-
+Function *PreProcessCache::preprocessCommon(Function *F) {
   // If we've already processed this, return the previous version
-  // and derive aliasing information
-  if (cache.find(std::make_pair(F, mode)) != cache.end()) {
-    Function *NewF = cache[std::make_pair(F, mode)];
-    return NewF;
-  }
+  auto found = commonCache.find(F);
+  if (found != commonCache.end())
+    return found->second;
 
   Function *NewF =
       Function::Create(F->getFunctionType(), F->getLinkage(),
-                       "preprocess_" + F->getName(), F->getParent());
+                       "preprocess_common_" + F->getName(), F->getParent());
 
   ValueToValueMapTy VMap;
   for (auto i = F->arg_begin(), j = NewF->arg_begin(); i != F->arg_end();) {
@@ -1300,8 +1360,9 @@ Function *PreProcessCache::preprocessForClone(Function *F,
   setFullWillReturn(NewF);
 
   if (EnzymePreopt) {
-    if (EnzymeInline) {
-      ForceRecursiveInlining(NewF, /*Limit*/ EnzymeInlineCount);
+    if (EnzymeInline || EnzymeInlineCostModel) {
+      ForceRecursiveInlining(NewF, /*Limit*/ EnzymeInlineCount,
+                             /*Force*/ EnzymeInline, /*Original*/ F);
       setFullWillReturn(NewF);
       PreservedAnalyses PA;
       FAM.invalidate(*NewF, PA);
@@ -1711,7 +1772,58 @@ Function *PreProcessCache::preprocessForClone(Function *F,
 #endif
       FAM.invalidate(*NewF, PA);
     }
+  }
+
+  commonCache[F] = NewF;
+  return NewF;
+}
+
+Function *PreProcessCache::preprocessForClone(Function *F,
+                                              DerivativeMode mode) {
+
+  if (mode == DerivativeMode::ReverseModeGradient)
+    mode = DerivativeMode::ReverseModePrimal;
+  if (mode == DerivativeMode::ForwardModeSplit)
+    mode = DerivativeMode::ReverseModePrimal;
+
+  // If we've already processed this, return the previous version
+  // and derive aliasing information
+  if (cache.find(std::make_pair(F, mode)) != cache.end()) {
+    Function *NewF = cache[std::make_pair(F, mode)];
+    return NewF;
+  }
+
+  // The mode independent simplifications are shared by all modes, only the
+  // transformations below are repeated per mode.
+  Function *Common = preprocessCommon(F);
+
+  Function *NewF =
+      Function::Create(F->getFunctionType(), F->getLinkage(),
+                       "preprocess_" + F->getName(), F->getParent());
 
+  ValueToValueMapTy VMap;
+  for (auto i = Common->arg_begin(), j = NewF->arg_begin();
+       i != Common->arg_end(); ++i, ++j) {
+    VMap[i] = j;
+    j->setName(i->getName());
+  }
+
+  SmallVector<ReturnInst *, 4> Returns;
+
+#if LLVM_VERSION_MAJOR >= 13
+  CloneFunctionInto(
+      NewF, Common, VMap,
+      /*ModuleLevelChanges*/ CloneFunctionChangeType::LocalChangesOnly, Returns,
+      "", nullptr);
+#else
+  CloneFunctionInto(NewF, Common, VMap,
+                    /*ModuleLevelChanges*/ Common->getSubprogram() != nullptr,
+                    Returns, "", nullptr);
+#endif
+  CloneOrigin[NewF] = F;
+  NewF->setAttributes(Common->getAttributes());
+
+  if (EnzymePreopt) {
     if (mode != DerivativeMode::ForwardMode)
       ReplaceReallocs(NewF);
 
@@ -2408,4 +2520,5 @@ void PreProcessCache::clear() {
   FAM.clear();
   MAM.clear();
   cache.clear();
+  commonCache.clear();
 }
@@ -55,6 +55,7 @@ public:
   // cache/origin maps.
   PreProcessCache(PreProcessCache &&prev) : PreProcessCache() {
     cache = std::move(prev.cache);
+    commonCache = std::move(prev.commonCache);
     CloneOrigin = std::move(prev.CloneOrigin);
   };
 
@@ -62,8 +63,12 @@ public:
   llvm::ModuleAnalysisManager MAM;
 
   std::map<std::pair<llvm::Function *, DerivativeMode>, llvm::Function *> cache;
+  /// Functions after the simplifications that do not depend on the derivative
+  /// mode, from which the per mode versions in `cache` are cloned.
+  std::map<llvm::Function *, llvm::Function *> commonCache;
   std::map<llvm::Function *, llvm::Function *> CloneOrigin;
 
+  llvm::Function *preprocessCommon(llvm::Function *F);
   llvm::Function *preprocessForClone(llvm::Function *F, DerivativeMode mode);
 
   llvm::AAResults &getAAResultsFromFunction(llvm::Function *NewF);
@@ -57,6 +57,7 @@
 #include "llvm/Support/AMDGPUMetadata.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/KnownBits.h"
 
 using namespace llvm;
 
@@ -101,6 +102,43 @@ llvm::cl::opt<bool>
                                cl::Hidden,
                                cl::desc("Perform runtime activity checks"));
 
+llvm::cl::opt<bool> EnzymeRuntimeActivityVersioning(
+    "enzyme-runtime-activity-versioning", cl::init(false), cl::Hidden,
+    cl::desc("Specialize derivatives with runtime activity checks for the "
+             "case that all checked arguments are distinct from their "
+             "shadows, dispatching once at function entry"));
+
+llvm::cl::opt<bool> EnzymeParallelReverseLoops(
+    "enzyme-parallel-reverse-loops", cl::init(false), cl::Hidden,
+    cl::desc("Mark the reverse of loops annotated parallel as parallel, "
+             "assuming the shadows of distinct primal memory do not overlap"));
+
+llvm::cl::opt<bool> EnzymePathTape(
+    "enzyme-path-tape", cl::init(false), cl::Hidden,
+    cl::desc("Record control flow as one Ball-Larus path identifier per "
+             "iteration of an innermost loop rather than one cache per "
+             "merging block"));
+
+llvm::cl::opt<int> EnzymePathTapeMaxPaths(
+    "enzyme-path-tape-max-paths", cl::init(256), cl::Hidden,
+    cl::desc("Maximum number of paths through a region for it to be "
+             "recorded as a path tape"));
+
+llvm::cl::opt<bool> EnzymeCacheNarrowIntegers(
+    "enzyme-cache-narrow-int", cl::init(false), cl::Hidden,
+    cl::desc("Store integers cached per loop iteration at the smallest width "
+             "their proven range requires"));
+
+llvm::cl::opt<bool> EnzymeInvertRecurrences(
+    "enzyme-invert-recurrences", cl::init(false), cl::Hidden,
+    cl::desc("Recover loop-carried values in the reverse pass by inverting "
+             "their update rather than caching every iteration"));
+
+llvm::cl::opt<bool> EnzymeInvertFPRecurrences(
+    "enzyme-invert-fp-recurrences", cl::init(false), cl::Hidden,
+    cl::desc("Also invert floating point recurrences, whose recovered values "
+             "may differ from the primal by rounding"));
+
 llvm::cl::opt<bool>
     EnzymeSharedForward("enzyme-shared-forward", cl::init(false), cl::Hidden,
                         cl::desc("Forward Shared Memory from definitions"));
@@ -322,6 +360,38 @@ Value *GradientUtils::ompThreadId() {
              "omp_get_thread_num", FT, AL));
 }
 
+Value *GradientUtils::getRuntimeActivityFlag(Value *origPtr) {
+  if (getWidth() != 1)
+    return nullptr;
+
+  // A pointer obtained from an argument by casts and GEPs is active exactly if
+  // the argument differs from its shadow, as the shadow is derived with the
+  // same offsets. This check is loop invariant, so compute it once.
+  Value *base = origPtr;
+  while (true) {
+    if (auto GEP = dyn_cast<GetElementPtrInst>(base))
+      base = GEP->getPointerOperand();
+    else if (isa<BitCastInst>(base) || isa<AddrSpaceCastInst>(base))
+      base = cast<CastInst>(base)->getOperand(0);
+    else
+      break;
+  }
+  auto arg = dyn_cast<Argument>(base);
+  if (!arg || arg->getParent() != oldFunc || isConstantValue(arg))
+    return nullptr;
+
+  Value *newArg = getNewFromOriginal(arg);
+  auto found = runtimeActivityFlags.find(newArg);
+  if (found != runtimeActivityFlags.end())
+    return found->second;
+
+  IRBuilder<> B(inversionAllocs);
+  Value *flag = B.CreateICmpNE(newArg, invertPointerM(arg, B),
+                               arg->getName() + "'active");
+  runtimeActivityFlags[newArg] = flag;
+  return flag;
+}
+
 Value *GradientUtils::ompNumThreads() {
   if (numThreads)
     return numThreads;
@@ -1253,6 +1323,7 @@ Value *GradientUtils::unwrapM(Value *const val, IRBuilder<> &BuilderM,
         for (size_t j = 0; j < getWidth(); j++) {
           MDs.push_back(getDerivativeAliasScope(orig->getOperand(0), j));
         }
+        MDs.push_back(getCacheAliasScope());
         if (auto prev = orig->getMetadata(LLVMContext::MD_noalias)) {
           for (auto &M : cast<MDNode>(prev)->operands()) {
             MDs.push_back(M);
@@ -1439,6 +1510,7 @@ Value *GradientUtils::unwrapM(Value *const val, IRBuilder<> &BuilderM,
                 if (j != (ssize_t)s_idx)
                   MDs.push_back(getDerivativeAliasScope(dli->getOperand(0), j));
               }
+              MDs.push_back(getCacheAliasScope());
               if (auto prev = dli->getMetadata(LLVMContext::MD_noalias)) {
                 for (auto &M : cast<MDNode>(prev)->operands()) {
                   MDs.push_back(M);
@@ -2391,6 +2463,34 @@ endCheck:
   return nullptr;
 }
 
+IntegerType *GradientUtils::getNarrowedCacheType(Instruction *inst) {
+  auto IT = dyn_cast<IntegerType>(inst->getType());
+  if (!IT || IT->getBitWidth() <= 8)
+    return nullptr;
+  unsigned bits = IT->getBitWidth();
+
+  auto &DL = newFunc->getParent()->getDataLayout();
+  auto Known = computeKnownBits(inst, DL);
+  bits = std::min(bits, Known.getBitWidth() - Known.countMinLeadingZeros());
+
+  // The original function is analyzed with the unmodified scalar evolution,
+  // which does not assume that loops exit.
+  if (auto orig = isOriginal(inst)) {
+    if (OrigSE.isSCEVable(orig->getType())) {
+      auto S = OrigSE.getSCEV(orig);
+      if (!isa<SCEVCouldNotCompute>(S))
+        bits = std::min(bits, OrigSE.getUnsignedRangeMax(S).getActiveBits());
+    }
+  }
+
+  unsigned width = 8;
+  while (width < bits)
+    width *= 2;
+  if (width >= IT->getBitWidth())
+    return nullptr;
+  return IntegerType::get(inst->getContext(), width);
+}
+
 void GradientUtils::ensureLookupCached(Instruction *inst, bool shouldFree,
                                        BasicBlock *scope, MDNode *TBAA) {
   assert(inst);
@@ -2404,9 +2504,27 @@ void GradientUtils::ensureLookupCached(Instruction *inst, bool shouldFree,
 
   LimitContext lctx(/*ReverseLimit*/ reverseBlocks.size() > 0, scope);
 
-  AllocaInst *cache =
-      createCacheForScope(lctx, inst->getType(), inst->getName(), shouldFree);
+  // Values cached per loop iteration may be stored at reduced floating point
+  // precision, trading accuracy of the derivative for tape size.
+  Type *CT = nullptr;
+  if (getSubLimits(/*inForwardPass*/ true, nullptr, lctx).size() != 0) {
+    CT = getCompressedCacheType(inst->getType());
+    // Integers are narrowed to their proven range. Without typed pointers the
+    // reverse pass could not recover the width of a cache passed on the tape.
+    if (!CT && EnzymeCacheNarrowIntegers) {
+#if LLVM_VERSION_MAJOR >= 15
+      if (mode != DerivativeMode::ReverseModePrimal ||
+          inst->getContext().supportsTypedPointers())
+#endif
+        CT = getNarrowedCacheType(inst);
+    }
+  }
+
+  AllocaInst *cache = createCacheForScope(lctx, CT ? CT : inst->getType(),
+                                          inst->getName(), shouldFree);
   assert(cache);
+  if (CT)
+    CompressedCaches[cache] = CT;
   Value *Val = inst;
   insert_or_assign(
       scopeMap, Val,
@@ -2698,10 +2816,29 @@ Value *GradientUtils::cacheForReverse(IRBuilder<> &BuilderQ, Value *malloc,
       }
 #endif
 
+      Type *compressedType = getCompressedCacheType(malloc->getType());
+#if LLVM_VERSION_MAJOR >= 15
+      if (!ret->getContext().supportsTypedPointers() && compressedType &&
+          getSubLimits(/*inForwardPass*/ true, nullptr,
+                       LimitContext(
+                           /*ReverseLimit*/ reverseBlocks.size() > 0,
+                           BuilderQ.GetInsertBlock()))
+                  .size() != 0)
+        innerType = compressedType;
+#endif
+      // Integers narrowed to their proven range by the augmented forward pass
+      if (!compressedType && innerType->isIntegerTy() &&
+          malloc->getType()->isIntegerTy() &&
+          cast<IntegerType>(innerType)->getBitWidth() <
+              cast<IntegerType>(malloc->getType())->getBitWidth())
+        compressedType = innerType;
+
       if (EfficientBoolCache && malloc->getType()->isIntegerTy() &&
           cast<IntegerType>(malloc->getType())->getBitWidth() == 1 &&
           innerType != ret->getType()) {
         assert(innerType == Type::getInt8Ty(malloc->getContext()));
+      } else if (compressedType && innerType == compressedType) {
+        // Stored at reduced width by the augmented forward pass
       } else {
         if (innerType != malloc->getType()) {
           llvm::errs() << *oldFunc << "\n";
@@ -2733,9 +2870,13 @@ Value *GradientUtils::cacheForReverse(IRBuilder<> &BuilderQ, Value *malloc,
 #endif
       entryBuilder.CreateStore(ret, cache);
 
-      auto v =
-          lookupValueFromCache(innerType, /*forwardPass*/ true, BuilderQ, lctx,
-                               cache, isi1, /*available*/ ValueToValueMapTy());
+      bool compressed = compressedType && innerType == compressedType;
+      if (compressed)
+        CompressedCaches[cache] = innerType;
+
+      auto v = lookupValueFromCache(compressed ? malloc->getType() : innerType,
+                                    /*forwardPass*/ true, BuilderQ, lctx, cache,
+                                    isi1, /*available*/ ValueToValueMapTy());
       if (malloc) {
         assert(v->getType() == malloc->getType());
       }
@@ -3011,6 +3152,8 @@ Value *GradientUtils::cacheForReverse(IRBuilder<> &BuilderQ, Value *malloc,
           toadd->getType() != innerType &&
           cast<IntegerType>(malloc->getType())->getBitWidth() == 1) {
         assert(innerType == Type::getInt8Ty(toadd->getContext()));
+      } else if (CompressedCaches.count(found2->second.first)) {
+        assert(innerType == CompressedCaches[found2->second.first]);
       } else {
         if (innerType != malloc->getType()) {
           llvm::errs() << "oldFunc:" << *oldFunc << "\n";
@@ -3756,7 +3899,18 @@ BasicBlock *GradientUtils::getReverseOrLatchMerge(BasicBlock *BB,
             tbuild.CreateAdd(av, ConstantInt::get(av->getType(), -1), "",
                              /*NUW*/ false, /*NSW*/ true);
         tbuild.CreateStore(sub, lc.antivaralloc);
-        tbuild.CreateBr(resumeblock);
+        auto backedge = tbuild.CreateBr(resumeblock);
+        if (EnzymeInvertRecurrences) {
+          reverseBlockToPrimal[incB] = lc.header;
+          reverseLoopEntries[L].emplace_back(incB, false);
+          for (auto &pair : invertedRecurrences)
+            if (LI.getLoopFor(pair.first->getParent()) == L)
+              invertRecurrence(pair.first, incB, false);
+        }
+        if (isParallelReversible(L))
+          parallelReverseLoops.emplace_back(
+              SmallVector<BasicBlock *, 4>(L->block_begin(), L->block_end()),
+              backedge);
         return newBlocksForLoop_cache[tup] = incB;
       } else {
         assert(exitEntering);
@@ -3790,6 +3944,13 @@ BasicBlock *GradientUtils::getReverseOrLatchMerge(BasicBlock *BB,
         tbuild.SetInsertPoint(incB);
         tbuild.CreateStore(lim, lc.antivaralloc);
         tbuild.CreateBr(resumeblock);
+        if (EnzymeInvertRecurrences) {
+          reverseBlockToPrimal[incB] = branchingBlock;
+          reverseLoopEntries[L].emplace_back(incB, true);
+          for (auto &pair : invertedRecurrences)
+            if (LI.getLoopFor(pair.first->getParent()) == L)
+              invertRecurrence(pair.first, incB, true);
+        }
 
         return newBlocksForLoop_cache[tup] = incB;
       }
@@ -3799,6 +3960,246 @@ BasicBlock *GradientUtils::getReverseOrLatchMerge(BasicBlock *BB,
   return newBlocksForLoop_cache[tup] = reverseBlocks[BB].front();
 }
 
+bool GradientUtils::isParallelReversible(Loop *L) {
+  if (!EnzymeParallelReverseLoops)
+    return false;
+  auto origHeader = isOriginal(L->getHeader());
+  if (!origHeader)
+    return false;
+  Loop *origL = OrigLI.getLoopFor(origHeader);
+  if (!origL || !origL->isAnnotatedParallel())
+    return false;
+
+  // The primal loop has no loop carried dependencies, so a location stored in
+  // an iteration is not accessed by any other. The shadow updates of such
+  // locations, and of stores in general, are thus independent. Shadow
+  // accumulations for other loads may race on a location loaded by several
+  // iterations.
+  SmallPtrSet<Value *, 4> stored;
+  for (auto BB : origL->blocks())
+    for (auto &I : *BB)
+      if (auto SI = dyn_cast<StoreInst>(&I))
+        stored.insert(SI->getPointerOperand());
+  for (auto BB : origL->blocks())
+    for (auto &I : *BB) {
+      if (auto LI = dyn_cast<LoadInst>(&I)) {
+        if (!isConstantValue(LI) && !stored.count(LI->getPointerOperand()))
+          return false;
+      } else if (isa<CallBase>(&I) && I.mayReadOrWriteMemory() &&
+                 !isConstantInstruction(&I))
+        return false;
+    }
+  return true;
+}
+
+void GradientUtils::annotateParallelReverseLoops() {
+#if LLVM_VERSION_MAJOR >= 8
+  auto &Ctx = newFunc->getContext();
+  for (auto &pair : parallelReverseLoops) {
+    MDNode *group = MDNode::getDistinct(Ctx, {});
+    for (auto BB : pair.first) {
+      auto found = reverseBlocks.find(BB);
+      if (found == reverseBlocks.end())
+        continue;
+      for (auto RB : found->second)
+        for (auto &I : *RB) {
+          // Only accesses to cache memory and derivative accesses generated
+          // for the loop's primal memory accesses are known to be independent.
+          // Any other access keeps the loop from being treated as parallel.
+          bool tagged = false;
+          if (auto LI = dyn_cast<LoadInst>(&I))
+            tagged = CacheLookups.count(LI) ||
+                     LI->getMetadata(LLVMContext::MD_alias_scope);
+          else if (auto SI = dyn_cast<StoreInst>(&I))
+            tagged = SI->getMetadata(LLVMContext::MD_alias_scope);
+          if (tagged)
+            I.setMetadata(LLVMContext::MD_access_group, group);
+        }
+    }
+    MDNode *parallel = MDNode::get(
+        Ctx, {MDString::get(Ctx, "llvm.loop.parallel_accesses"), group});
+    MDNode *loopID = MDNode::getDistinct(Ctx, {nullptr, parallel});
+    loopID->replaceOperandWith(0, loopID);
+    pair.second->setMetadata(LLVMContext::MD_loop, loopID);
+  }
+#endif
+  parallelReverseLoops.clear();
+}
+
+BinaryOperator *GradientUtils::getInvertibleUpdate(PHINode *PN) {
+  if (!EnzymeInvertRecurrences || mode != DerivativeMode::ReverseModeCombined)
+    return nullptr;
+  Loop *L = OrigLI.getLoopFor(PN->getParent());
+  if (!L || L->getHeader() != PN->getParent() || !L->getLoopPreheader())
+    return nullptr;
+  // The reverse pass must begin each iteration at the reverse of the latch
+  BasicBlock *latch = L->getLoopLatch();
+  if (!latch || L->getExitingBlock() != latch ||
+      PN->getNumIncomingValues() != 2)
+    return nullptr;
+
+  // Affine recurrences are already recomputed from the induction variable
+  auto affine = [&](Value *V) {
+    if (!OrigSE.isSCEVable(V->getType()))
+      return false;
+    auto AR = dyn_cast<SCEVAddRecExpr>(OrigSE.getSCEV(V));
+    return AR && AR->getLoop() == L && AR->isAffine();
+  };
+  if (affine(PN))
+    return nullptr;
+
+  auto U = dyn_cast<BinaryOperator>(PN->getIncomingValueForBlock(latch));
+  if (!U || !L->contains(U))
+    return nullptr;
+  unsigned idx;
+  if (U->getOperand(0) == PN)
+    idx = 1;
+  else if (U->getOperand(1) == PN && U->isCommutative())
+    idx = 0;
+  else
+    return nullptr;
+
+  // The other operand has to be available in every reverse iteration without
+  // depending on the recurrence itself
+  Value *Y = U->getOperand(idx);
+  if (auto I = dyn_cast<Instruction>(Y))
+    if (L->contains(I) && !affine(I))
+      return nullptr;
+
+  auto &DL = oldFunc->getParent()->getDataLayout();
+  switch (U->getOpcode()) {
+  case BinaryOperator::Add:
+  case BinaryOperator::Sub:
+  case BinaryOperator::Xor:
+    return U;
+  case BinaryOperator::Mul:
+    if (auto CI = dyn_cast<ConstantInt>(Y))
+      if (CI->getValue()[0])
+        return U;
+    if ((U->hasNoUnsignedWrap() || U->hasNoSignedWrap()) &&
+        isKnownNonZero(Y, DL))
+      return U;
+    return nullptr;
+  case BinaryOperator::FAdd:
+  case BinaryOperator::FSub:
+    return EnzymeInvertFPRecurrences ? U : nullptr;
+  case BinaryOperator::FMul:
+  case BinaryOperator::FDiv:
+    if (auto CF = dyn_cast<ConstantFP>(Y))
+      if (EnzymeInvertFPRecurrences && CF->getValueAPF().isFiniteNonZero())
+        return U;
+    return nullptr;
+  default:
+    return nullptr;
+  }
+}
+
+void GradientUtils::invertRecurrence(PHINode *PN, BasicBlock *B,
+                                     bool fromExit) {
+  auto orig = cast<PHINode>(isOriginal(PN));
+  auto origU = getInvertibleUpdate(orig);
+  assert(origU);
+  auto U = cast<BinaryOperator>(getNewFromOriginal(origU));
+  unsigned idx = U->getOperand(0) == PN ? 1 : 0;
+  AllocaInst *AI = invertedRecurrences[PN];
+
+  IRBuilder<> BuilderM(B->getTerminator());
+  // Entering from the exit, the last update is looked up past the loop along
+  // with its operand from the last iteration. On the back edge the induction
+  // variable has already been decremented.
+  Value *next;
+  if (fromExit)
+    next = lookupM(U, BuilderM);
+  else
+#if LLVM_VERSION_MAJOR > 7
+    next = BuilderM.CreateLoad(PN->getType(), AI);
+#else
+    next = BuilderM.CreateLoad(AI);
+#endif
+  Value *Y = lookupM(U->getOperand(idx), BuilderM);
+
+  Value *prev;
+  switch (U->getOpcode()) {
+  case BinaryOperator::Add:
+    prev = BuilderM.CreateSub(next, Y);
+    break;
+  case BinaryOperator::Sub:
+    prev = BuilderM.CreateAdd(next, Y);
+    break;
+  case BinaryOperator::Xor:
+    prev = BuilderM.CreateXor(next, Y);
+    break;
+  case BinaryOperator::Mul:
+    if (auto CI = dyn_cast<ConstantInt>(Y)) {
+      // An odd factor has an inverse modulo 2^n, found by Newton iteration
+      APInt A = CI->getValue(), Inv = A;
+      while (A * Inv != 1)
+        Inv *= APInt(A.getBitWidth(), 2) - A * Inv;
+      prev = BuilderM.CreateMul(next, ConstantInt::get(Y->getType(), Inv));
+    } else if (U->hasNoUnsignedWrap())
+      prev = BuilderM.CreateExactUDiv(next, Y);
+    else
+      prev = BuilderM.CreateExactSDiv(next, Y);
+    break;
+  case BinaryOperator::FAdd:
+    prev = BuilderM.CreateFSub(next, Y);
+    break;
+  case BinaryOperator::FSub:
+    prev = BuilderM.CreateFAdd(next, Y);
+    break;
+  case BinaryOperator::FMul:
+    prev = BuilderM.CreateFDiv(next, Y);
+    break;
+  case BinaryOperator::FDiv:
+    prev = BuilderM.CreateFMul(next, Y);
+    break;
+  default:
+    llvm_unreachable("unhandled invertible recurrence");
+  }
+  if (auto I = dyn_cast<Instruction>(prev)) {
+    I->setName(PN->getName() + "_inv");
+    if (isa<FPMathOperator>(I))
+      I->copyFastMathFlags(U);
+  }
+  BuilderM.CreateStore(prev, AI);
+}
+
+Value *GradientUtils::lookupInvertedRecurrence(PHINode *PN,
+                                               IRBuilder<> &BuilderM) {
+  auto found = invertedRecurrences.find(PN);
+  if (found == invertedRecurrences.end()) {
+    auto orig = dyn_cast_or_null<PHINode>(isOriginal(PN));
+    if (!orig || !getInvertibleUpdate(orig))
+      return nullptr;
+  }
+
+  // Only lookups from within an iteration of the reverse loop see the value
+  // of the current iteration
+  auto fwd = reverseBlockToPrimal.find(BuilderM.GetInsertBlock());
+  if (fwd == reverseBlockToPrimal.end())
+    return nullptr;
+  Loop *L = LI.getLoopFor(PN->getParent());
+  if (!L->contains(fwd->second))
+    return nullptr;
+  for (auto &pair : reverseLoopEntries[L])
+    if (pair.first == BuilderM.GetInsertBlock())
+      return nullptr;
+
+  if (found == invertedRecurrences.end()) {
+    AllocaInst *AI = IRBuilder<>(inversionAllocs)
+                         .CreateAlloca(PN->getType(), nullptr,
+                                       PN->getName() + "'rec");
+    found = invertedRecurrences.emplace(PN, AI).first;
+    for (auto &pair : reverseLoopEntries[L])
+      invertRecurrence(PN, pair.first, pair.second);
+  }
+#if LLVM_VERSION_MAJOR > 7
+  return BuilderM.CreateLoad(PN->getType(), found->second);
+#else
+  return BuilderM.CreateLoad(found->second);
+#endif
+}
+
 void GradientUtils::forceContexts() {
   for (auto BB : originalBlocks) {
     LoopContext lc;
@@ -4855,6 +5256,7 @@ void GradientUtils::setPtrDiffe(Instruction *orig, Value *ptr, Value *newval,
         if (j != (ssize_t)idx)
           MDs.push_back(getDerivativeAliasScope(origptr, j));
       }
+      MDs.push_back(getCacheAliasScope());
       for (auto M : noAlias)
         MDs.push_back(M);
       if (MDs.size()) {
@@ -5550,6 +5952,7 @@ Value *GradientUtils::invertPointerM(Value *const oval, IRBuilder<> &BuilderM,
         if (j != (ssize_t)idx)
           MDs.push_back(getDerivativeAliasScope(op0, j));
       }
+      MDs.push_back(getCacheAliasScope());
       for (auto M : prevNoAlias)
         MDs.push_back(M);
       if (MDs.size()) {
@@ -6173,6 +6576,10 @@ Value *GradientUtils::lookupM(Value *val, IRBuilder<> &BuilderM,
     }
   }
 
+  if (auto PN = dyn_cast<PHINode>(inst))
+    if (auto V = lookupInvertedRecurrence(PN, BuilderM))
+      return V;
+
   Instruction *prelcssaInst = inst;
 
   assert(inst->getName() != "<badref>");
@@ -7025,13 +7432,11 @@ Value *GradientUtils::lookupM(Value *val, IRBuilder<> &BuilderM,
   Value *result =
       lookupValueFromCache(inst->getType(), /*isForwardPass*/ false, BuilderM,
                            found->second, found->first, isi1, available);
+  // The load reads the cache rather than the primal memory, so only keep its
+  // cache alias scope.
   if (auto LI2 = dyn_cast<LoadInst>(result))
-    if (auto LI1 = dyn_cast<LoadInst>(inst)) {
-      llvm::SmallVector<unsigned int, 9> ToCopy2(MD_ToCopy);
-      ToCopy2.push_back(LLVMContext::MD_noalias);
-      ToCopy2.push_back(LLVMContext::MD_alias_scope);
-      LI2->copyMetadata(*LI1, ToCopy2);
-    }
+    if (auto LI1 = dyn_cast<LoadInst>(inst))
+      LI2->copyMetadata(*LI1, MD_ToCopy);
   if (result->getType() != inst->getType()) {
     llvm::errs() << "newFunc: " << *newFunc << "\n";
     llvm::errs() << "result: " << *result << "\n";
@@ -7059,6 +7464,158 @@ BasicBlock *GradientUtils::originalForReverseBlock(BasicBlock &BB2) const {
   return found->second;
 }
 
+GradientUtils::PathTape *GradientUtils::getPathTape(Loop *L) {
+  auto found = pathTapes.find(L);
+  if (found != pathTapes.end())
+    return found->second.cache ? &found->second : nullptr;
+  PathTape &PT = pathTapes[L];
+
+  // The region must be acyclic once the back edges of L are removed
+  BasicBlock *entry;
+  if (L) {
+    if (!L->getSubLoops().empty())
+      return nullptr;
+    entry = L->getHeader();
+  } else {
+    if (!LI.empty())
+      return nullptr;
+    entry = getNewFromOriginal(&oldFunc->getEntryBlock());
+  }
+
+  auto inRegion = [&](BasicBlock *B) {
+    return B != entry && isOriginalBlock(*B) && LI.getLoopFor(B) == L;
+  };
+
+  // Successors within the region of every block, ordered predecessors first
+  std::map<BasicBlock *, SmallVector<BasicBlock *, 2>> succs;
+  std::map<BasicBlock *, bool> exiting;
+  SmallVector<BasicBlock *, 8> postorder;
+  {
+    SmallPtrSet<BasicBlock *, 8> seen;
+    SmallVector<std::pair<BasicBlock *, bool>, 8> todo = {{entry, false}};
+    while (todo.size()) {
+      auto cur = todo.pop_back_val();
+      if (cur.second) {
+        postorder.push_back(cur.first);
+        continue;
+      }
+      if (!seen.insert(cur.first).second)
+        continue;
+      auto term = cur.first->getTerminator();
+      if (!isa<BranchInst>(term) && !isa<SwitchInst>(term) &&
+          !isa<ReturnInst>(term) && !isa<UnreachableInst>(term))
+        return nullptr;
+      todo.emplace_back(cur.first, true);
+      auto &S = succs[cur.first];
+      exiting[cur.first] = term->getNumSuccessors() == 0;
+      for (BasicBlock *succ : successors(cur.first)) {
+        if (!inRegion(succ)) {
+          exiting[cur.first] = true;
+          continue;
+        }
+        if (llvm::is_contained(S, succ))
+          continue;
+        S.push_back(succ);
+        todo.emplace_back(succ, false);
+      }
+    }
+  }
+
+  // Reject irreducible cycles, which have an edge against the post order
+  {
+    std::map<BasicBlock *, size_t> position;
+    for (auto B : postorder)
+      position[B] = position.size();
+    for (auto B : postorder)
+      for (auto succ : succs[B])
+        if (position[succ] >= position[B])
+          return nullptr;
+  }
+
+  // Number the paths, with the edge out of the region first so that leaving
+  // from a block adds nothing to its path identifier
+  std::map<BasicBlock *, uint64_t> numPaths;
+  std::map<std::pair<BasicBlock *, BasicBlock *>, uint64_t> increment;
+  for (auto B : postorder) {
+    uint64_t total = exiting[B] ? 1 : 0;
+    for (auto succ : succs[B]) {
+      increment[std::make_pair(B, succ)] = total;
+      total += numPaths[succ];
+      if (total > (uint64_t)EnzymePathTapeMaxPaths)
+        return nullptr;
+    }
+    numPaths[B] = total;
+  }
+
+  IntegerType *IT;
+  if (numPaths[entry] <= 256)
+    IT = Type::getInt8Ty(newFunc->getContext());
+  else if (numPaths[entry] <= 65536)
+    IT = Type::getInt16Ty(newFunc->getContext());
+  else
+    IT = Type::getInt32Ty(newFunc->getContext());
+
+  // Enumerate the paths, which are few by the limit above
+  PT.paths.resize(numPaths[entry]);
+  {
+    SmallVector<BasicBlock *, 8> stack;
+    std::function<void(BasicBlock *, uint64_t)> visit = [&](BasicBlock *B,
+                                                             uint64_t id) {
+      stack.push_back(B);
+      if (exiting[B])
+        PT.paths[id] = stack;
+      for (auto succ : succs[B])
+        visit(succ, id + increment[std::make_pair(B, succ)]);
+      stack.pop_back();
+    };
+    visit(entry, 0);
+  }
+
+  // Accumulate the identifier along the edges taken and record it on leaving
+  // the region
+  LimitContext lctx(/*ReverseLimit*/ reverseBlocks.size() > 0, entry);
+  PT.type = IT;
+  PT.cache = createCacheForScope(lctx, IT, "path", /*shouldFree*/ true);
+  std::map<BasicBlock *, Value *> pathValue;
+  for (auto B : llvm::reverse(postorder)) {
+    Value *V = ConstantInt::get(IT, 0);
+    if (B != entry) {
+      IRBuilder<> PB(B, B->begin());
+      auto PN = PB.CreatePHI(IT, 2, "pathid");
+      // Edges repeated by a switch or branch must share their incoming value
+      std::map<BasicBlock *, Value *> incomings;
+      for (BasicBlock *pred : predecessors(B)) {
+        auto foundI = incomings.find(pred);
+        if (foundI != incomings.end()) {
+          PN->addIncoming(foundI->second, pred);
+          continue;
+        }
+        auto &inc = increment[std::make_pair(pred, B)];
+        auto foundV = pathValue.find(pred);
+        // Unreachable predecessors may pass any identifier
+        Value *incoming = foundV == pathValue.end() ? ConstantInt::get(IT, 0)
+                                                    : foundV->second;
+        if (inc != 0) {
+          IRBuilder<> IB(pred->getTerminator());
+          incoming = IB.CreateAdd(incoming, ConstantInt::get(IT, inc),
+                                  "pathid.next", /*NUW*/ true);
+        }
+        incomings[pred] = incoming;
+        PN->addIncoming(incoming, pred);
+      }
+      V = PN;
+    }
+    pathValue[B] = V;
+  }
+  for (auto B : postorder) {
+    if (!exiting[B])
+      continue;
+    IRBuilder<> SB(B->getTerminator());
+    storeInstructionInCache(lctx, SB, pathValue[B], PT.cache);
+  }
+  return &PT;
+}
+
 //! Given a map of edges we could have taken to desired target, compute a value
 //! that determines which target should be branched to
 //  This function attempts to determine an equivalent condition from earlier in
@@ -7535,10 +8092,98 @@ nofast:;
 
   // if freeing reverseblocks must exist
   assert(reverseBlocks.size());
-  LimitContext lctx(/*ReverseLimit*/ reverseBlocks.size() > 0, ctx);
-  AllocaInst *cache = createCacheForScope(lctx, T, "", /*shouldFree*/ true);
   SmallVector<BasicBlock *, 4> targets;
-  {
+  Value *which = nullptr;
+
+  // Recover the target from the path taken through the iteration, as the
+  // last block along it that would have stored its target index
+  if (EnzymePathTape && !isOriginalBlock(*BuilderM.GetInsertBlock())) {
+    Loop *L = LI.getLoopFor(ctx);
+    // Number the targets in block order so that the table emitted does not
+    // depend on where the blocks happen to be allocated
+    SmallVector<BasicBlock *, 4> ordered;
+    for (const auto &pair : targetToPreds)
+      ordered.push_back(pair.first);
+    {
+      std::map<BasicBlock *, size_t> position;
+      for (auto &BB : *newFunc)
+        position[&BB] = position.size();
+      llvm::sort(ordered, [&](BasicBlock *lhs, BasicBlock *rhs) {
+        return position[lhs] < position[rhs];
+      });
+    }
+    std::map<BasicBlock *, unsigned> storingIdx;
+    bool legal = true;
+    unsigned idx = 0;
+    for (auto target : ordered) {
+      for (auto pred : targetToPreds.find(target)->second) {
+        auto insert = storingIdx.emplace(pred.first, idx);
+        if (!insert.second && insert.first->second != idx)
+          legal = false;
+        if (LI.getLoopFor(pred.first) != L)
+          legal = false;
+      }
+      ++idx;
+    }
+    PathTape *PT = legal ? getPathTape(L) : nullptr;
+    if (PT) {
+      targets.append(ordered.begin(), ordered.end());
+
+      IntegerType *ET = T->getBitWidth() == 1
+                            ? Type::getInt8Ty(BuilderM.getContext())
+                            : T;
+      SmallVector<Constant *, 8> table;
+      bool uniform = true;
+      bool identity = T->getBitWidth() >= PT->type->getBitWidth();
+      for (const auto &path : PT->paths) {
+        unsigned target = 0;
+        for (auto B : path) {
+          auto found = storingIdx.find(B);
+          if (found != storingIdx.end())
+            target = found->second;
+        }
+        identity &= target == table.size();
+        table.push_back(ConstantInt::get(ET, target));
+        uniform &= table.back() == table[0];
+      }
+
+      if (uniform) {
+        which =
+            ConstantInt::get(T, cast<ConstantInt>(table[0])->getZExtValue());
+      } else {
+        Value *pathID = lookupValueFromCache(
+            PT->type, /*forwardPass*/ false, BuilderM,
+            LimitContext(/*ReverseLimit*/ true, ctx), PT->cache,
+            /*isi1*/ false, /*available*/ ValueToValueMapTy());
+        if (identity) {
+          which = BuilderM.CreateZExt(pathID, T);
+        } else {
+          auto AT = ArrayType::get(ET, table.size());
+          auto GV = new GlobalVariable(
+              *newFunc->getParent(), AT, /*isConstant*/ true,
+              GlobalValue::PrivateLinkage, ConstantArray::get(AT, table),
+              newFunc->getName() + "_pathtable");
+          GV->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+          Value *idxs[] = {
+              ConstantInt::get(Type::getInt64Ty(BuilderM.getContext()), 0),
+              BuilderM.CreateZExt(pathID,
+                                  Type::getInt64Ty(BuilderM.getContext()))};
+#if LLVM_VERSION_MAJOR > 7
+          which = BuilderM.CreateLoad(
+              ET, BuilderM.CreateInBoundsGEP(AT, GV, idxs));
+#else
+          which = BuilderM.CreateLoad(BuilderM.CreateInBoundsGEP(GV, idxs));
+#endif
+          if (ET != T)
+            which = BuilderM.CreateTrunc(which, T);
+        }
+      }
+    }
+  }
+
+  if (!which) {
+    LimitContext lctx(/*ReverseLimit*/ reverseBlocks.size() > 0, ctx);
+    AllocaInst *cache = createCacheForScope(lctx, T, "", /*shouldFree*/ true);
     size_t idx = 0;
     std::map<BasicBlock * /*storingblock*/,
              std::map<ConstantInt * /*target*/,
@@ -7574,14 +8219,15 @@ nofast:;
       }
       storeInstructionInCache(lctx, pbuilder, tostore, cache);
     }
-  }
 
-  bool isi1 = T->isIntegerTy() && cast<IntegerType>(T)->getBitWidth() == 1;
-  Value *which = lookupValueFromCache(
-      T,
-      /*forwardPass*/ isOriginalBlock(*BuilderM.GetInsertBlock()), BuilderM,
-      LimitContext(/*reversePass*/ reverseBlocks.size() > 0, ctx), cache, isi1,
-      /*available*/ ValueToValueMapTy());
+    bool isi1 = T->isIntegerTy() && cast<IntegerType>(T)->getBitWidth() == 1;
+    which = lookupValueFromCache(
+        T,
+        /*forwardPass*/ isOriginalBlock(*BuilderM.GetInsertBlock()), BuilderM,
+        LimitContext(/*reversePass*/ reverseBlocks.size() > 0, ctx), cache,
+        isi1,
+        /*available*/ ValueToValueMapTy());
+  }
   assert(which);
   assert(which->getType() == T);
 
@@ -7693,6 +8339,9 @@ void GradientUtils::computeMinCache() {
                 LoopAvail[L].insert(I);
             }
           }
+          // Recovered in the reverse pass by inverting the update
+          if (getInvertibleUpdate(PN))
+            LoopAvail[L].insert(PN);
         } else if (auto CI = dyn_cast<CallInst>(&I)) {
           StringRef funcName = getFuncNameFromCall(CI);
           if (isAllocationFunction(funcName, TLI))
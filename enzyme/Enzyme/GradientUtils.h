@@ -35,6 +35,7 @@
 #include <llvm/Config/llvm-config.h>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 
@@ -86,6 +87,10 @@ extern std::map<
 
 extern "C" {
 extern llvm::cl::opt<bool> EnzymeRuntimeActivityCheck;
+extern llvm::cl::opt<bool> EnzymeRuntimeActivityVersioning;
+extern llvm::cl::opt<bool> EnzymeParallelReverseLoops;
+extern llvm::cl::opt<bool> EnzymePathTape;
+extern llvm::cl::opt<bool> EnzymeInvertRecurrences;
 extern llvm::cl::opt<bool> EnzymeInactiveDynamic;
 extern llvm::cl::opt<bool> EnzymeFreeInternalAllocations;
 extern llvm::cl::opt<bool> EnzymeRematerialize;
@@ -183,6 +188,14 @@ public:
   llvm::Value *numThreads;
   llvm::Value *ompNumThreads();
 
+  /// Runtime activity checks (primal != shadow) of pointer arguments, hoisted
+  /// into the entry block and keyed by the argument of the new function.
+  llvm::MapVector<llvm::Value *, llvm::Value *> runtimeActivityFlags;
+  /// Returns the hoisted runtime activity check for a pointer based on an
+  /// argument of the original function, or null if it must be checked at
+  /// the use.
+  llvm::Value *getRuntimeActivityFlag(llvm::Value *origPtr);
+
   llvm::Value *getOrInsertTotalMultiplicativeProduct(llvm::Value *val,
                                                      LoopContext &lc);
 
@@ -417,6 +430,17 @@ public:
   llvm::BasicBlock *getReverseOrLatchMerge(llvm::BasicBlock *BB,
                                            llvm::BasicBlock *branchingBlock);
 
+  //! Reverse loops whose iterations are independent, given as the forward
+  //! blocks of the loop and the back edge of the reverse loop
+  std::vector<std::pair<llvm::SmallVector<llvm::BasicBlock *, 4>,
+                        llvm::BranchInst *>>
+      parallelReverseLoops;
+  //! Return whether the reverse of the (newFunc) loop L may be marked parallel
+  bool isParallelReversible(llvm::Loop *L);
+  //! Mark the derivative and cache accesses of the parallel reverse loops with
+  //! an access group and their back edges with llvm.loop.parallel_accesses
+  void annotateParallelReverseLoops();
+
   void forceContexts();
 
   void computeMinCache();
@@ -451,6 +475,11 @@ public:
                        UnwrapMode unwrapMode, llvm::BasicBlock *scope = nullptr,
                        bool permitCache = true) override final;
 
+  /// Return the narrowest integer type that provably holds every value of
+  /// the integer instruction inst when zero extended, or null if it cannot
+  /// be stored in fewer bits
+  llvm::IntegerType *getNarrowedCacheType(llvm::Instruction *inst);
+
   void ensureLookupCached(llvm::Instruction *inst, bool shouldFree = true,
                           llvm::BasicBlock *scope = nullptr,
                           llvm::MDNode *TBAA = nullptr);
@@ -479,6 +508,41 @@ public:
       EnzymeLogic &Logic, llvm::TargetLibraryInfo &TLI, TypeAnalysis &TA,
       llvm::Function *F, DerivativeMode mode, unsigned width, bool AtomicAdd);
 
+  //! Ball-Larus numbering of the paths through one iteration of an innermost
+  //! loop (or through a loop-free function), recorded once per iteration so
+  //! the reverse pass can replay every branch of the iteration from it
+  struct PathTape {
+    //! Per-iteration cache of the path identifier, null if the region
+    //! cannot be numbered
+    llvm::AllocaInst *cache = nullptr;
+    llvm::IntegerType *type = nullptr;
+    //! Blocks along each path, indexed by path identifier
+    std::vector<llvm::SmallVector<llvm::BasicBlock *, 8>> paths;
+  };
+  std::map<llvm::Loop *, PathTape> pathTapes;
+  //! Return the path tape of the region whose innermost loop is L, creating
+  //! it on first use, or null if the region is not suitable
+  PathTape *getPathTape(llvm::Loop *L);
+
+  //! Return the update of a loop-carried phi of the original function from
+  //! which the value of the previous iteration can be recovered, or null
+  llvm::BinaryOperator *getInvertibleUpdate(llvm::PHINode *PN);
+  //! Reverse pass storage of the current value of each loop-carried phi that
+  //! is recovered by inverting its update rather than cached
+  std::map<llvm::PHINode *, llvm::AllocaInst *> invertedRecurrences;
+  //! Blocks which begin an iteration of each reverse loop, and whether they
+  //! enter it from the loop exit
+  std::map<llvm::Loop *,
+           llvm::SmallVector<std::pair<llvm::BasicBlock *, bool>, 2>>
+      reverseLoopEntries;
+  //! Emit the inversion of the update of PN at the end of the reverse loop
+  //! entry block B
+  void invertRecurrence(llvm::PHINode *PN, llvm::BasicBlock *B, bool fromExit);
+  //! Return the value of the loop-carried phi PN in the current reverse
+  //! iteration, or null if it is not recovered by inversion
+  llvm::Value *lookupInvertedRecurrence(llvm::PHINode *PN,
+                                        llvm::IRBuilder<> &BuilderM);
+
   void branchToCorrespondingTarget(
       llvm::BasicBlock *ctx, llvm::IRBuilder<> &BuilderM,
       const std::map<llvm::BasicBlock *,
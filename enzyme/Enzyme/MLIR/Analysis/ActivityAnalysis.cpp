@@ -0,0 +1,248 @@
+//===- ActivityAnalysis.cpp - Activity analysis for MLIR functions --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the activity analysis for MLIR functions as a pair of
+// sparse data-flow analyses. The forward analysis marks values that may
+// depend on an active argument ("varied"), the backward analysis marks values
+// that may contribute to an active return value or to memory ("useful").
+// A value is active if it is both varied and useful.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Analysis/ActivityAnalysis.h"
+
+#include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlow/SparseAnalysis.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+using namespace mlir;
+using namespace mlir::enzyme;
+using namespace mlir::dataflow;
+
+namespace {
+
+/// Lattice value shared by both directions: a value is either known to be
+/// inactive (the initial state) or may be active.
+class ActivityState {
+public:
+  ActivityState(bool active = false) : active(active) {}
+
+  bool isActive() const { return active; }
+
+  static ActivityState join(const ActivityState &lhs,
+                            const ActivityState &rhs) {
+    return lhs.active || rhs.active;
+  }
+
+  /// The backward analysis is a may-analysis as well, so meeting two states
+  /// takes their union.
+  static ActivityState meet(const ActivityState &lhs,
+                            const ActivityState &rhs) {
+    return join(lhs, rhs);
+  }
+
+  bool operator==(const ActivityState &rhs) const {
+    return active == rhs.active;
+  }
+
+  void print(raw_ostream &os) const { os << (active ? "active" : "constant"); }
+
+private:
+  bool active;
+};
+
+class ForwardActivity : public Lattice<ActivityState> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ForwardActivity)
+  using Lattice::Lattice;
+};
+
+class BackwardActivity : public Lattice<ActivityState> {
+public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(BackwardActivity)
+  using Lattice::Lattice;
+};
+
+/// Returns true if `op` allocates the memory that `value` refers to. Fresh
+/// memory may later be written with active data, so it has to be treated as
+/// varied even if none of the operands of `op` are.
+static bool allocates(Operation *op, Value value) {
+  auto memOp = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!memOp)
+    return false;
+  SmallVector<MemoryEffects::EffectInstance> effects;
+  memOp.getEffectsOnValue(value, effects);
+  return llvm::any_of(effects, [](const MemoryEffects::EffectInstance &e) {
+    return isa<MemoryEffects::Allocate>(e.getEffect());
+  });
+}
+
+/// Returns true if `op` may write to memory, in which case the values it
+/// stores (and the memory it stores to) may be read by an active use that the
+/// SSA graph does not show.
+static bool mayWriteMemory(Operation *op) {
+  if (auto memOp = dyn_cast<MemoryEffectOpInterface>(op))
+    return memOp.hasEffect<MemoryEffects::Write>();
+  return !isMemoryEffectFree(op);
+}
+
+class ForwardActivityAnalysis
+    : public SparseDataFlowAnalysis<ForwardActivity> {
+public:
+  ForwardActivityAnalysis(DataFlowSolver &solver, FunctionOpInterface fn,
+                          ArrayRef<DIFFE_TYPE> argActivity)
+      : SparseDataFlowAnalysis(solver), fn(fn), argActivity(argActivity) {}
+
+  void visitOperation(Operation *op,
+                      ArrayRef<const ForwardActivity *> operands,
+                      ArrayRef<ForwardActivity *> results) override {
+    bool active = llvm::any_of(operands, [](const ForwardActivity *operand) {
+      return operand->getValue().isActive();
+    });
+
+    // Ops with regions that the framework does not model (e.g. linalg.generic)
+    // may compute their results from values captured from above.
+    if (!active && op->getNumRegions() != 0) {
+      op->walk([&](Operation *nested) {
+        for (Value operand : nested->getOperands()) {
+          if (op->isAncestor(operand.getParentRegion()->getParentOp()))
+            continue;
+          active |= getLatticeElementFor(op, operand)->getValue().isActive();
+        }
+      });
+    }
+
+    for (auto [result, lattice] : llvm::zip(op->getResults(), results)) {
+      bool resultActive =
+          active || allocates(op, result) ||
+          (op->getNumOperands() == 0 && !isMemoryEffectFree(op));
+      propagateIfChanged(lattice, lattice->join(ActivityState(resultActive)));
+    }
+  }
+
+  void setToEntryState(ForwardActivity *lattice) override {
+    bool active = true;
+    if (auto arg = lattice->getPoint().dyn_cast<BlockArgument>()) {
+      Block *entry = &fn.getFunctionBody().front();
+      if (arg.getOwner() == entry && arg.getArgNumber() < argActivity.size())
+        active = argActivity[arg.getArgNumber()] != DIFFE_TYPE::CONSTANT;
+    }
+    propagateIfChanged(lattice, lattice->join(ActivityState(active)));
+  }
+
+private:
+  FunctionOpInterface fn;
+  ArrayRef<DIFFE_TYPE> argActivity;
+};
+
+class BackwardActivityAnalysis
+    : public SparseBackwardDataFlowAnalysis<BackwardActivity> {
+public:
+  BackwardActivityAnalysis(DataFlowSolver &solver,
+                           SymbolTableCollection &symbolTable,
+                           FunctionOpInterface fn, DIFFE_TYPE returnActivity)
+      : SparseBackwardDataFlowAnalysis(solver, symbolTable), fn(fn),
+        returnActivity(returnActivity) {}
+
+  void visitOperation(Operation *op, ArrayRef<BackwardActivity *> operands,
+                      ArrayRef<const BackwardActivity *> results) override {
+    bool useful = llvm::any_of(results, [](const BackwardActivity *result) {
+      return result->getValue().isActive();
+    });
+    useful |= mayWriteMemory(op);
+
+    // Terminators not modelled by the framework forward their operands to
+    // the parent op. Returns of the analyzed function are useful only if the
+    // return value is active; anything else is conservatively useful.
+    if (op->hasTrait<OpTrait::IsTerminator>()) {
+      Operation *parent = op->getParentOp();
+      if (parent == fn.getOperation())
+        useful |= returnActivity != DIFFE_TYPE::CONSTANT;
+      else if (!isa<RegionBranchOpInterface>(parent))
+        useful = true;
+    }
+
+    for (BackwardActivity *operand : operands)
+      propagateIfChanged(operand, operand->meet(ActivityState(useful)));
+  }
+
+  // Non-forwarded branch operands (conditions, switch values) never carry a
+  // derivative.
+  void visitBranchOperand(OpOperand &operand) override {}
+
+  void setToExitState(BackwardActivity *lattice) override {
+    propagateIfChanged(lattice, lattice->meet(ActivityState(true)));
+  }
+
+private:
+  FunctionOpInterface fn;
+  DIFFE_TYPE returnActivity;
+};
+
+/// Returns whether `fn` calls a function whose body is available, which the
+/// analysis then has to see to propagate activity through the call.
+static bool callsDefinedFunction(FunctionOpInterface fn,
+                                 SymbolTableCollection &symbolTable) {
+  auto result = fn->walk([&](CallOpInterface call) {
+    auto callable = dyn_cast_or_null<CallableOpInterface>(
+        call.resolveCallable(&symbolTable));
+    if (callable && callable.getCallableRegion() &&
+        !callable.getCallableRegion()->empty())
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+} // namespace
+
+MActivityAnalyzer::MActivityAnalyzer(FunctionOpInterface fn,
+                                     ArrayRef<DIFFE_TYPE> argActivity,
+                                     DIFFE_TYPE returnActivity)
+    : fn(fn) {
+  // Dead code analysis and constant propagation are required by the sparse
+  // analyses to know which blocks are executable and which call sites are
+  // known.
+  solver.load<DeadCodeAnalysis>();
+  solver.load<SparseConstantPropagation>();
+  solver.load<ForwardActivityAnalysis>(fn, argActivity);
+  solver.load<BackwardActivityAnalysis>(symbolTable, fn, returnActivity);
+
+  // The analysis costs time proportional to the IR it is run on, and one is
+  // built for every derivative, so only analyze the function itself unless
+  // it calls functions whose bodies are needed for precise results. In that
+  // case analyze the enclosing symbol table so that the callees are analyzed
+  // with it; calls to external functions are handled conservatively either
+  // way.
+  Operation *top = nullptr;
+  if (callsDefinedFunction(fn, symbolTable))
+    top = fn->getParentWithTrait<OpTrait::SymbolTable>();
+  if (!top)
+    top = fn.getOperation();
+  valid = succeeded(solver.initializeAndRun(top));
+}
+
+bool MActivityAnalyzer::isConstantValue(Value v) const {
+  if (!valid)
+    return false;
+
+  // Values the forward analysis never reached were not part of the analyzed
+  // function (e.g. created during differentiation).
+  auto *varied = solver.lookupState<ForwardActivity>(v);
+  if (!varied)
+    return false;
+  if (!varied->getValue().isActive())
+    return true;
+
+  // A value without any lattice in the backward direction has no users.
+  auto *useful = solver.lookupState<BackwardActivity>(v);
+  return !useful || !useful->getValue().isActive();
+}
@@ -0,0 +1,49 @@
+//===- ActivityAnalysis.h - Activity analysis for MLIR functions -* C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the activity analysis used when differentiating MLIR
+// functions. It mirrors the semantics of the LLVM ActivityAnalyzer: a value is
+// active only if it may depend on an active input (forward direction) and may
+// contribute to an active output (backward direction).
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "mlir/Analysis/DataFlowFramework.h"
+#include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/SymbolTable.h"
+
+#include "../../Utils.h"
+
+namespace mlir {
+namespace enzyme {
+
+/// Computes which values of a function carry derivative information, given
+/// the activity of its arguments and return value. The analysis is run with
+/// MLIR's sparse data-flow framework once at construction; queries afterwards
+/// only look up the solver state.
+class MActivityAnalyzer {
+public:
+  MActivityAnalyzer(FunctionOpInterface fn, ArrayRef<DIFFE_TYPE> argActivity,
+                    DIFFE_TYPE returnActivity);
+
+  /// Returns true if `v`, a value of the analyzed function, has been proven
+  /// not to carry any derivative. Values the analysis did not reach are
+  /// conservatively considered active.
+  bool isConstantValue(Value v) const;
+
+private:
+  FunctionOpInterface fn;
+  SymbolTableCollection symbolTable;
+  DataFlowSolver solver;
+  bool valid;
+};
+
+} // namespace enzyme
+} // namespace mlir
@@ -13,6 +13,7 @@
 
 #include "Implementations/CoreDialectsAutoDiffImplementations.h"
 #include "Interfaces/AutoDiffOpInterface.h"
+#include "Interfaces/AutoDiffTypeInterface.h"
 #include "Interfaces/GradientUtils.h"
 #include "Interfaces/GradientUtilsReverse.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -27,6 +28,8 @@ using namespace mlir;
 using namespace mlir::enzyme;
 
 namespace {
+#include "Implementations/ArithDerivatives.inc"
+
 struct MulFOpInterface
     : public AutoDiffOpInterface::ExternalModel<MulFOpInterface,
                                                 arith::MulFOp> {
@@ -184,5 +187,7 @@ void mlir::enzyme::registerArithDialectAutoDiffInterface(
 
     arith::AddFOp::attachInterface<AddFOpInterface>(*context);
     arith::MulFOp::attachInterface<MulFOpInterface>(*context);
+
+    registerInterfaces(context);
   });
 }
@@ -14,7 +14,9 @@
 #include "Implementations/CoreDialectsAutoDiffImplementations.h"
 #include "Interfaces/AutoDiffTypeInterface.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/BuiltinDialect.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectRegistry.h"
@@ -46,6 +48,67 @@ public:
 
   bool requiresShadow(Type self) const { return false; }
 };
+
+// Vectors are values as well; elementwise arith and math ops on them are
+// differentiated with the same rules as on scalars.
+class VectorTypeInterface
+    : public AutoDiffTypeInterface::ExternalModel<VectorTypeInterface,
+                                                  VectorType> {
+public:
+  Value createNullValue(Type self, OpBuilder &builder, Location loc) const {
+    return builder.create<arith::ConstantOp>(loc, builder.getZeroAttr(self));
+  }
+
+  Value createAddOp(Type self, OpBuilder &builder, Location loc, Value a,
+                    Value b) const {
+    return builder.create<arith::AddFOp>(loc, a, b);
+  }
+
+  Type getShadowType(Type self, unsigned width) const {
+    assert(width == 1 && "unsupported width != 1");
+    return self;
+  }
+
+  bool requiresShadow(Type self) const { return false; }
+};
+
+// Ranked tensors have value semantics, so their adjoints are plain SSA tensors
+// rather than shadow buffers.
+class TensorTypeInterface
+    : public AutoDiffTypeInterface::ExternalModel<TensorTypeInterface,
+                                                  RankedTensorType> {
+public:
+  Value createNullValue(Type self, OpBuilder &builder, Location loc) const {
+    auto tensorType = self.cast<RankedTensorType>();
+    if (!tensorType.hasStaticShape()) {
+      // The sizes of a dynamically shaped zero are only known from a value of
+      // that type, which the tensor dialect implementations provide. Reject
+      // other uses, but still return a well-typed (empty) tensor so that the
+      // IR stays valid until the pass fails.
+      emitError(loc) << "cannot create a zero of dynamically shaped type "
+                     << tensorType << " without its sizes";
+      Value size = builder.create<arith::ConstantIndexOp>(loc, 0);
+      SmallVector<Value> sizes(tensorType.getNumDynamicDims(), size);
+      return builder.create<tensor::EmptyOp>(loc, tensorType.getShape(),
+                                             tensorType.getElementType(),
+                                             sizes);
+    }
+    return builder.create<arith::ConstantOp>(loc,
+                                             builder.getZeroAttr(tensorType));
+  }
+
+  Value createAddOp(Type self, OpBuilder &builder, Location loc, Value a,
+                    Value b) const {
+    return builder.create<arith::AddFOp>(loc, a, b);
+  }
+
+  Type getShadowType(Type self, unsigned width) const {
+    assert(width == 1 && "unsupported width != 1");
+    return self;
+  }
+
+  bool requiresShadow(Type self) const { return false; }
+};
 } // namespace
 
 void mlir::enzyme::registerBuiltinDialectAutoDiffInterface(
@@ -55,5 +118,7 @@ void mlir::enzyme::registerBuiltinDialectAutoDiffInterface(
     Float16Type::attachInterface<FloatTypeInterface>(*context);
     Float32Type::attachInterface<FloatTypeInterface>(*context);
     Float64Type::attachInterface<FloatTypeInterface>(*context);
+    RankedTensorType::attachInterface<TensorTypeInterface>(*context);
+    VectorType::attachInterface<VectorTypeInterface>(*context);
   });
 }
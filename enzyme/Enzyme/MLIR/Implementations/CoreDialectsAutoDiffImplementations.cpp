@@ -0,0 +1,30 @@
+//===- CoreDialectsAutoDiffImplementations.cpp - Impl helpers -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains helpers shared by the external model implementations of
+// the automatic differentiation interfaces for upstream MLIR dialects.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Implementations/CoreDialectsAutoDiffImplementations.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/TypeUtilities.h"
+
+using namespace mlir;
+
+Value mlir::enzyme::detail::createConstantFP(OpBuilder &builder, Location loc,
+                                             Type type, StringRef value) {
+  auto floatType = getElementTypeOrSelf(type).cast<FloatType>();
+  APFloat apf(floatType.getFloatSemantics(), value);
+  if (auto shapedType = type.dyn_cast<ShapedType>())
+    return builder.create<arith::ConstantOp>(
+        loc, DenseElementsAttr::get(shapedType,
+                                    builder.getFloatAttr(floatType, apf)));
+  return builder.create<arith::ConstantFloatOp>(loc, apf, floatType);
+}
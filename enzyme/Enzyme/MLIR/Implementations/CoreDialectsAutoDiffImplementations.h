@@ -12,14 +12,27 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "mlir/IR/Builders.h"
+
 namespace mlir {
 class DialectRegistry;
 
 namespace enzyme {
+namespace detail {
+// Materializes the floating-point constant `value` as a scalar, or as a splat
+// if `type` is a vector or tensor type. Used by the tablegen'd derivatives.
+Value createConstantFP(OpBuilder &builder, Location loc, Type type,
+                       StringRef value);
+} // namespace detail
+
 void registerArithDialectAutoDiffInterface(DialectRegistry &registry);
 void registerBuiltinDialectAutoDiffInterface(DialectRegistry &registry);
+void registerLinalgDialectAutoDiffInterface(DialectRegistry &registry);
 void registerLLVMDialectAutoDiffInterface(DialectRegistry &registry);
+void registerMathDialectAutoDiffInterface(DialectRegistry &registry);
 void registerMemRefDialectAutoDiffInterface(DialectRegistry &registry);
 void registerSCFDialectAutoDiffInterface(DialectRegistry &registry);
+void registerTensorDialectAutoDiffInterface(DialectRegistry &registry);
+void registerVectorDialectAutoDiffInterface(DialectRegistry &registry);
 } // namespace enzyme
 } // namespace mlir
@@ -0,0 +1,602 @@
+//===- LinalgAutoDiffOpInterfaceImpl.cpp - Interface external model -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the external model implementation of the automatic
+// differentiation op interfaces for the upstream MLIR linalg dialect.
+//
+// Structured ops are differentiated into structured ops: the tangent or adjoint
+// of a linalg op is another `linalg.generic` over the same iteration space,
+// whose body is the derivative of the original scalar body. For instance, the
+// adjoints of `linalg.matmul` are matmuls with transposed indexing maps.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Implementations/CoreDialectsAutoDiffImplementations.h"
+#include "Interfaces/AutoDiffOpInterface.h"
+#include "Interfaces/AutoDiffTypeInterface.h"
+#include "Interfaces/GradientUtils.h"
+#include "Interfaces/GradientUtilsReverse.h"
+
+#include "Dialect/Ops.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/RegionUtils.h"
+
+using namespace mlir;
+using namespace mlir::enzyme;
+
+namespace {
+
+/// Adds `added` to the scalar adjoint of `v`, if `v` is differentiable.
+void addScalarAdjoint(OpBuilder &builder, Location loc,
+                      DenseMap<Value, Value> &adjoints, Value v, Value added) {
+  if (!v.getType().isa<FloatType>())
+    return;
+  auto found = adjoints.find(v);
+  if (found == adjoints.end()) {
+    adjoints[v] = added;
+    return;
+  }
+  found->second = builder.create<arith::AddFOp>(loc, found->second, added);
+}
+
+/// Propagates scalar adjoints backwards through the body of a linalg op.
+/// `mapping` maps the original body values to their clones at the insertion
+/// point of `builder`, `adjoints` is keyed by original body values and must be
+/// seeded with the adjoint of the yielded value.
+LogicalResult backpropagateBody(OpBuilder &builder, Block *body,
+                                BlockAndValueMapping &mapping,
+                                DenseMap<Value, Value> &adjoints) {
+  for (Operation &op : llvm::reverse(body->without_terminator())) {
+    if (op.getNumResults() != 1)
+      continue;
+    Value adjoint = adjoints.lookup(op.getResult(0));
+    if (!adjoint)
+      continue;
+    Location loc = op.getLoc();
+
+    if (auto addOp = dyn_cast<arith::AddFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, addOp.getLhs(), adjoint);
+      addScalarAdjoint(builder, loc, adjoints, addOp.getRhs(), adjoint);
+    } else if (auto subOp = dyn_cast<arith::SubFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, subOp.getLhs(), adjoint);
+      addScalarAdjoint(builder, loc, adjoints, subOp.getRhs(),
+                       builder.create<arith::NegFOp>(loc, adjoint));
+    } else if (auto mulOp = dyn_cast<arith::MulFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, mulOp.getLhs(),
+                       builder.create<arith::MulFOp>(
+                           loc, adjoint, mapping.lookup(mulOp.getRhs())));
+      addScalarAdjoint(builder, loc, adjoints, mulOp.getRhs(),
+                       builder.create<arith::MulFOp>(
+                           loc, adjoint, mapping.lookup(mulOp.getLhs())));
+    } else if (auto divOp = dyn_cast<arith::DivFOp>(op)) {
+      // d(a / b) = da / b - db * (a / b) / b
+      Value rhs = mapping.lookup(divOp.getRhs());
+      addScalarAdjoint(builder, loc, adjoints, divOp.getLhs(),
+                       builder.create<arith::DivFOp>(loc, adjoint, rhs));
+      Value scaled = builder.create<arith::MulFOp>(
+          loc, adjoint, mapping.lookup(divOp.getResult()));
+      addScalarAdjoint(builder, loc, adjoints, divOp.getRhs(),
+                       builder.create<arith::NegFOp>(
+                           loc, builder.create<arith::DivFOp>(loc, scaled,
+                                                              rhs)));
+    } else if (auto negOp = dyn_cast<arith::NegFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, negOp.getOperand(),
+                       builder.create<arith::NegFOp>(loc, adjoint));
+    } else if (auto extOp = dyn_cast<arith::ExtFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, extOp.getIn(),
+                       builder.create<arith::TruncFOp>(
+                           loc, extOp.getIn().getType(), adjoint));
+    } else if (auto truncOp = dyn_cast<arith::TruncFOp>(op)) {
+      addScalarAdjoint(builder, loc, adjoints, truncOp.getIn(),
+                       builder.create<arith::ExtFOp>(
+                           loc, truncOp.getIn().getType(), adjoint));
+    } else {
+      return op.emitError() << "cannot differentiate through linalg body op";
+    }
+  }
+  return success();
+}
+
+/// Propagates scalar tangents forward through the body of a linalg op.
+/// `mapping` maps the original body values to their clones at the insertion
+/// point of `builder`, `tangents` is keyed by original body values and must be
+/// seeded with the tangents of the block arguments. Values without a tangent
+/// are inactive.
+LogicalResult propagateBody(OpBuilder &builder, Block *body,
+                            BlockAndValueMapping &mapping,
+                            DenseMap<Value, Value> &tangents) {
+  for (Operation &op : body->without_terminator()) {
+    if (op.getNumResults() != 1 ||
+        llvm::none_of(op.getOperands(),
+                      [&](Value v) { return tangents.count(v); }))
+      continue;
+    Location loc = op.getLoc();
+    auto tangentOf = [&](Value v) -> Value {
+      if (Value t = tangents.lookup(v))
+        return t;
+      return v.getType().cast<AutoDiffTypeInterface>().createNullValue(builder,
+                                                                       loc);
+    };
+
+    Value tangent;
+    if (auto addOp = dyn_cast<arith::AddFOp>(op)) {
+      tangent = builder.create<arith::AddFOp>(loc, tangentOf(addOp.getLhs()),
+                                              tangentOf(addOp.getRhs()));
+    } else if (auto subOp = dyn_cast<arith::SubFOp>(op)) {
+      tangent = builder.create<arith::SubFOp>(loc, tangentOf(subOp.getLhs()),
+                                              tangentOf(subOp.getRhs()));
+    } else if (auto mulOp = dyn_cast<arith::MulFOp>(op)) {
+      // d(a * b) = da * b + a * db
+      tangent = builder.create<arith::AddFOp>(
+          loc,
+          builder.create<arith::MulFOp>(loc, tangentOf(mulOp.getLhs()),
+                                        mapping.lookup(mulOp.getRhs())),
+          builder.create<arith::MulFOp>(loc, mapping.lookup(mulOp.getLhs()),
+                                        tangentOf(mulOp.getRhs())));
+    } else if (auto divOp = dyn_cast<arith::DivFOp>(op)) {
+      // d(a / b) = (da - db * (a / b)) / b
+      Value scaled =
+          builder.create<arith::MulFOp>(loc, tangentOf(divOp.getRhs()),
+                                        mapping.lookup(divOp.getResult()));
+      tangent = builder.create<arith::DivFOp>(
+          loc,
+          builder.create<arith::SubFOp>(loc, tangentOf(divOp.getLhs()), scaled),
+          mapping.lookup(divOp.getRhs()));
+    } else if (auto negOp = dyn_cast<arith::NegFOp>(op)) {
+      tangent =
+          builder.create<arith::NegFOp>(loc, tangentOf(negOp.getOperand()));
+    } else if (auto extOp = dyn_cast<arith::ExtFOp>(op)) {
+      tangent = builder.create<arith::ExtFOp>(loc, extOp.getType(),
+                                              tangentOf(extOp.getIn()));
+    } else if (auto truncOp = dyn_cast<arith::TruncFOp>(op)) {
+      tangent = builder.create<arith::TruncFOp>(loc, truncOp.getType(),
+                                                tangentOf(truncOp.getIn()));
+    } else if (!op.getResult(0).getType().isa<FloatType>()) {
+      continue;
+    } else {
+      return op.emitError() << "cannot differentiate through linalg body op";
+    }
+    tangents[op.getResult(0)] = tangent;
+  }
+  return success();
+}
+
+/// Clones the body of `linalgOp` (without its terminator) at the insertion
+/// point of `builder` and returns the clone of the yielded value. Values the
+/// body captures from above are remapped into the derivative function.
+template <typename GradientUtils>
+Value cloneBody(OpBuilder &builder, linalg::LinalgOp linalgOp,
+                BlockAndValueMapping &mapping, GradientUtils *gutils) {
+  visitUsedValuesDefinedAbove(linalgOp->getRegion(0), [&](OpOperand *operand) {
+    mapping.map(operand->get(), gutils->getNewFromOriginal(operand->get()));
+  });
+  Block *body = linalgOp.getBlock();
+  for (Operation &op : body->without_terminator())
+    builder.clone(op, mapping);
+  return mapping.lookup(body->getTerminator()->getOperand(0));
+}
+
+/// Returns an identity-layout copy of the memref `v`.
+Value copyMemRef(OpBuilder &builder, Location loc, Value v) {
+  auto type = v.getType().cast<MemRefType>();
+  SmallVector<Value> dynamicSizes;
+  for (int64_t i = 0, e = type.getRank(); i < e; ++i)
+    if (type.isDynamicDim(i))
+      dynamicSizes.push_back(builder.create<memref::DimOp>(loc, v, i));
+  Value copy = builder.create<memref::AllocOp>(
+      loc, MemRefType::get(type.getShape(), type.getElementType()),
+      dynamicSizes);
+  builder.create<memref::CopyOp>(loc, v, copy);
+  return copy;
+}
+
+/// Materializes the index expression `expr` of an indexing map over the loop
+/// induction variables `ivs`.
+Value expandIndexExpr(OpBuilder &builder, Location loc, AffineExpr expr,
+                      ValueRange ivs) {
+  if (auto dim = expr.dyn_cast<AffineDimExpr>())
+    return ivs[dim.getPosition()];
+  if (auto cst = expr.dyn_cast<AffineConstantExpr>())
+    return builder.create<arith::ConstantIndexOp>(loc, cst.getValue());
+  auto binary = expr.cast<AffineBinaryOpExpr>();
+  Value lhs = expandIndexExpr(builder, loc, binary.getLHS(), ivs);
+  Value rhs = expandIndexExpr(builder, loc, binary.getRHS(), ivs);
+  switch (expr.getKind()) {
+  case AffineExprKind::Add:
+    return builder.create<arith::AddIOp>(loc, lhs, rhs);
+  case AffineExprKind::Mul:
+    return builder.create<arith::MulIOp>(loc, lhs, rhs);
+  case AffineExprKind::Mod:
+    return builder.create<arith::RemSIOp>(loc, lhs, rhs);
+  case AffineExprKind::FloorDiv:
+    return builder.create<arith::FloorDivSIOp>(loc, lhs, rhs);
+  case AffineExprKind::CeilDiv:
+    return builder.create<arith::CeilDivSIOp>(loc, lhs, rhs);
+  default:
+    llvm_unreachable("linalg indexing maps have no symbols");
+  }
+}
+
+SmallVector<Value> expandIndexMap(OpBuilder &builder, Location loc,
+                                  AffineMap map, ValueRange ivs) {
+  SmallVector<Value> indices;
+  for (AffineExpr expr : map.getResults())
+    indices.push_back(expandIndexExpr(builder, loc, expr, ivs));
+  return indices;
+}
+
+/// Returns the trip counts of the loops of `linalgOp`, computed from the
+/// shapes of `operands`, which stand for the operands of `linalgOp` in order.
+SmallVector<Value> getLoopSizes(OpBuilder &builder, Location loc,
+                                linalg::LinalgOp linalgOp,
+                                ValueRange operands) {
+  SmallVector<Value> dims;
+  for (Value operand : operands) {
+    auto type = operand.getType().dyn_cast<ShapedType>();
+    if (!type)
+      continue;
+    for (int64_t i = 0, e = type.getRank(); i < e; ++i)
+      dims.push_back(type.isDynamicDim(i)
+                         ? builder.create<memref::DimOp>(loc, operand, i)
+                               .getResult()
+                         : builder
+                               .create<arith::ConstantIndexOp>(
+                                   loc, type.getDimSize(i))
+                               .getResult());
+  }
+  return expandIndexMap(builder, loc, linalgOp.getShapesToLoopsMap(), dims);
+}
+
+/// Returns true if the body of `linalgOp` either ignores the current value of
+/// its output, or adds the rest of the computation to it. In both cases the
+/// adjoints of the inputs do not depend on the previous output value.
+bool isOverwriteOrAccumulate(linalg::LinalgOp linalgOp, bool &accumulates) {
+  Block *body = linalgOp.getBlock();
+  BlockArgument outArg = body->getArguments().back();
+  accumulates = !outArg.use_empty();
+  if (!accumulates)
+    return true;
+  if (!outArg.hasOneUse())
+    return false;
+  auto addOp =
+      body->getTerminator()->getOperand(0).getDefiningOp<arith::AddFOp>();
+  return addOp && (addOp.getLhs() == outArg || addOp.getRhs() == outArg);
+}
+
+/// Emits the adjoint of the scalar body of `linalgOp` with respect to the
+/// block argument of `input`, given the scalar values of the inputs and the
+/// adjoint of the yielded value. Returns a null value if the input does not
+/// contribute.
+template <typename GradientUtils>
+Value createBodyAdjoint(OpBuilder &builder, Location loc,
+                        linalg::LinalgOp linalgOp, ValueRange inputs,
+                        Value outAdjoint, OpOperand *input,
+                        GradientUtils *gutils) {
+  Block *body = linalgOp.getBlock();
+  BlockAndValueMapping mapping;
+  for (auto en : llvm::enumerate(inputs))
+    mapping.map(body->getArgument(en.index()), en.value());
+  // The input adjoints do not depend on the previous output value.
+  BlockArgument outArg = body->getArguments().back();
+  mapping.map(outArg, outArg.getType()
+                          .cast<AutoDiffTypeInterface>()
+                          .createNullValue(builder, loc));
+  cloneBody(builder, linalgOp, mapping, gutils);
+
+  DenseMap<Value, Value> adjoints;
+  adjoints[body->getTerminator()->getOperand(0)] = outAdjoint;
+  if (failed(backpropagateBody(builder, body, mapping, adjoints)))
+    return Value();
+  return adjoints.lookup(linalgOp.getMatchingBlockArgument(input));
+}
+
+template <typename OpTy>
+struct LinalgOpInterface
+    : public AutoDiffOpInterface::ExternalModel<LinalgOpInterface<OpTy>, OpTy> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto linalgOp = cast<linalg::LinalgOp>(op);
+    auto newOp = cast<linalg::LinalgOp>(gutils->getNewFromOriginal(op));
+
+    // The generic forward-mode preparation added shadow arguments and
+    // placeholders inside the cloned body; the tangent is computed by a
+    // separate structured op, so drop them again.
+    Block *body = linalgOp.getBlock();
+    Block *newBody = newOp.getBlock();
+    for (Operation &bodyOp : body->without_terminator()) {
+      for (Value res : bodyOp.getResults()) {
+        if (!gutils->invertedPointers.contains(res))
+          continue;
+        Value placeholder = gutils->invertedPointers.lookupOrNull(res);
+        gutils->erase(placeholder.getDefiningOp());
+        gutils->invertedPointers.erase(res);
+      }
+    }
+    for (BlockArgument arg : llvm::reverse(body->getArguments())) {
+      if (!gutils->invertedPointers.contains(arg))
+        continue;
+      auto shadowArg =
+          gutils->invertedPointers.lookupOrNull(arg).cast<BlockArgument>();
+      newBody->eraseArgument(shadowArg.getArgNumber());
+      gutils->invertedPointers.erase(arg);
+    }
+
+    if (!linalgOp.hasBufferSemantics() || linalgOp.getNumDpsInits() != 1)
+      return op->emitError()
+             << "forward mode only supports linalg ops with a single buffer "
+                "output";
+
+    OpOperand *init = linalgOp.getDpsInitOperands()[0];
+    if (!gutils->invertedPointers.contains(init->get()))
+      return success();
+
+    // The tangent op reads the primal inputs, the previous primal output and
+    // the tangents of all active inputs, and updates the output tangent in
+    // place. It is emitted before the primal op so that the previous output
+    // value is still available.
+    SmallVector<Value> inputs;
+    SmallVector<AffineMap> indexingMaps;
+    for (OpOperand *input : linalgOp.getDpsInputOperands()) {
+      inputs.push_back(gutils->getNewFromOriginal(input->get()));
+      indexingMaps.push_back(linalgOp.getMatchingIndexingMap(input));
+    }
+    inputs.push_back(gutils->getNewFromOriginal(init->get()));
+    indexingMaps.push_back(linalgOp.getMatchingIndexingMap(init));
+
+    SmallVector<OpOperand *> activeInputs;
+    for (OpOperand *input : linalgOp.getDpsInputOperands()) {
+      if (gutils->isConstantValue(input->get()) ||
+          !gutils->invertedPointers.contains(input->get()))
+        continue;
+      activeInputs.push_back(input);
+      inputs.push_back(gutils->invertPointerM(input->get(), builder));
+      indexingMaps.push_back(linalgOp.getMatchingIndexingMap(input));
+    }
+    indexingMaps.push_back(linalgOp.getMatchingIndexingMap(init));
+
+    Value shadowInit = gutils->invertPointerM(init->get(), builder);
+    LogicalResult result = success();
+    builder.create<linalg::GenericOp>(
+        op->getLoc(), inputs, ValueRange(shadowInit), indexingMaps,
+        linalgOp.getIteratorTypesArray(),
+        [&](OpBuilder &nestedBuilder, Location loc, ValueRange args) {
+          unsigned numInputs = linalgOp.getNumDpsInputs();
+          BlockAndValueMapping mapping;
+          for (unsigned i = 0; i <= numInputs; ++i)
+            mapping.map(body->getArgument(i), args[i]);
+
+          DenseMap<Value, Value> tangents;
+          for (auto en : llvm::enumerate(activeInputs))
+            tangents[linalgOp.getMatchingBlockArgument(en.value())] =
+                args[numInputs + 1 + en.index()];
+          tangents[linalgOp.getMatchingBlockArgument(init)] = args.back();
+
+          cloneBody(nestedBuilder, linalgOp, mapping, gutils);
+          result = propagateBody(nestedBuilder, body, mapping, tangents);
+
+          Value yielded = body->getTerminator()->getOperand(0);
+          Value tangent = tangents.lookup(yielded);
+          if (!tangent)
+            tangent = yielded.getType().cast<AutoDiffTypeInterface>()
+                          .createNullValue(nestedBuilder, loc);
+          nestedBuilder.create<linalg::YieldOp>(loc, tangent);
+        });
+    return result;
+  }
+};
+
+template <typename OpTy>
+struct LinalgOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<
+          LinalgOpInterfaceReverse<OpTy>, OpTy> {
+  static bool requiresAdjoint(Value v, MGradientUtilsReverse *gutils) {
+    if (v.getType().isa<MemRefType>())
+      return gutils->hasInvertPointer(v);
+    return v.getType().isa<FloatType>() && !gutils->isConstantValue(v);
+  }
+
+  static bool requiresAdjoints(linalg::LinalgOp linalgOp,
+                               MGradientUtilsReverse *gutils) {
+    if (!linalgOp.hasBufferSemantics() || linalgOp.getNumDpsInits() != 1)
+      return false;
+    if (!gutils->hasInvertPointer(linalgOp.getDpsInitOperands()[0]->get()))
+      return false;
+    return llvm::any_of(linalgOp.getDpsInputOperands(), [&](OpOperand *input) {
+      return requiresAdjoint(input->get(), gutils);
+    });
+  }
+
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    auto linalgOp = cast<linalg::LinalgOp>(op);
+    if (!linalgOp.hasBufferSemantics() || linalgOp.getNumDpsInits() != 1) {
+      op->emitError() << "reverse mode only supports linalg ops with a single "
+                         "buffer output";
+      return;
+    }
+
+    OpOperand *init = linalgOp.getDpsInitOperands()[0];
+    if (!gutils->hasInvertPointer(init->get()))
+      return;
+
+    bool accumulates;
+    if (!isOverwriteOrAccumulate(linalgOp, accumulates)) {
+      op->emitError() << "cannot differentiate linalg op whose body is "
+                         "nonlinear in its output";
+      return;
+    }
+
+    Location loc = op->getLoc();
+    unsigned numInputs = linalgOp.getNumDpsInputs();
+    unsigned numLoops = linalgOp.getNumLoops();
+
+    // Inputs as they were when the primal op executed.
+    SmallVector<Value> primalInputs;
+    for (Value cache : caches)
+      primalInputs.push_back(gutils->popCache(cache, builder));
+    Value shadowInit = gutils->invertPointerM(init->get(), builder);
+
+    SmallVector<AffineMap> baseMaps;
+    for (OpOperand *input : linalgOp.getDpsInputOperands())
+      baseMaps.push_back(linalgOp.getMatchingIndexingMap(input));
+    baseMaps.push_back(linalgOp.getMatchingIndexingMap(init));
+    SmallVector<Value> inputs(primalInputs);
+    inputs.push_back(shadowInit);
+
+    for (OpOperand *input : linalgOp.getDpsInputOperands()) {
+      Value primal = input->get();
+      if (!requiresAdjoint(primal, gutils))
+        continue;
+
+      AffineMap map = linalgOp.getMatchingIndexingMap(input);
+      if (!map.isProjectedPermutation()) {
+        // An input read at a combination of loop indices, e.g. the input of a
+        // convolution, has its adjoint scattered rather than reduced into. No
+        // structured op can express that, so it is accumulated in sequential
+        // loops.
+        Value target = gutils->invertPointerM(primal, builder);
+        SmallVector<Value> operands(primalInputs);
+        operands.push_back(shadowInit);
+        SmallVector<Value> sizes =
+            getLoopSizes(builder, loc, linalgOp, operands);
+        Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+        Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+        scf::buildLoopNest(
+            builder, loc, SmallVector<Value>(numLoops, zero), sizes,
+            SmallVector<Value>(numLoops, one),
+            [&](OpBuilder &nestedBuilder, Location loc, ValueRange ivs) {
+              SmallVector<Value> scalars;
+              for (unsigned i = 0; i < numInputs; ++i) {
+                Value v = primalInputs[i];
+                if (v.getType().isa<MemRefType>())
+                  v = nestedBuilder.create<memref::LoadOp>(
+                      loc, v,
+                      expandIndexMap(nestedBuilder, loc, baseMaps[i], ivs));
+                scalars.push_back(v);
+              }
+              Value outAdjoint = nestedBuilder.create<memref::LoadOp>(
+                  loc, shadowInit,
+                  expandIndexMap(nestedBuilder, loc, baseMaps.back(), ivs));
+              Value adjoint =
+                  createBodyAdjoint(nestedBuilder, loc, linalgOp, scalars,
+                                    outAdjoint, input, gutils);
+              if (!adjoint)
+                return;
+              SmallVector<Value> indices =
+                  expandIndexMap(nestedBuilder, loc, map, ivs);
+              Value acc =
+                  nestedBuilder.create<memref::LoadOp>(loc, target, indices);
+              acc = nestedBuilder.create<arith::AddFOp>(loc, acc, adjoint);
+              nestedBuilder.create<memref::StoreOp>(loc, acc, target, indices);
+            });
+        continue;
+      }
+
+      // Scalar inputs are reduced into a 0-d buffer.
+      bool isScalar = !primal.getType().isa<MemRefType>();
+      Value target;
+      if (isScalar) {
+        target = builder.create<memref::AllocOp>(
+            loc, MemRefType::get({}, primal.getType()));
+        Value zero = primal.getType().cast<AutoDiffTypeInterface>()
+                         .createNullValue(builder, loc);
+        builder.create<linalg::FillOp>(loc, zero, target);
+      } else {
+        target = gutils->invertPointerM(primal, builder);
+      }
+
+      // Loops that do not index the input are reductions of its adjoint.
+      SmallVector<utils::IteratorType> iteratorTypes;
+      for (unsigned d = 0; d < numLoops; ++d)
+        iteratorTypes.push_back(map.isFunctionOfDim(d)
+                                    ? utils::IteratorType::parallel
+                                    : utils::IteratorType::reduction);
+      SmallVector<AffineMap> indexingMaps(baseMaps);
+      indexingMaps.push_back(map);
+
+      builder.create<linalg::GenericOp>(
+          loc, inputs, ValueRange(target), indexingMaps, iteratorTypes,
+          [&](OpBuilder &nestedBuilder, Location loc, ValueRange args) {
+            Value acc = args.back();
+            if (Value adjoint = createBodyAdjoint(
+                    nestedBuilder, loc, linalgOp, args.take_front(numInputs),
+                    args[numInputs], input, gutils))
+              acc = nestedBuilder.create<arith::AddFOp>(loc, acc, adjoint);
+            nestedBuilder.create<linalg::YieldOp>(loc, acc);
+          });
+
+      if (isScalar) {
+        Value adjoint = builder.create<memref::LoadOp>(loc, target);
+        if (gutils->hasInvertPointer(primal))
+          adjoint = primal.getType().cast<AutoDiffTypeInterface>().createAddOp(
+              builder, loc, gutils->invertPointerM(primal, builder), adjoint);
+        gutils->mapInvertPointer(primal, adjoint, builder);
+        builder.create<memref::DeallocOp>(loc, target);
+      }
+    }
+
+    // An overwritten output does not contribute to the adjoint of its
+    // previous value, an accumulated one passes it through unchanged.
+    if (!accumulates) {
+      Type elementType = getElementTypeOrSelf(init->get().getType());
+      Value zero = elementType.cast<AutoDiffTypeInterface>().createNullValue(
+          builder, loc);
+      builder.create<linalg::FillOp>(loc, zero, shadowInit);
+    }
+
+    for (Value primal : primalInputs)
+      if (primal.getType().isa<MemRefType>())
+        builder.create<memref::DeallocOp>(loc, primal);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto linalgOp = cast<linalg::LinalgOp>(op);
+    if (!requiresAdjoints(linalgOp, gutils))
+      return SmallVector<Value>();
+
+    // Inputs may be overwritten after this op, so their buffers are copied.
+    Operation *newOp = gutils->getNewFromOriginal(op);
+    OpBuilder cacheBuilder(newOp);
+    SmallVector<Value> caches;
+    for (OpOperand *input : linalgOp.getDpsInputOperands()) {
+      Value value = gutils->getNewFromOriginal(input->get());
+      if (value.getType().isa<MemRefType>())
+        value = copyMemRef(cacheBuilder, op->getLoc(), value);
+      caches.push_back(gutils->initAndPushCache(value, cacheBuilder));
+    }
+    return caches;
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+template <typename... Ts> void attachLinalgInterfaces(MLIRContext *context) {
+  (Ts::template attachInterface<LinalgOpInterface<Ts>>(*context), ...);
+  (Ts::template attachInterface<LinalgOpInterfaceReverse<Ts>>(*context), ...);
+}
+} // namespace
+
+void mlir::enzyme::registerLinalgDialectAutoDiffInterface(
+    DialectRegistry &registry) {
+  registry.addExtension(+[](MLIRContext *context, linalg::LinalgDialect *) {
+    attachLinalgInterfaces<
+        linalg::GenericOp, linalg::ReduceOp, linalg::DotOp, linalg::MatvecOp,
+        linalg::VecmatOp, linalg::MatmulOp, linalg::BatchMatmulOp,
+        linalg::Conv1DOp, linalg::Conv2DOp, linalg::Conv3DOp,
+        linalg::Conv2DNhwcHwcfOp, linalg::Conv2DNchwFchwOp>(context);
+  });
+}
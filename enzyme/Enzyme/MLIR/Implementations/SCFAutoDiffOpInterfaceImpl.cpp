@@ -11,14 +11,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "Dialect/Ops.h"
 #include "Implementations/CoreDialectsAutoDiffImplementations.h"
 #include "Interfaces/AutoDiffOpInterface.h"
 #include "Interfaces/AutoDiffTypeInterface.h"
 #include "Interfaces/GradientUtils.h"
 #include "Interfaces/GradientUtilsReverse.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/DialectRegistry.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/RegionUtils.h"
 
 using namespace mlir;
 using namespace mlir::enzyme;
@@ -168,6 +173,475 @@ struct ForOpInterfaceReverse
   }
 };
 
+/// Original-to-new mappings overridden by `remapToClone`, so that they can be
+/// restored once the cloned region has been differentiated.
+struct SavedMapping {
+  SmallVector<std::pair<Value, Value>> values;
+  SmallVector<std::pair<Block *, Block *>> blocks;
+  SmallVector<std::pair<Operation *, Operation *>> ops;
+};
+
+void remapValue(Value orig, Value clone, MGradientUtilsReverse *gutils,
+                SavedMapping &saved) {
+  saved.values.emplace_back(orig, gutils->originalToNewFn.lookupOrNull(orig));
+  gutils->originalToNewFn.map(orig, clone);
+}
+
+/// Redirects the original-to-new mapping of `op`, and of everything nested in
+/// it, to the structurally identical `clone`.
+void remapToClone(Operation *op, Operation *clone,
+                  MGradientUtilsReverse *gutils, SavedMapping &saved) {
+  SmallVector<Operation *> origOps, cloneOps;
+  op->walk([&](Operation *o) { origOps.push_back(o); });
+  clone->walk([&](Operation *o) { cloneOps.push_back(o); });
+  assert(origOps.size() == cloneOps.size() && "clone does not match");
+
+  for (auto [orig, cloned] : llvm::zip(origOps, cloneOps)) {
+    auto found = gutils->originalToNewFnOps.find(orig);
+    saved.ops.emplace_back(orig, found == gutils->originalToNewFnOps.end()
+                                     ? nullptr
+                                     : found->second);
+    gutils->originalToNewFnOps[orig] = cloned;
+    for (auto [res, cres] : llvm::zip(orig->getResults(), cloned->getResults()))
+      remapValue(res, cres, gutils, saved);
+    for (auto [region, cregion] :
+         llvm::zip(orig->getRegions(), cloned->getRegions())) {
+      for (auto [block, cblock] : llvm::zip(region, cregion)) {
+        saved.blocks.emplace_back(&block,
+                                  gutils->originalToNewFn.lookupOrNull(&block));
+        gutils->originalToNewFn.map(&block, &cblock);
+        for (auto [arg, carg] :
+             llvm::zip(block.getArguments(), cblock.getArguments()))
+          remapValue(arg, carg, gutils, saved);
+      }
+    }
+  }
+}
+
+void restoreMapping(SavedMapping &saved, MGradientUtilsReverse *gutils) {
+  for (auto &[orig, prev] : llvm::reverse(saved.values)) {
+    if (prev)
+      gutils->originalToNewFn.map(orig, prev);
+    else
+      gutils->originalToNewFn.erase(orig);
+  }
+  for (auto &[orig, prev] : llvm::reverse(saved.blocks)) {
+    if (prev)
+      gutils->originalToNewFn.map(orig, prev);
+    else
+      gutils->originalToNewFn.erase(orig);
+  }
+  for (auto &[orig, prev] : llvm::reverse(saved.ops)) {
+    if (prev)
+      gutils->originalToNewFnOps[orig] = prev;
+    else
+      gutils->originalToNewFnOps.erase(orig);
+  }
+}
+
+/// `differentiate` hands the function argument gradients to the region
+/// terminator builder; loop bodies do not return them, so drop the reads.
+void eraseUnusedGets(ArrayRef<Value> values) {
+  for (Value v : values)
+    if (auto getOp = v.getDefiningOp<enzyme::GetOp>())
+      if (getOp->use_empty())
+        getOp->erase();
+}
+
+/// Returns whether the primal value of `op`, a top-level op of an
+/// scf.parallel body, is stored per iteration in the forward pass: ops with
+/// memory effects cannot be replayed in the adjoint iteration.
+bool isBufferedInParallel(Operation &op) {
+  return !isMemoryEffectFree(&op) && op.getNumResults() != 0;
+}
+
+/// Returns whether the reverse of `parallelOp` can replay its body: ops with
+/// memory effects must not have regions, and may have a single result that
+/// can be stored in a memref.
+bool isReplayableParallel(scf::ParallelOp parallelOp) {
+  for (Operation &o : parallelOp.getBody()->without_terminator()) {
+    if (isMemoryEffectFree(&o))
+      continue;
+    if (o.getNumRegions() != 0 || o.getNumResults() > 1)
+      return false;
+    if (o.getNumResults() == 1 &&
+        !MemRefType::isValidElementType(o.getResult(0).getType()))
+      return false;
+  }
+  return true;
+}
+
+/// Returns the number of iterations of each loop of an scf.parallel.
+SmallVector<Value> getTripCounts(OpBuilder &builder, Location loc,
+                                 ValueRange lbs, ValueRange ubs,
+                                 ValueRange steps) {
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  SmallVector<Value> counts;
+  for (auto [lb, ub, step] : llvm::zip(lbs, ubs, steps)) {
+    Value extent = builder.create<arith::SubIOp>(loc, ub, lb);
+    Value count = builder.create<arith::CeilDivSIOp>(loc, extent, step);
+    counts.push_back(builder.create<arith::MaxSIOp>(loc, count, zero));
+  }
+  return counts;
+}
+
+/// Returns the position of the iteration `ivs` in each loop of an
+/// scf.parallel, counted from zero.
+SmallVector<Value> getIterationIndices(OpBuilder &builder, Location loc,
+                                       ValueRange ivs, ValueRange lbs,
+                                       ValueRange steps) {
+  SmallVector<Value> indices;
+  for (auto [iv, lb, step] : llvm::zip(ivs, lbs, steps)) {
+    Value offset = builder.create<arith::SubIOp>(loc, iv, lb);
+    indices.push_back(builder.create<arith::DivUIOp>(loc, offset, step));
+  }
+  return indices;
+}
+
+struct ParallelOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<
+          ParallelOpInterfaceReverse, scf::ParallelOp> {
+  // The adjoint is itself an scf.parallel over the same iteration space. Each
+  // iteration replays the ops of its primal body that have no memory effects,
+  // so that the values it caches live in that iteration only, and then runs
+  // the adjoint of the body. Results of ops with memory effects, such as
+  // loads, are stored per iteration by the forward pass and read back, and
+  // ops without results, such as stores, are not replayed. Gradients of
+  // scalars captured from above are accumulated in per-iteration cells and
+  // combined with scf.reduce instead of racing on a shared cell. Gradients
+  // stored through shadow memrefs are updated in place, which relies on the
+  // iterations touching disjoint elements as the primal loop does.
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    auto parallelOp = cast<scf::ParallelOp>(op);
+    Location loc = parallelOp.getLoc();
+    if (parallelOp.getNumResults() != 0) {
+      op->emitError() << "reverse mode of scf.parallel with reductions is "
+                         "not supported";
+      return;
+    }
+    if (!isReplayableParallel(parallelOp)) {
+      op->emitError() << "reverse mode of scf.parallel is only supported when "
+                         "the ops with memory effects in its body have no "
+                         "regions and at most one result";
+      return;
+    }
+
+    unsigned numLoops = parallelOp.getNumLoops();
+    SmallVector<Value> bounds;
+    for (Value cache : ArrayRef<Value>(caches).take_front(3 * numLoops))
+      bounds.push_back(gutils->popCache(cache, builder));
+    ArrayRef<Value> boundsRef(bounds);
+    SmallVector<Value> buffers;
+    for (Value cache : ArrayRef<Value>(caches).drop_front(3 * numLoops))
+      buffers.push_back(gutils->popCache(cache, builder));
+
+    SetVector<Value> captured;
+    getUsedValuesDefinedAbove(parallelOp.getRegion(), captured);
+    SmallVector<Value> shared;
+    SmallVector<Value> inits;
+    for (Value v : captured) {
+      auto iface = v.getType().dyn_cast<AutoDiffTypeInterface>();
+      if (!iface || gutils->isConstantValue(v) ||
+          gutils->requiresShadow(v.getType()))
+        continue;
+      shared.push_back(v);
+      inits.push_back(iface.createNullValue(builder, v.getLoc()));
+    }
+
+    auto repParallel = builder.create<scf::ParallelOp>(
+        loc, boundsRef.take_front(numLoops),
+        boundsRef.slice(numLoops, numLoops), boundsRef.take_back(numLoops),
+        inits);
+    Block *body = repParallel.getBody();
+    if (!body->empty())
+      body->getTerminator()->erase();
+
+    // Replay the primal iteration and make it the new counterpart of the
+    // original body while the adjoint is generated.
+    SavedMapping saved;
+    BlockAndValueMapping mapping;
+    for (auto [iv, newIv] : llvm::zip(parallelOp.getInductionVars(),
+                                      repParallel.getInductionVars())) {
+      mapping.map(iv, newIv);
+      remapValue(iv, newIv, gutils, saved);
+    }
+    for (Value v : captured)
+      mapping.map(v, gutils->getNewFromOriginal(v));
+    OpBuilder recomputeBuilder(body, body->end());
+    SmallVector<Value> indices;
+    if (!buffers.empty())
+      indices = getIterationIndices(
+          recomputeBuilder, loc, repParallel.getInductionVars(),
+          boundsRef.take_front(numLoops), boundsRef.take_back(numLoops));
+    auto buffer = buffers.begin();
+    // Clones of ops with memory effects and no results, which only serve as
+    // the insertion point of the caches of their adjoint.
+    SmallVector<Operation *> placeholders;
+    for (Operation &o : parallelOp.getBody()->without_terminator()) {
+      Operation *clone;
+      if (isBufferedInParallel(o)) {
+        clone = recomputeBuilder.create<memref::LoadOp>(o.getLoc(), *buffer++,
+                                                        indices);
+        mapping.map(o.getResult(0), clone->getResult(0));
+      } else {
+        clone = recomputeBuilder.clone(o, mapping);
+        if (!isMemoryEffectFree(&o))
+          placeholders.push_back(clone);
+      }
+      remapToClone(&o, clone, gutils, saved);
+    }
+
+    Block *outerInitializationBlock = gutils->initializationBlock;
+    gutils->initializationBlock = body;
+
+    SmallVector<Value> outerGradients;
+    for (Value v : shared) {
+      outerGradients.push_back(gutils->invertedPointersGlobal.lookupOrNull(v));
+      Value cell = gutils->insertInitGradient(v, recomputeBuilder);
+      OpBuilder zeroBuilder(body,
+                            std::next(cell.getDefiningOp()->getIterator()));
+      Value zero = v.getType().cast<AutoDiffTypeInterface>().createNullValue(
+          zeroBuilder, v.getLoc());
+      zeroBuilder.create<enzyme::SetOp>(v.getLoc(), cell, zero);
+      gutils->invertedPointersGlobal.map(v, cell);
+    }
+
+    buildReturnFunction buildReduceAndYield =
+        [gutils, &shared](OpBuilder &builder, Location loc,
+                          SmallVector<Value> retargs) {
+          for (Value v : shared) {
+            auto iface = v.getType().cast<AutoDiffTypeInterface>();
+            builder.create<scf::ReduceOp>(
+                loc, gutils->invertPointerM(v, builder),
+                [&](OpBuilder &reduceBuilder, Location reduceLoc, Value lhs,
+                    Value rhs) {
+                  reduceBuilder.create<scf::ReduceReturnOp>(
+                      reduceLoc,
+                      iface.createAddOp(reduceBuilder, reduceLoc, lhs, rhs));
+                });
+          }
+          builder.create<scf::YieldOp>(loc);
+          eraseUnusedGets(retargs);
+        };
+
+    gutils->Logic.differentiate(gutils, parallelOp.getRegion(),
+                                repParallel.getRegion(), false,
+                                buildReduceAndYield);
+
+    // The adjoint was emitted into a fresh block; append it to the
+    // replayed iteration.
+    Block *reverseBody = &*std::next(repParallel.getRegion().begin());
+    body->getOperations().splice(body->end(), reverseBody->getOperations());
+    gutils->mapReverseModeBlocks.erase(parallelOp.getBody());
+    gutils->eraseReverseBlock(reverseBody);
+    for (Operation *placeholder : placeholders)
+      placeholder->erase();
+
+    restoreMapping(saved, gutils);
+    gutils->initializationBlock = outerInitializationBlock;
+
+    for (auto [v, outer, reduced] :
+         llvm::zip(shared, outerGradients, repParallel.getResults())) {
+      if (outer)
+        gutils->invertedPointersGlobal.map(v, outer);
+      else
+        gutils->invertedPointersGlobal.erase(v);
+
+      Value gradient = reduced;
+      if (gutils->hasInvertPointer(v)) {
+        auto iface = v.getType().cast<AutoDiffTypeInterface>();
+        gradient = iface.createAddOp(builder, loc,
+                                     gutils->invertPointerM(v, builder),
+                                     reduced);
+      }
+      gutils->mapInvertPointer(v, gradient, builder);
+    }
+
+    for (Value buffer : buffers)
+      builder.create<memref::DeallocOp>(loc, buffer);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto parallelOp = cast<scf::ParallelOp>(op);
+    if (!isReplayableParallel(parallelOp))
+      return SmallVector<Value>();
+
+    auto newParallel = cast<scf::ParallelOp>(gutils->getNewFromOriginal(op));
+    OpBuilder cacheBuilder(newParallel);
+    SmallVector<Value> caches;
+    for (ValueRange range :
+         {ValueRange(parallelOp.getLowerBound()),
+          ValueRange(parallelOp.getUpperBound()),
+          ValueRange(parallelOp.getStep())}) {
+      for (Value v : range)
+        caches.push_back(gutils->initAndPushCache(gutils->getNewFromOriginal(v),
+                                                  cacheBuilder));
+    }
+
+    // Store the results of ops with memory effects in one buffer per op,
+    // indexed by iteration, for the adjoint iterations to read back.
+    SmallVector<Operation *> buffered;
+    for (Operation &o : parallelOp.getBody()->without_terminator())
+      if (isBufferedInParallel(o))
+        buffered.push_back(&o);
+    if (buffered.empty())
+      return caches;
+
+    Location loc = parallelOp.getLoc();
+    SmallVector<Value> counts = getTripCounts(
+        cacheBuilder, loc, newParallel.getLowerBound(),
+        newParallel.getUpperBound(), newParallel.getStep());
+    Block *newBody = newParallel.getBody();
+    OpBuilder indexBuilder(newBody, newBody->begin());
+    SmallVector<Value> indices = getIterationIndices(
+        indexBuilder, loc, newParallel.getInductionVars(),
+        newParallel.getLowerBound(), newParallel.getStep());
+    SmallVector<int64_t> shape(parallelOp.getNumLoops(),
+                               ShapedType::kDynamicSize);
+    for (Operation *o : buffered) {
+      Value result = gutils->getNewFromOriginal(o->getResult(0));
+      Value buffer = cacheBuilder.create<memref::AllocOp>(
+          loc, MemRefType::get(shape, result.getType()), counts);
+      OpBuilder storeBuilder(result.getContext());
+      storeBuilder.setInsertionPointAfterValue(result);
+      storeBuilder.create<memref::StoreOp>(loc, result, buffer, indices);
+      caches.push_back(gutils->initAndPushCache(buffer, cacheBuilder));
+    }
+    return caches;
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+/// Returns whether the before region of `whileOp` only computes the loop
+/// condition and forwards its arguments unchanged, so that the loop is a
+/// sequence of applications of the after region.
+bool isForwardingWhile(scf::WhileOp whileOp, MGradientUtilsReverse *gutils) {
+  Block &before = whileOp.getBefore().front();
+  if (!llvm::equal(whileOp.getConditionOp().getArgs(), before.getArguments()))
+    return false;
+  for (Operation &o : before.without_terminator())
+    for (Value res : o.getResults())
+      if (!gutils->isConstantValue(res))
+        return false;
+  return true;
+}
+
+struct WhileOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<WhileOpInterfaceReverse,
+                                                       scf::WhileOp> {
+  // The forward pass counts the iterations of the after region and pushes the
+  // count once the loop exits. The adjoint pops it and replays the adjoint of
+  // the after region that many times in an scf.for, carrying the gradients of
+  // the loop-carried values.
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    auto whileOp = cast<scf::WhileOp>(op);
+    Location loc = whileOp.getLoc();
+    if (!isForwardingWhile(whileOp, gutils)) {
+      op->emitError() << "reverse mode of scf.while is only supported when "
+                         "the before region forwards its arguments";
+      return;
+    }
+
+    SmallVector<Value> nArgs;
+    for (Value v : whileOp.getResults()) {
+      if (auto iface = v.getType().dyn_cast<AutoDiffTypeInterface>()) {
+        if (gutils->hasInvertPointer(v)) {
+          nArgs.push_back(gutils->invertPointerM(v, builder));
+        } else {
+          nArgs.push_back(iface.createNullValue(builder, v.getLoc()));
+        }
+      }
+    }
+
+    Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+    auto repFor = builder.create<scf::ForOp>(
+        loc, zero, gutils->popCache(caches[0], builder), one, nArgs);
+    repFor.getRegion().begin()->erase();
+
+    Block *after = &whileOp.getAfter().front();
+    buildReturnFunction buildYield = [gutils,
+                                      after](OpBuilder &builder, Location loc,
+                                             SmallVector<Value> retargs) {
+      SmallVector<Value> gradients;
+      for (BlockArgument arg : after->getArguments()) {
+        auto iface = arg.getType().dyn_cast<AutoDiffTypeInterface>();
+        if (!iface)
+          continue;
+        if (gutils->hasInvertPointer(arg)) {
+          gradients.push_back(gutils->invertPointerM(arg, builder));
+          gutils->clearValue(arg, builder);
+        } else {
+          gradients.push_back(iface.createNullValue(builder, loc));
+        }
+      }
+      builder.create<scf::YieldOp>(loc, gradients);
+      eraseUnusedGets(retargs);
+    };
+
+    gutils->Logic.differentiate(gutils, whileOp.getAfter(), repFor.getRegion(),
+                                false, buildYield);
+
+    // Insert the index which is carried by the scf for op.
+    repFor.getRegion().insertArgument((unsigned)0, builder.getIndexType(), loc);
+
+    // The before region forwards its arguments, so the gradients carried out
+    // of the first iteration belong to the initial values.
+    unsigned idx = 0;
+    for (Value init : whileOp.getInits()) {
+      auto iface = init.getType().dyn_cast<AutoDiffTypeInterface>();
+      if (!iface)
+        continue;
+      Value gradient = repFor.getResult(idx++);
+      if (gutils->isConstantValue(init))
+        continue;
+      if (gutils->hasInvertPointer(init))
+        gradient = iface.createAddOp(builder, loc,
+                                     gutils->invertPointerM(init, builder),
+                                     gradient);
+      gutils->mapInvertPointer(init, gradient, builder);
+    }
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto whileOp = cast<scf::WhileOp>(op);
+    if (!isForwardingWhile(whileOp, gutils))
+      return SmallVector<Value>();
+
+    auto newWhile = cast<scf::WhileOp>(gutils->getNewFromOriginal(op));
+    Location loc = whileOp.getLoc();
+    Type indexType = IndexType::get(op->getContext());
+    Value counter =
+        gutils->insertInit(GradientType::get(op->getContext(), indexType));
+
+    OpBuilder cacheBuilder(newWhile);
+    cacheBuilder.create<enzyme::SetOp>(
+        loc, counter, cacheBuilder.create<arith::ConstantIndexOp>(loc, 0));
+
+    Block &after = newWhile.getAfter().front();
+    OpBuilder afterBuilder(&after, after.begin());
+    Value count = afterBuilder.create<enzyme::GetOp>(loc, indexType, counter);
+    Value one = afterBuilder.create<arith::ConstantIndexOp>(loc, 1);
+    afterBuilder.create<enzyme::SetOp>(
+        loc, counter, afterBuilder.create<arith::AddIOp>(loc, count, one));
+
+    cacheBuilder.setInsertionPointAfter(newWhile);
+    Value total = cacheBuilder.create<enzyme::GetOp>(loc, indexType, counter);
+    return {gutils->initAndPushCache(total, cacheBuilder)};
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
 } // namespace
 
 void mlir::enzyme::registerSCFDialectAutoDiffInterface(
@@ -176,5 +650,7 @@ void mlir::enzyme::registerSCFDialectAutoDiffInterface(
     scf::ForOp::attachInterface<ForOpInterface>(*context);
 
     scf::ForOp::attachInterface<ForOpInterfaceReverse>(*context);
+    scf::ParallelOp::attachInterface<ParallelOpInterfaceReverse>(*context);
+    scf::WhileOp::attachInterface<WhileOpInterfaceReverse>(*context);
   });
 }
@@ -0,0 +1,448 @@
+//===- TensorAutoDiffOpInterfaceImpl.cpp - Interface external model -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the external model implementation of the automatic
+// differentiation op interfaces for the upstream MLIR tensor dialect.
+//
+// Tensors have value semantics: their tangents and adjoints are SSA tensors,
+// updated with the same tensor ops as the primal and combined with
+// `AutoDiffTypeInterface::createAddOp`, so that no buffers are introduced
+// before bufferization.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Implementations/CoreDialectsAutoDiffImplementations.h"
+#include "Interfaces/AutoDiffOpInterface.h"
+#include "Interfaces/AutoDiffTypeInterface.h"
+#include "Interfaces/GradientUtils.h"
+#include "Interfaces/GradientUtilsReverse.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Support/LogicalResult.h"
+
+using namespace mlir;
+using namespace mlir::enzyme;
+
+namespace {
+Value createNullValue(Type type, OpBuilder &builder, Location loc) {
+  return type.cast<AutoDiffTypeInterface>().createNullValue(builder, loc);
+}
+
+/// Returns a zero tensor of `type`, whose dynamic sizes are `dynamicSizes`.
+Value createZeroTensor(RankedTensorType type, ValueRange dynamicSizes,
+                       OpBuilder &builder, Location loc) {
+  if (type.hasStaticShape())
+    return createNullValue(type, builder, loc);
+  Value empty = builder.create<tensor::EmptyOp>(
+      loc, type.getShape(), type.getElementType(), dynamicSizes);
+  Value zero = createNullValue(type.getElementType(), builder, loc);
+  return builder.create<linalg::FillOp>(loc, zero, empty).getResult(0);
+}
+
+/// Returns the current adjoint of `v`, or zero if none was propagated yet.
+/// `dynamicSizes` are the reverse counterparts of the dynamic sizes of `v`.
+Value getAdjointOrNull(Value v, ValueRange dynamicSizes, OpBuilder &builder,
+                       MGradientUtilsReverse *gutils) {
+  if (gutils->hasInvertPointer(v))
+    return gutils->invertPointerM(v, builder);
+  return createZeroTensor(v.getType().cast<RankedTensorType>(), dynamicSizes,
+                          builder, v.getLoc());
+}
+
+void addToGradient(Value v, Value added, OpBuilder &builder,
+                   MGradientUtilsReverse *gutils) {
+  if (gutils->isConstantValue(v))
+    return;
+  Value gradient = added;
+  if (gutils->hasInvertPointer(v)) {
+    auto iface = v.getType().cast<AutoDiffTypeInterface>();
+    gradient = iface.createAddOp(builder, v.getLoc(),
+                                 gutils->invertPointerM(v, builder), added);
+  }
+  gutils->mapInvertPointer(v, gradient, builder);
+}
+
+/// Caches the new counterparts of `values` right before the new `op`.
+SmallVector<Value> cacheOperands(Operation *op, ValueRange values,
+                                 MGradientUtilsReverse *gutils) {
+  OpBuilder cacheBuilder(gutils->getNewFromOriginal(op));
+  SmallVector<Value> caches;
+  for (Value v : values)
+    caches.push_back(
+        gutils->initAndPushCache(gutils->getNewFromOriginal(v), cacheBuilder));
+  return caches;
+}
+
+/// Caches the dynamic sizes of the new counterpart of `tensor` right before
+/// the new `op`, so that the reverse pass can build a zero of its shape.
+void cacheDynamicSizes(Operation *op, Value tensor,
+                       MGradientUtilsReverse *gutils,
+                       SmallVectorImpl<Value> &caches) {
+  auto type = tensor.getType().cast<RankedTensorType>();
+  if (type.hasStaticShape())
+    return;
+  OpBuilder cacheBuilder(gutils->getNewFromOriginal(op));
+  Value newTensor = gutils->getNewFromOriginal(tensor);
+  for (int64_t i = 0, e = type.getRank(); i < e; ++i) {
+    if (!type.isDynamicDim(i))
+      continue;
+    Value size = cacheBuilder.create<tensor::DimOp>(op->getLoc(), newTensor, i);
+    caches.push_back(gutils->initAndPushCache(size, cacheBuilder));
+  }
+}
+
+SmallVector<Value> popCaches(ArrayRef<Value> caches, OpBuilder &builder,
+                             MGradientUtilsReverse *gutils) {
+  SmallVector<Value> values;
+  for (Value cache : caches)
+    values.push_back(gutils->popCache(cache, builder));
+  return values;
+}
+
+/// Replaces the dynamic entries of `mixed` by consecutive entries of
+/// `dynamic`, starting at `pos`.
+SmallVector<OpFoldResult> remapMixed(ArrayRef<OpFoldResult> mixed,
+                                     ArrayRef<Value> dynamic, unsigned &pos) {
+  SmallVector<OpFoldResult> result;
+  for (OpFoldResult ofr : mixed) {
+    if (ofr.is<Value>())
+      result.push_back(dynamic[pos++]);
+    else
+      result.push_back(ofr);
+  }
+  return result;
+}
+
+struct ExtractOpInterface
+    : public AutoDiffOpInterface::ExternalModel<ExtractOpInterface,
+                                                tensor::ExtractOp> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto extractOp = cast<tensor::ExtractOp>(op);
+    if (!gutils->isConstantValue(extractOp)) {
+      SmallVector<Value> inds;
+      for (Value ind : extractOp.getIndices())
+        inds.push_back(gutils->getNewFromOriginal(ind));
+      Value res = builder.create<tensor::ExtractOp>(
+          extractOp.getLoc(),
+          gutils->invertPointerM(extractOp.getTensor(), builder), inds);
+      gutils->setDiffe(extractOp, res, builder);
+    }
+    gutils->eraseIfUnused(op);
+    return success();
+  }
+};
+
+struct InsertOpInterface
+    : public AutoDiffOpInterface::ExternalModel<InsertOpInterface,
+                                                tensor::InsertOp> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto insertOp = cast<tensor::InsertOp>(op);
+    if (!gutils->isConstantValue(insertOp)) {
+      SmallVector<Value> inds;
+      for (Value ind : insertOp.getIndices())
+        inds.push_back(gutils->getNewFromOriginal(ind));
+      Value res = builder.create<tensor::InsertOp>(
+          insertOp.getLoc(),
+          gutils->invertPointerM(insertOp.getScalar(), builder),
+          gutils->invertPointerM(insertOp.getDest(), builder), inds);
+      gutils->setDiffe(insertOp, res, builder);
+    }
+    gutils->eraseIfUnused(op);
+    return success();
+  }
+};
+
+struct ExtractSliceOpInterface
+    : public AutoDiffOpInterface::ExternalModel<ExtractSliceOpInterface,
+                                                tensor::ExtractSliceOp> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto sliceOp = cast<tensor::ExtractSliceOp>(op);
+    if (!gutils->isConstantValue(sliceOp)) {
+      BlockAndValueMapping map;
+      for (Value operand : op->getOperands())
+        map.map(operand, gutils->getNewFromOriginal(operand));
+      map.map(sliceOp.getSource(),
+              gutils->invertPointerM(sliceOp.getSource(), builder));
+      Operation *res = builder.clone(*op, map);
+      gutils->setDiffe(sliceOp, res->getResult(0), builder);
+    }
+    gutils->eraseIfUnused(op);
+    return success();
+  }
+};
+
+struct InsertSliceOpInterface
+    : public AutoDiffOpInterface::ExternalModel<InsertSliceOpInterface,
+                                                tensor::InsertSliceOp> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto sliceOp = cast<tensor::InsertSliceOp>(op);
+    if (!gutils->isConstantValue(sliceOp)) {
+      BlockAndValueMapping map;
+      for (Value operand : op->getOperands())
+        map.map(operand, gutils->getNewFromOriginal(operand));
+      map.map(sliceOp.getSource(),
+              gutils->invertPointerM(sliceOp.getSource(), builder));
+      map.map(sliceOp.getDest(),
+              gutils->invertPointerM(sliceOp.getDest(), builder));
+      Operation *res = builder.clone(*op, map);
+      gutils->setDiffe(sliceOp, res->getResult(0), builder);
+    }
+    gutils->eraseIfUnused(op);
+    return success();
+  }
+};
+
+struct EmptyOpInterface
+    : public AutoDiffOpInterface::ExternalModel<EmptyOpInterface,
+                                                tensor::EmptyOp> {
+  LogicalResult createForwardModeTangent(Operation *op, OpBuilder &builder,
+                                         MGradientUtils *gutils) const {
+    auto emptyOp = cast<tensor::EmptyOp>(op);
+    if (!gutils->isConstantValue(emptyOp)) {
+      Operation *nop = gutils->cloneWithNewOperands(builder, op);
+      gutils->setDiffe(emptyOp, nop->getResult(0), builder);
+    }
+    gutils->eraseIfUnused(op);
+    return success();
+  }
+};
+
+struct ExtractOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<
+          ExtractOpInterfaceReverse, tensor::ExtractOp> {
+  static bool requiresAdjoint(tensor::ExtractOp extractOp,
+                              MGradientUtilsReverse *gutils) {
+    return gutils->hasInvertPointer(extractOp) &&
+           !gutils->isConstantValue(extractOp.getTensor());
+  }
+
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    // Derivative of s = t[i] -> dt[i] += ds
+    auto extractOp = cast<tensor::ExtractOp>(op);
+    if (!requiresAdjoint(extractOp, gutils))
+      return;
+
+    Location loc = extractOp.getLoc();
+    SmallVector<Value> values = popCaches(caches, builder, gutils);
+    unsigned numIndices = extractOp.getIndices().size();
+    auto inds = ArrayRef<Value>(values).take_front(numIndices);
+    auto sizes = ArrayRef<Value>(values).drop_front(numIndices);
+    Value tensor = extractOp.getTensor();
+    Value gradient = getAdjointOrNull(tensor, sizes, builder, gutils);
+    Value element = builder.create<tensor::ExtractOp>(loc, gradient, inds);
+    auto iface = extractOp.getType().cast<AutoDiffTypeInterface>();
+    Value updated = iface.createAddOp(
+        builder, loc, element, gutils->invertPointerM(extractOp, builder));
+    gutils->mapInvertPointer(
+        tensor, builder.create<tensor::InsertOp>(loc, updated, gradient, inds),
+        builder);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto extractOp = cast<tensor::ExtractOp>(op);
+    if (!requiresAdjoint(extractOp, gutils))
+      return SmallVector<Value>();
+    SmallVector<Value> caches =
+        cacheOperands(op, extractOp.getIndices(), gutils);
+    cacheDynamicSizes(op, extractOp.getTensor(), gutils, caches);
+    return caches;
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+struct InsertOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<InsertOpInterfaceReverse,
+                                                       tensor::InsertOp> {
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    // Derivative of r = insert s into d[i] -> ds += dr[i], dd += dr with
+    // dr[i] = 0
+    auto insertOp = cast<tensor::InsertOp>(op);
+    if (!gutils->hasInvertPointer(insertOp))
+      return;
+
+    Location loc = insertOp.getLoc();
+    SmallVector<Value> inds = popCaches(caches, builder, gutils);
+    Value gradient = gutils->invertPointerM(insertOp, builder);
+    Value scalar = insertOp.getScalar();
+    addToGradient(scalar,
+                  builder.create<tensor::ExtractOp>(loc, gradient, inds),
+                  builder, gutils);
+    Value zero = createNullValue(scalar.getType(), builder, loc);
+    addToGradient(insertOp.getDest(),
+                  builder.create<tensor::InsertOp>(loc, zero, gradient, inds),
+                  builder, gutils);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto insertOp = cast<tensor::InsertOp>(op);
+    if (!gutils->hasInvertPointer(insertOp))
+      return SmallVector<Value>();
+    return cacheOperands(op, insertOp.getIndices(), gutils);
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+struct ExtractSliceOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<
+          ExtractSliceOpInterfaceReverse, tensor::ExtractSliceOp> {
+  static bool requiresAdjoint(tensor::ExtractSliceOp sliceOp,
+                              MGradientUtilsReverse *gutils) {
+    return gutils->hasInvertPointer(sliceOp) &&
+           !gutils->isConstantValue(sliceOp.getSource());
+  }
+
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    // Derivative of r = s[slice] -> ds[slice] += dr
+    auto sliceOp = cast<tensor::ExtractSliceOp>(op);
+    if (!requiresAdjoint(sliceOp, gutils))
+      return;
+
+    Location loc = sliceOp.getLoc();
+    SmallVector<Value> dynamic = popCaches(caches, builder, gutils);
+    unsigned pos = 0;
+    auto offsets = remapMixed(sliceOp.getMixedOffsets(), dynamic, pos);
+    auto sizes = remapMixed(sliceOp.getMixedSizes(), dynamic, pos);
+    auto strides = remapMixed(sliceOp.getMixedStrides(), dynamic, pos);
+
+    Value source = sliceOp.getSource();
+    Value gradient = getAdjointOrNull(
+        source, ArrayRef<Value>(dynamic).drop_front(pos), builder, gutils);
+    Value slice = builder.create<tensor::ExtractSliceOp>(
+        loc, sliceOp.getType(), gradient, offsets, sizes, strides);
+    auto iface = sliceOp.getType().cast<AutoDiffTypeInterface>();
+    Value updated = iface.createAddOp(builder, loc, slice,
+                                      gutils->invertPointerM(sliceOp, builder));
+    gutils->mapInvertPointer(
+        source,
+        builder.create<tensor::InsertSliceOp>(loc, updated, gradient, offsets,
+                                              sizes, strides),
+        builder);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto sliceOp = cast<tensor::ExtractSliceOp>(op);
+    if (!requiresAdjoint(sliceOp, gutils))
+      return SmallVector<Value>();
+    SmallVector<Value> dynamic;
+    llvm::append_range(dynamic, sliceOp.getOffsets());
+    llvm::append_range(dynamic, sliceOp.getSizes());
+    llvm::append_range(dynamic, sliceOp.getStrides());
+    SmallVector<Value> caches = cacheOperands(op, dynamic, gutils);
+    cacheDynamicSizes(op, sliceOp.getSource(), gutils, caches);
+    return caches;
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+struct InsertSliceOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<
+          InsertSliceOpInterfaceReverse, tensor::InsertSliceOp> {
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {
+    // Derivative of r = insert s into d[slice] -> ds += dr[slice], dd += dr
+    // with dr[slice] = 0
+    auto sliceOp = cast<tensor::InsertSliceOp>(op);
+    if (!gutils->hasInvertPointer(sliceOp))
+      return;
+
+    Location loc = sliceOp.getLoc();
+    SmallVector<Value> dynamic = popCaches(caches, builder, gutils);
+    unsigned pos = 0;
+    auto offsets = remapMixed(sliceOp.getMixedOffsets(), dynamic, pos);
+    auto sizes = remapMixed(sliceOp.getMixedSizes(), dynamic, pos);
+    auto strides = remapMixed(sliceOp.getMixedStrides(), dynamic, pos);
+
+    Value gradient = gutils->invertPointerM(sliceOp, builder);
+    Value source = sliceOp.getSource();
+    addToGradient(source,
+                  builder.create<tensor::ExtractSliceOp>(
+                      loc, source.getType().cast<RankedTensorType>(), gradient,
+                      offsets, sizes, strides),
+                  builder, gutils);
+    Value zero = createZeroTensor(source.getType().cast<RankedTensorType>(),
+                                  ArrayRef<Value>(dynamic).drop_front(pos),
+                                  builder, loc);
+    Value destGradient = builder.create<tensor::InsertSliceOp>(
+        loc, zero, gradient, offsets, sizes, strides);
+    addToGradient(sliceOp.getDest(), destGradient, builder, gutils);
+  }
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    auto sliceOp = cast<tensor::InsertSliceOp>(op);
+    if (!gutils->hasInvertPointer(sliceOp))
+      return SmallVector<Value>();
+    SmallVector<Value> dynamic;
+    llvm::append_range(dynamic, sliceOp.getOffsets());
+    llvm::append_range(dynamic, sliceOp.getSizes());
+    llvm::append_range(dynamic, sliceOp.getStrides());
+    SmallVector<Value> caches = cacheOperands(op, dynamic, gutils);
+    cacheDynamicSizes(op, sliceOp.getSource(), gutils, caches);
+    return caches;
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+
+struct EmptyOpInterfaceReverse
+    : public ReverseAutoDiffOpInterface::ExternalModel<EmptyOpInterfaceReverse,
+                                                       tensor::EmptyOp> {
+  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,
+                                MGradientUtilsReverse *gutils,
+                                SmallVector<Value> caches) const {}
+
+  SmallVector<Value> cacheValues(Operation *op,
+                                 MGradientUtilsReverse *gutils) const {
+    return SmallVector<Value>();
+  }
+
+  void createShadowValues(Operation *op, OpBuilder &builder,
+                          MGradientUtilsReverse *gutils) const {}
+};
+} // namespace
+
+void mlir::enzyme::registerTensorDialectAutoDiffInterface(
+    DialectRegistry &registry) {
+  registry.addExtension(+[](MLIRContext *context, tensor::TensorDialect *) {
+    tensor::ExtractOp::attachInterface<ExtractOpInterface>(*context);
+    tensor::InsertOp::attachInterface<InsertOpInterface>(*context);
+    tensor::ExtractSliceOp::attachInterface<ExtractSliceOpInterface>(*context);
+    tensor::InsertSliceOp::attachInterface<InsertSliceOpInterface>(*context);
+    tensor::EmptyOp::attachInterface<EmptyOpInterface>(*context);
+
+    tensor::ExtractOp::attachInterface<ExtractOpInterfaceReverse>(*context);
+    tensor::InsertOp::attachInterface<InsertOpInterfaceReverse>(*context);
+    tensor::ExtractSliceOp::attachInterface<ExtractSliceOpInterfaceReverse>(
+        *context);
+    tensor::InsertSliceOp::attachInterface<InsertSliceOpInterfaceReverse>(
+        *context);
+    tensor::EmptyOp::attachInterface<EmptyOpInterfaceReverse>(*context);
+  });
+}
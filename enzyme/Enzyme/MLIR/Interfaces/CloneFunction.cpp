@@ -202,7 +202,7 @@ FunctionOpInterface CloneFunctionWithReturns(
     SmallPtrSetImpl<mlir::Value> &returnvals, ReturnType returnValue,
     DIFFE_TYPE ReturnType, Twine name, BlockAndValueMapping &VMap,
     std::map<Operation *, Operation *> &OpMap, bool diffeReturnArg,
-    mlir::Type additionalArg) {
+    mlir::Type additionalArg, Operation *symbolTableOp) {
   assert(!F.getFunctionBody().empty());
   // F = preprocessForClone(F, mode);
   // llvm::ValueToValueMapTy VMap;
@@ -226,7 +226,9 @@ FunctionOpInterface CloneFunctionWithReturns(
   SymbolTable::setSymbolName(NewF, name.str());
   NewF.setType(FTy);
 
-  Operation *parent = F->getParentWithTrait<OpTrait::SymbolTable>();
+  Operation *parent = symbolTableOp
+                          ? symbolTableOp
+                          : F->getParentWithTrait<OpTrait::SymbolTable>();
   SymbolTable table(parent);
   table.insert(NewF);
   SymbolTable::setSymbolVisibility(NewF, SymbolTable::Visibility::Private);
@@ -50,4 +50,4 @@ FunctionOpInterface CloneFunctionWithReturns(
     SmallPtrSetImpl<mlir::Value> &returnvals, ReturnType returnValue,
     DIFFE_TYPE ReturnType, Twine name, BlockAndValueMapping &VMap,
     std::map<Operation *, Operation *> &OpMap, bool diffeReturnArg,
-    mlir::Type additionalArg);
\ No newline at end of file
+    mlir::Type additionalArg, Operation *symbolTableOp = nullptr);
\ No newline at end of file
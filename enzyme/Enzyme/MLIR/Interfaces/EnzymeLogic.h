@@ -5,11 +5,13 @@
 
 #include "../../Utils.h"
 
+#include <functional>
+
 namespace mlir {
 namespace enzyme {
 
-typedef void (*buildReturnFunction)(OpBuilder &, Location,
-                                    SmallVector<mlir::Value>);
+typedef std::function<void(OpBuilder &, Location, SmallVector<mlir::Value>)>
+    buildReturnFunction;
 
 class MGradientUtilsReverse;
 
@@ -89,6 +91,10 @@ public:
 
   std::map<MForwardCacheKey, FunctionOpInterface> ForwardCachedFunctions;
 
+  // Symbol table operation that synthesized functions are inserted into. If
+  // null, they are inserted next to the function being differentiated.
+  Operation *derivativeSymbolTable = nullptr;
+
   FunctionOpInterface
   CreateForwardDiff(FunctionOpInterface fn, DIFFE_TYPE retType,
                     std::vector<DIFFE_TYPE> constants, MTypeAnalysis &TA,
@@ -108,8 +114,7 @@ public:
                          MGradientUtilsReverse *gutils);
   void handlePredecessors(Block *oBB, Block *newBB, Block *reverseBB,
                           MGradientUtilsReverse *gutils,
-                          void (*buildReturnOp)(OpBuilder &, Location,
-                                                SmallVector<mlir::Value>));
+                          buildReturnFunction buildReturnOp);
   void visitChildren(Block *oBB, Block *reverseBB,
                      MGradientUtilsReverse *gutils);
   void visitChild(Operation *op, OpBuilder &builder,
@@ -204,8 +204,13 @@ void MEnzymeLogic::handlePredecessors(Block *oBB, Block *newBB,
     for (const auto &[diffeType, oldArg] :
          llvm::zip(gutils->ArgDiffeTypes,
                    gutils->oldFunc.getFunctionBody().getArguments())) {
-      if (diffeType == DIFFE_TYPE::OUT_DIFF) {
+      if (diffeType != DIFFE_TYPE::OUT_DIFF)
+        continue;
+      if (gutils->hasInvertPointer(oldArg)) {
         retargs.push_back(gutils->invertPointerM(oldArg, revBuilder));
+      } else {
+        auto iface = oldArg.getType().cast<AutoDiffTypeInterface>();
+        retargs.push_back(iface.createNullValue(revBuilder, oldArg.getLoc()));
       }
     }
     buildReturnOp(revBuilder, oBB->rbegin()->getLoc(), retargs);
@@ -40,7 +40,8 @@ mlir::enzyme::MGradientUtils::MGradientUtils(
       omp(omp), width(width), ArgDiffeTypes(ArgDiffeTypes_),
       originalToNewFn(originalToNewFn_),
       originalToNewFnOps(originalToNewFnOps_),
-      invertedPointers(invertedPointers_) {
+      invertedPointers(invertedPointers_),
+      activityAnalyzer(oldFunc_, ArgDiffeTypes_, ReturnActivity) {
 
   /*
   for (BasicBlock &BB : *oldFunc) {
@@ -142,12 +143,14 @@ bool mlir::enzyme::MGradientUtils::isConstantValue(Value v) const {
     return true;
   if (isa<mlir::IndexType>(v.getType()))
     return true;
+  if (v.getType().isa<TensorType, VectorType>() &&
+      v.getType().cast<ShapedType>().getElementType().isIntOrIndex())
+    return true;
 
   if (matchPattern(v, m_Constant()))
     return true;
 
-  // TODO
-  return false;
+  return activityAnalyzer.isConstantValue(v);
 }
 
 mlir::Value mlir::enzyme::MGradientUtils::invertPointerM(mlir::Value v,
@@ -159,7 +162,10 @@ mlir::Value mlir::enzyme::MGradientUtils::invertPointerM(mlir::Value v,
   if (isConstantValue(v)) {
     if (auto iface = v.getType().cast<AutoDiffTypeInterface>()) {
       OpBuilder::InsertionGuard guard(Builder2);
-      Builder2.setInsertionPoint(getNewFromOriginal(v.getDefiningOp()));
+      if (auto arg = v.dyn_cast<BlockArgument>())
+        Builder2.setInsertionPointToStart(getNewFromOriginal(arg.getOwner()));
+      else
+        Builder2.setInsertionPoint(getNewFromOriginal(v.getDefiningOp()));
       Value dv = iface.createNullValue(Builder2, v.getLoc());
       invertedPointers.map(v, dv);
       return dv;
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "Analysis/ActivityAnalysis.h"
 #include "Interfaces/CloneFunction.h"
 #include "Interfaces/EnzymeLogic.h"
 
@@ -35,6 +36,8 @@ public:
   unsigned width;
   ArrayRef<DIFFE_TYPE> ArgDiffeTypes;
 
+  MActivityAnalyzer activityAnalyzer;
+
   mlir::Value getNewFromOriginal(const mlir::Value originst) const;
   mlir::Block *getNewFromOriginal(mlir::Block *originst) const;
   Operation *getNewFromOriginal(Operation *originst) const;
@@ -115,7 +118,7 @@ public:
         mode, width, todiff, invertedPointers, constant_args, constant_values,
         nonconstant_values, returnvals, returnValue, retType,
         prefix + todiff.getName(), originalToNew, originalToNewOps,
-        diffeReturnArg, additionalArg);
+        diffeReturnArg, additionalArg, Logic.derivativeSymbolTable);
     return new MDiffeGradientUtils(Logic, newFunc, todiff, TA, invertedPointers,
                                    constant_values, nonconstant_values, retType,
                                    constant_args, originalToNew,
@@ -14,6 +14,7 @@
 #include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 
 // TODO: this shouldn't depend on specific dialects except Enzyme.
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
@@ -23,6 +24,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Dominance.h"
 #include "llvm/ADT/BreadthFirstIterator.h"
+#include "llvm/ADT/SetVector.h"
 
 using namespace mlir;
 using namespace mlir::enzyme;
@@ -39,7 +41,8 @@ mlir::enzyme::MGradientUtilsReverse::MGradientUtilsReverse(
     : newFunc(newFunc_), Logic(Logic), mode(mode_), oldFunc(oldFunc_), TA(TA_),
       width(width), ArgDiffeTypes(ArgDiffeTypes_),
       originalToNewFn(originalToNewFn_),
-      originalToNewFnOps(originalToNewFnOps_), symbolTable(symbolTable_) {
+      originalToNewFnOps(originalToNewFnOps_), symbolTable(symbolTable_),
+      activityAnalyzer(oldFunc_, ArgDiffeTypes_, ReturnActivity) {
 
   initInitializationBlock(invertedPointers_, activevals_);
 }
@@ -72,16 +75,147 @@ Type mlir::enzyme::MGradientUtilsReverse::getCacheType(Type t) {
   return cacheType;
 }
 
+// Upper bound on the number of operations cloned to recompute a single value.
+static constexpr unsigned maxRecomputeOps = 16;
+
+// Operations that can be replayed in the reverse pass: they neither read nor
+// write memory, so their results only depend on their operands.
+static bool isRecomputable(Operation *op) {
+  return op && op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+
+/*
+Decides between caching `v` and recomputing it in the reverse pass. Values
+that can be recomputed from values available in the reverse are not cached
+at all. Otherwise the recomputation frontier (the values that cannot be
+recomputed) is cached instead of `v` if that does not take more pushes than
+caching `v` itself, which lets several recomputed values share one cache.
+The returned value must only be passed to popCache.
+*/
 Value MGradientUtilsReverse::initAndPushCache(Value v, OpBuilder &builder) {
+  Block *block = builder.getInsertionBlock();
+  unsigned cachePushes = primalCaches.count({v, block}) ? 0 : 1;
+
+  SmallVector<Value> frontier;
+  if (cachePushes != 0 && getRecomputeFrontier(v, frontier)) {
+    unsigned frontierPushes = llvm::count_if(
+        frontier, [&](Value f) { return !primalCaches.count({f, block}); });
+    if (frontierPushes <= cachePushes) {
+      for (Value f : frontier)
+        pushCache(f, builder);
+      return v;
+    }
+  }
+  return pushCache(v, builder);
+}
+
+// Pushes `v` at most once per primal block; all users of `v` in that block
+// share the cache and the value popped from it.
+Value MGradientUtilsReverse::pushCache(Value v, OpBuilder &builder) {
+  Block *block = builder.getInsertionBlock();
+  auto found = primalCaches.find({v, block});
+  if (found != primalCaches.end())
+    return found->second;
+
   Value cache = insertInit(getCacheType(v.getType()));
   builder.create<enzyme::PushOp>(v.getLoc(), cache, v);
+  primalCaches[{v, block}] = cache;
   return cache;
 }
 
 Value MGradientUtilsReverse::popCache(Value cache, OpBuilder &builder) {
-  return builder.create<enzyme::PopOp>(
+  if (!cache.getType().isa<enzyme::CacheType>())
+    return recomputeValue(cache, builder);
+
+  // A cache is popped at most once per reverse mode block. If an earlier pop
+  // was created after the insertion point, hoist it so that it dominates.
+  Block *block = builder.getInsertionBlock();
+  if (Value popped = reverseValues.lookup({cache, block})) {
+    if (builder.getInsertionPoint() != block->end() &&
+        !popped.getDefiningOp()->isBeforeInBlock(&*builder.getInsertionPoint()))
+      popped.getDefiningOp()->moveBefore(block, builder.getInsertionPoint());
+    return popped;
+  }
+
+  Value popped = builder.create<enzyme::PopOp>(
       cache.getLoc(), cast<enzyme::CacheType>(cache.getType()).getType(),
       cache);
+  reverseValues[{cache, block}] = popped;
+  return popped;
+}
+
+// Values of the entry block dominate every reverse mode block.
+bool MGradientUtilsReverse::isAvailableInReverse(Value v) {
+  return v.getParentBlock() == &newFunc.getFunctionBody().front();
+}
+
+bool MGradientUtilsReverse::getRecomputeFrontier(
+    Value v, SmallVectorImpl<Value> &frontier) {
+  if (isAvailableInReverse(v))
+    return true;
+  Operation *op = v.getDefiningOp();
+  if (!isRecomputable(op))
+    return false;
+
+  SmallVector<Operation *> worklist = {op};
+  SmallPtrSet<Operation *, 8> visited = {op};
+  llvm::SetVector<Value> values;
+  while (!worklist.empty()) {
+    if (visited.size() > maxRecomputeOps)
+      return false;
+    Operation *current = worklist.pop_back_val();
+    for (Value operand : current->getOperands()) {
+      if (isAvailableInReverse(operand))
+        continue;
+      Operation *definingOp = operand.getDefiningOp();
+      if (!isRecomputable(definingOp))
+        values.insert(operand);
+      else if (visited.insert(definingOp).second)
+        worklist.push_back(definingOp);
+    }
+  }
+  frontier.append(values.begin(), values.end());
+  return true;
+}
+
+Value MGradientUtilsReverse::recomputeValue(Value v, OpBuilder &builder) {
+  if (isAvailableInReverse(v))
+    return v;
+  if (Value recomputed = lookupReverseValue(v, builder))
+    return recomputed;
+
+  // Values on the recomputation frontier were cached in the primal block
+  // that the current reverse mode block reverses.
+  Block *block = builder.getInsertionBlock();
+  Block *primalBlock = reverseToPrimalBlocks.lookup(block);
+  auto found = primalCaches.find({v, primalBlock});
+  if (found != primalCaches.end())
+    return popCache(found->second, builder);
+
+  Operation *op = v.getDefiningOp();
+  assert(isRecomputable(op) && "value was neither cached nor recomputable");
+  BlockAndValueMapping mapping;
+  for (Value operand : op->getOperands())
+    mapping.map(operand, recomputeValue(operand, builder));
+  Operation *clone = builder.clone(*op, mapping);
+  for (auto [result, recomputed] :
+       llvm::zip(op->getResults(), clone->getResults()))
+    reverseValues[{result, block}] = recomputed;
+  return clone->getResult(v.cast<OpResult>().getResultNumber());
+}
+
+// Returns the value already popped or recomputed for `v` in the current
+// reverse mode block, if it dominates the insertion point.
+Value MGradientUtilsReverse::lookupReverseValue(Value v, OpBuilder &builder) {
+  Block *block = builder.getInsertionBlock();
+  Value found = reverseValues.lookup({v, block});
+  if (!found)
+    return nullptr;
+  Operation *definingOp = found.getDefiningOp();
+  if (builder.getInsertionPoint() != block->end() &&
+      !definingOp->isBeforeInBlock(&*builder.getInsertionPoint()))
+    return nullptr;
+  return found;
 }
 
 // Gradient
@@ -163,12 +297,14 @@ bool mlir::enzyme::MGradientUtilsReverse::isConstantValue(Value v) const {
     return true;
   if (isa<mlir::IndexType>(v.getType()))
     return true;
+  if (v.getType().isa<TensorType, VectorType>() &&
+      v.getType().cast<ShapedType>().getElementType().isIntOrIndex())
+    return true;
 
   if (matchPattern(v, m_Constant()))
     return true;
 
-  // TODO
-  return false;
+  return activityAnalyzer.isConstantValue(v);
 }
 
 bool mlir::enzyme::MGradientUtilsReverse::requiresShadow(Type t) {
@@ -284,6 +420,11 @@ void MGradientUtilsReverse::initInitializationBlock(
       this->newFunc.getFunctionBody().begin()->begin());
 
   for (Value activeval : activevals_) {
+    // The zero adjoint of a dynamically shaped tensor needs its sizes, so it
+    // is created lazily by the first op that accumulates into it.
+    if (auto tensorType = activeval.getType().dyn_cast<RankedTensorType>())
+      if (!tensorType.hasStaticShape())
+        continue;
     if (auto iface = dyn_cast<AutoDiffTypeInterface>(activeval.getType())) {
       Value zero =
           iface.createNullValue(initializationBuilder, activeval.getLoc());
@@ -358,10 +499,24 @@ void MGradientUtilsReverse::createReverseModeBlocks(Region &oldFunc,
     }
 
     mapReverseModeBlocks.map(block, reverseBlock);
+    reverseToPrimalBlocks[reverseBlock] = getNewFromOriginal(block);
     newFunc.getBlocks().insert(newFunc.end(), reverseBlock);
   }
 }
 
+// Erases a reverse mode block whose operations were moved elsewhere, together
+// with the values popped or recomputed for it.
+void MGradientUtilsReverse::eraseReverseBlock(Block *block) {
+  reverseToPrimalBlocks.erase(block);
+  SmallVector<std::pair<Value, Block *>> stale;
+  for (auto &entry : reverseValues)
+    if (entry.first.second == block)
+      stale.push_back(entry.first);
+  for (auto &key : stale)
+    reverseValues.erase(key);
+  block->erase();
+}
+
 MGradientUtilsReverse *MGradientUtilsReverse::CreateFromClone(
     MEnzymeLogic &Logic, DerivativeMode mode_, unsigned width,
     FunctionOpInterface todiff, MTypeAnalysis &TA, MFnTypeInfo &oldTypeInfo,
@@ -397,7 +552,7 @@ MGradientUtilsReverse *MGradientUtilsReverse::CreateFromClone(
       mode_, width, todiff, invertedPointers, constant_args, constant_values,
       nonconstant_values, returnvals, returnValue, retType,
       prefix + todiff.getName(), originalToNew, originalToNewOps,
-      diffeReturnArg, additionalArg);
+      diffeReturnArg, additionalArg, Logic.derivativeSymbolTable);
 
   return new MGradientUtilsReverse(
       Logic, newFunc, todiff, TA, invertedPointers, constant_values,
@@ -10,6 +10,7 @@
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/FunctionInterfaces.h"
 
+#include "Analysis/ActivityAnalysis.h"
 #include "CloneFunction.h"
 #include "EnzymeLogic.h"
 
@@ -45,6 +46,13 @@ public:
 
   BlockAndValueMapping mapReverseModeBlocks;
   DenseMap<Block *, SmallVector<std::pair<Value, Value>>> mapBlockArguments;
+  // Reverse mode block -> primal block of the new function it reverses
+  DenseMap<Block *, Block *> reverseToPrimalBlocks;
+
+  // (primal value, primal block of the push) -> cache
+  DenseMap<std::pair<Value, Block *>, Value> primalCaches;
+  // (cache or recomputed primal value, reverse block) -> value in the reverse
+  DenseMap<std::pair<Value, Block *>, Value> reverseValues;
 
   BlockAndValueMapping originalToNewFn;
   std::map<Operation *, Operation *> originalToNewFnOps;
@@ -56,6 +64,8 @@ public:
 
   SymbolTableCollection &symbolTable;
 
+  MActivityAnalyzer activityAnalyzer;
+
   mlir::Value getNewFromOriginal(const mlir::Value originst) const;
   mlir::Block *getNewFromOriginal(mlir::Block *originst) const;
   Operation *getNewFromOriginal(Operation *originst) const;
@@ -104,8 +114,16 @@ public:
 
   Value popCache(Value cache, OpBuilder &builder);
 
+  // Recompute
+  bool isAvailableInReverse(Value v);
+  bool getRecomputeFrontier(Value v, SmallVectorImpl<Value> &frontier);
+  Value pushCache(Value v, OpBuilder &builder);
+  Value recomputeValue(Value v, OpBuilder &builder);
+  Value lookupReverseValue(Value v, OpBuilder &builder);
+
   void createReverseModeBlocks(Region &oldFunc, Region &newFunc,
                                bool isParentRegion = false);
+  void eraseReverseBlock(Block *block);
 
   static MGradientUtilsReverse *
   CreateFromClone(MEnzymeLogic &Logic, DerivativeMode mode_, unsigned width,
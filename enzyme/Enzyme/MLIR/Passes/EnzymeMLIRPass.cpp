@@ -17,10 +17,20 @@
 #include "Passes/Passes.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Interfaces/ControlFlowInterfaces.h"
 
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+
+#include <atomic>
 
 #define DEBUG_TYPE "enzyme"
 
@@ -29,20 +39,34 @@ using namespace mlir::enzyme;
 using namespace enzyme;
 
 namespace {
-struct DifferentiatePass : public DifferentiatePassBase<DifferentiatePass> {
-  MEnzymeLogic Logic;
+/// A derivative to synthesize, shared by all Enzyme ops that differentiate the
+/// same function with the same mode and activity.
+struct DerivativeRequest {
+  FunctionOpInterface fn;
+  DerivativeMode mode;
+  std::vector<DIFFE_TYPE> constants;
+
+  // Detached module the derivative is synthesized into, so that requests can
+  // be processed in parallel without mutating the module being transformed.
+  OwningOpRef<ModuleOp> scratch;
+  FunctionOpInterface newFunc;
+};
+
+using DerivativeKey =
+    std::tuple<Operation *, DerivativeMode, std::vector<DIFFE_TYPE>>;
 
+struct DifferentiatePass : public DifferentiatePassBase<DifferentiatePass> {
   void runOnOperation() override;
 
   template <typename T>
-  void HandleAutoDiff(SymbolTableCollection &symbolTable, T CI) {
+  std::vector<DIFFE_TYPE> getActivity(T CI, unsigned numInputs,
+                                      SmallVectorImpl<mlir::Value> &args) {
     std::vector<DIFFE_TYPE> constants;
-    SmallVector<mlir::Value, 2> args;
 
     size_t truei = 0;
     auto activityAttr = CI.getActivity();
 
-    for (unsigned i = 0; i < CI.getInputs().size(); ++i) {
+    for (unsigned i = 0; i < numInputs; ++i) {
       mlir::Value res = CI.getInputs()[i];
 
       auto mop = activityAttr[truei];
@@ -59,16 +83,23 @@ struct DifferentiatePass : public DifferentiatePassBase<DifferentiatePass> {
 
       truei++;
     }
+    return constants;
+  }
 
-    auto *symbolOp = symbolTable.lookupNearestSymbolFrom(CI, CI.getFnAttr());
-    auto fn = cast<FunctionOpInterface>(symbolOp);
-
+  // Runs on a worker thread: only reads the module being transformed and
+  // writes into the request's scratch module.
+  static void synthesize(DerivativeRequest &request) {
+    FunctionOpInterface fn = request.fn;
     DIFFE_TYPE retType =
         fn.getNumResults() == 0 ? DIFFE_TYPE::CONSTANT : DIFFE_TYPE::DUP_ARG;
 
+    MEnzymeLogic Logic;
+    Logic.derivativeSymbolTable = request.scratch.get();
+    SymbolTableCollection symbolTable;
+
     MTypeAnalysis TA;
     auto type_args = TA.getAnalyzedTypeInfo(fn);
-    auto mode = DerivativeMode::ForwardMode;
+    auto mode = request.mode;
     bool freeMemory = true;
     size_t width = 1;
 
@@ -77,121 +108,94 @@ struct DifferentiatePass : public DifferentiatePassBase<DifferentiatePass> {
       volatile_args.push_back(!(mode == DerivativeMode::ReverseModeCombined));
     }
 
-    FunctionOpInterface newFunc = Logic.CreateForwardDiff(
-        fn, retType, constants, TA,
-        /*should return*/ false, mode, freeMemory, width,
-        /*addedType*/ nullptr, type_args, volatile_args,
-        /*augmented*/ nullptr);
-
-    OpBuilder builder(CI);
-    auto dCI = builder.create<func::CallOp>(CI.getLoc(), newFunc.getName(),
-                                            newFunc.getResultTypes(), args);
-    CI.replaceAllUsesWith(dCI);
-    CI->erase();
+    if (mode == DerivativeMode::ForwardMode) {
+      request.newFunc = Logic.CreateForwardDiff(
+          fn, retType, request.constants, TA,
+          /*should return*/ false, mode, freeMemory, width,
+          /*addedType*/ nullptr, type_args, volatile_args,
+          /*augmented*/ nullptr);
+    } else {
+      request.newFunc = Logic.CreateReverseDiff(
+          fn, retType, request.constants, TA,
+          /*should return*/ false, mode, freeMemory, width,
+          /*addedType*/ nullptr, type_args, volatile_args,
+          /*augmented*/ nullptr, symbolTable);
+    }
   }
 
-  template <typename T>
-  void HandleAutoDiffReverse(SymbolTableCollection &symbolTable, T CI) {
-    std::vector<DIFFE_TYPE> constants;
-    SmallVector<mlir::Value, 2> args;
-
-    size_t truei = 0;
-    auto activityAttr = CI.getActivity();
-
-    for (unsigned i = 0; i < CI.getInputs().size() - 1; ++i) {
-      mlir::Value res = CI.getInputs()[i];
-
-      auto mop = activityAttr[truei];
-      auto iattr = cast<mlir::enzyme::ActivityAttr>(mop);
-      DIFFE_TYPE ty = (DIFFE_TYPE)(iattr.getValue());
-
-      constants.push_back(ty);
-      args.push_back(res);
-      if (ty == DIFFE_TYPE::DUP_ARG || ty == DIFFE_TYPE::DUP_NONEED) {
-        ++i;
-        res = CI.getInputs()[i];
-        args.push_back(res);
+  /// Lowers `ops`, whose target functions must not contain Enzyme ops
+  /// themselves. Distinct derivatives are synthesized in parallel and then
+  /// inserted into the module in the order they were first requested.
+  /// `derivatives` holds those synthesized by earlier rounds for reuse.
+  void lowerEnzymeCalls(
+      SymbolTableCollection &symbolTable, ArrayRef<Operation *> ops,
+      std::map<DerivativeKey, FunctionOpInterface> &derivatives) {
+    SmallVector<std::unique_ptr<DerivativeRequest>> newRequests;
+    SmallVector<std::pair<Operation *, SmallVector<mlir::Value>>> calls;
+    SmallVector<DerivativeKey> callKeys;
+
+    for (Operation *op : ops) {
+      SmallVector<mlir::Value> args;
+      std::vector<DIFFE_TYPE> constants;
+      DerivativeMode mode;
+      FlatSymbolRefAttr fnAttr;
+      if (auto CI = dyn_cast<enzyme::ForwardDiffOp>(op)) {
+        mode = DerivativeMode::ForwardMode;
+        fnAttr = CI.getFnAttr();
+        constants = getActivity(CI, CI.getInputs().size(), args);
+      } else if (auto CI = dyn_cast<enzyme::AutoDiffOp>(op)) {
+        mode = DerivativeMode::ReverseModeGradient;
+        fnAttr = CI.getFnAttr();
+        constants = getActivity(CI, CI.getInputs().size() - 1, args);
+        // Add the return gradient
+        args.push_back(CI.getInputs()[CI.getInputs().size() - 1]);
+      } else {
+        llvm_unreachable("Illegal type");
       }
 
-      truei++;
+      auto *symbolOp = symbolTable.lookupNearestSymbolFrom(op, fnAttr);
+      auto fn = cast<FunctionOpInterface>(symbolOp);
+
+      DerivativeKey key(fn, mode, constants);
+      if (!derivatives.count(key)) {
+        auto request = std::make_unique<DerivativeRequest>();
+        request->fn = fn;
+        request->mode = mode;
+        request->constants = constants;
+        request->scratch = ModuleOp::create(op->getLoc());
+        derivatives[key] = nullptr;
+        newRequests.push_back(std::move(request));
+      }
+      calls.emplace_back(op, std::move(args));
+      callKeys.push_back(key);
     }
 
-    // Add the return gradient
-    mlir::Value res = CI.getInputs()[CI.getInputs().size() - 1];
-    args.push_back(res);
-
-    auto *symbolOp = symbolTable.lookupNearestSymbolFrom(CI, CI.getFnAttr());
-    auto fn = cast<FunctionOpInterface>(symbolOp);
-
-    DIFFE_TYPE retType =
-        fn.getNumResults() == 0 ? DIFFE_TYPE::CONSTANT : DIFFE_TYPE::DUP_ARG;
-
-    MTypeAnalysis TA;
-    auto type_args = TA.getAnalyzedTypeInfo(fn);
-    auto mode = DerivativeMode::ReverseModeGradient;
-    bool freeMemory = true;
-    size_t width = 1;
-
-    std::vector<bool> volatile_args;
-    for (auto &a : fn.getFunctionBody().getArguments()) {
-      volatile_args.push_back(!(mode == DerivativeMode::ReverseModeCombined));
+    parallelForEach(&getContext(), newRequests,
+                    [](std::unique_ptr<DerivativeRequest> &request) {
+                      synthesize(*request);
+                    });
+
+    // Deterministic merge: SymbolTable::insert renames on collisions, so the
+    // final names only depend on the order of the requests.
+    SymbolTable moduleTable(getOperation());
+    for (auto &request : newRequests) {
+      request->newFunc->remove();
+      moduleTable.insert(request->newFunc);
+      derivatives[DerivativeKey(request->fn, request->mode,
+                                request->constants)] = request->newFunc;
     }
 
-    FunctionOpInterface newFunc = Logic.CreateReverseDiff(
-        fn, retType, constants, TA,
-        /*should return*/ false, mode, freeMemory, width,
-        /*addedType*/ nullptr, type_args, volatile_args,
-        /*augmented*/ nullptr, symbolTable);
-
-    OpBuilder builder(CI);
-    auto dCI = builder.create<func::CallOp>(CI.getLoc(), newFunc.getName(),
-                                            newFunc.getResultTypes(), args);
-    CI.replaceAllUsesWith(dCI);
-    CI->erase();
-  }
-
-  void lowerEnzymeCalls(SymbolTableCollection &symbolTable,
-                        FunctionOpInterface op) {
-    {
-      SmallVector<Operation *> toLower;
-      op->walk([&](enzyme::ForwardDiffOp dop) {
-        auto *symbolOp =
-            symbolTable.lookupNearestSymbolFrom(dop, dop.getFnAttr());
-        auto callableOp = cast<FunctionOpInterface>(symbolOp);
-
-        lowerEnzymeCalls(symbolTable, callableOp);
-        toLower.push_back(dop);
-      });
-
-      for (auto T : toLower) {
-        if (auto F = dyn_cast<enzyme::ForwardDiffOp>(T)) {
-          HandleAutoDiff(symbolTable, F);
-        } else {
-          llvm_unreachable("Illegal type");
-        }
-      }
-    };
-
-    {
-      SmallVector<Operation *> toLower;
-      op->walk([&](enzyme::AutoDiffOp dop) {
-        auto *symbolOp =
-            symbolTable.lookupNearestSymbolFrom(dop, dop.getFnAttr());
-        auto callableOp = cast<FunctionOpInterface>(symbolOp);
-
-        lowerEnzymeCalls(symbolTable, callableOp);
-        toLower.push_back(dop);
-      });
-
-      for (auto T : toLower) {
-        if (auto F = dyn_cast<enzyme::AutoDiffOp>(T)) {
-          HandleAutoDiffReverse(symbolTable, F);
-        } else {
-          llvm_unreachable("Illegal type");
-        }
-      }
+    for (auto [call, key] : llvm::zip(calls, callKeys)) {
+      Operation *CI = call.first;
+      FunctionOpInterface newFunc = derivatives[key];
+      OpBuilder builder(CI);
+      auto dCI = builder.create<func::CallOp>(CI->getLoc(), newFunc.getName(),
+                                              newFunc.getResultTypes(),
+                                              call.second);
+      CI->replaceAllUsesWith(dCI);
+      CI->erase();
     }
-  };
+  }
 };
 
 } // end anonymous namespace
@@ -205,13 +209,68 @@ std::unique_ptr<Pass> createDifferentiatePass() {
 } // namespace enzyme
 } // namespace mlir
 
-#include "mlir/IR/PatternMatch.h"
-#include "mlir/Transforms/DialectConversion.h"
+static bool containsEnzymeCalls(Operation *op) {
+  return op
+      ->walk([](Operation *nested) {
+        if (isa<enzyme::ForwardDiffOp, enzyme::AutoDiffOp>(nested))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
 
 void DifferentiatePass::runOnOperation() {
   SymbolTableCollection symbolTable;
   symbolTable.getSymbolTable(getOperation());
-  ConversionPatternRewriter B(getOperation()->getContext());
-  getOperation()->walk(
-      [&](FunctionOpInterface op) { lowerEnzymeCalls(symbolTable, op); });
+
+  // Op models report constructs they cannot differentiate as errors and carry
+  // on, so that every problem is diagnosed. The derivative is incomplete then
+  // and the pass must fail. Errors may be emitted from worker threads.
+  std::atomic<bool> emittedError(false);
+  ScopedDiagnosticHandler errorTracker(&getContext(), [&](Diagnostic &diag) {
+    if (diag.getSeverity() == DiagnosticSeverity::Error)
+      emittedError = true;
+    return failure();
+  });
+
+  // Enzyme ops are lowered in rounds. Each round handles the ops whose target
+  // function no longer contains Enzyme ops, so that a derivative is only
+  // synthesized once the function it differentiates is final.
+  std::map<DerivativeKey, FunctionOpInterface> derivatives;
+  while (true) {
+    // Worker threads read the module concurrently; make sure no query lazily
+    // recomputes the operation order of a block while they do.
+    getOperation()->walk([](Block *block) {
+      if (!block->isOpOrderValid())
+        block->recomputeOpOrder();
+    });
+
+    SmallVector<Operation *> ready;
+    bool pending = false;
+    getOperation()->walk([&](Operation *op) {
+      FlatSymbolRefAttr fnAttr;
+      if (auto CI = dyn_cast<enzyme::ForwardDiffOp>(op))
+        fnAttr = CI.getFnAttr();
+      else if (auto CI = dyn_cast<enzyme::AutoDiffOp>(op))
+        fnAttr = CI.getFnAttr();
+      else
+        return;
+      pending = true;
+      auto *symbolOp = symbolTable.lookupNearestSymbolFrom(op, fnAttr);
+      if (!containsEnzymeCalls(symbolOp))
+        ready.push_back(op);
+    });
+
+    if (!pending)
+      return;
+    if (ready.empty()) {
+      getOperation()->emitError()
+          << "cannot differentiate functions that recursively contain "
+             "Enzyme operations";
+      return signalPassFailure();
+    }
+    lowerEnzymeCalls(symbolTable, ready, derivatives);
+    if (emittedError)
+      return signalPassFailure();
+  }
 }
@@ -19,6 +19,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 #include "llvm/Support/raw_ostream.h"
@@ -26,182 +27,147 @@
 using namespace mlir;
 using llvm::errs;
 namespace {
+/// Maps the `enzyme.init` result of every cache whose total number of pushes
+/// is known at compile time to that number.
+using StaticCapacityMap = llvm::DenseMap<Value, int64_t>;
+
+/// Returns true if `block` can reach itself through the CFG of its region.
+static bool isInCycle(Block *block) {
+  SmallVector<Block *> worklist(block->succ_begin(), block->succ_end());
+  SmallPtrSet<Block *, 8> seen;
+  while (!worklist.empty()) {
+    Block *succ = worklist.pop_back_val();
+    if (succ == block)
+      return true;
+    if (!seen.insert(succ).second)
+      continue;
+    worklist.append(succ->succ_begin(), succ->succ_end());
+  }
+  return false;
+}
+
+/// Returns the number of times `op` executes per execution of the region
+/// `outer`, if it is only nested in `scf.for` loops with constant bounds (and
+/// `scf.if`s, which are conservatively counted as always taken).
+static llvm::Optional<int64_t> getStaticExecutionCount(Operation *op,
+                                                       Region *outer) {
+  int64_t count = 1;
+  Operation *ancestor = op;
+  while (ancestor->getParentRegion() != outer) {
+    Operation *parent = ancestor->getParentOp();
+    if (!parent)
+      return llvm::None;
+    if (auto forOp = dyn_cast<scf::ForOp>(parent)) {
+      auto lb = getConstantIntValue(forOp.getLowerBound());
+      auto ub = getConstantIntValue(forOp.getUpperBound());
+      auto step = getConstantIntValue(forOp.getStep());
+      if (!lb || !ub || !step || *step <= 0)
+        return llvm::None;
+      int64_t tripCount = *ub <= *lb ? 0 : llvm::divideCeil(*ub - *lb, *step);
+      count *= tripCount;
+    } else if (!isa<scf::IfOp>(parent)) {
+      return llvm::None;
+    }
+    ancestor = parent;
+  }
+  if (isInCycle(ancestor->getBlock()))
+    return llvm::None;
+  return count;
+}
+
+/// Returns the number of elements ever pushed to the cache created by
+/// `initOp`, if every push happens a statically known number of times.
+static llvm::Optional<int64_t> getStaticCacheCapacity(enzyme::InitOp initOp) {
+  int64_t capacity = 0;
+  for (Operation *user : initOp->getUsers()) {
+    if (isa<enzyme::PopOp, enzyme::GetOp>(user))
+      continue;
+    if (!isa<enzyme::PushOp>(user))
+      return llvm::None;
+    auto count = getStaticExecutionCount(user, initOp->getParentRegion());
+    if (!count)
+      return llvm::None;
+    capacity += *count;
+  }
+  return capacity;
+}
+
 struct LoweredCache {
   Value elements, size, capacity;
   Type elementType;
-
-  void allocateCache(Location loc, OpBuilder &b) {}
-
-  FlatSymbolRefAttr getOrInsertPushFunction(Location loc, ModuleOp moduleOp,
-                                            OpBuilder &b) const {
-    MLIRContext *context = b.getContext();
-    std::string funcName = "__enzyme_push_";
-    llvm::raw_string_ostream funcStream{funcName};
-    funcStream << elementType;
-    if (moduleOp.lookupSymbol<func::FuncOp>(funcName)) {
-      return SymbolRefAttr::get(context, funcName);
+  // Caches with a static capacity are allocated once at their final size and
+  // never need to grow.
+  bool isStatic;
+
+  void emitPush(Location loc, Value value, OpBuilder &b) const {
+    Value sizeVal = b.create<memref::LoadOp>(loc, size);
+
+    if (!isStatic) {
+      Value capacityVal = b.create<memref::LoadOp>(loc, capacity);
+      Value predicate = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                                sizeVal, capacityVal);
+      b.create<scf::IfOp>(
+          loc, predicate, [&](OpBuilder &thenBuilder, Location loc) {
+            Value two = thenBuilder.create<arith::ConstantIndexOp>(loc, 2);
+            Value newCapacity =
+                thenBuilder.create<arith::MulIOp>(loc, capacityVal, two);
+            Value oldElements =
+                thenBuilder.create<memref::LoadOp>(loc, elements);
+            Value newElements = thenBuilder.create<memref::AllocOp>(
+                loc, oldElements.getType().cast<MemRefType>(), newCapacity);
+            thenBuilder.create<memref::CopyOp>(loc, oldElements, newElements);
+            thenBuilder.create<memref::DeallocOp>(loc, oldElements);
+            thenBuilder.create<memref::StoreOp>(loc, newElements, elements);
+            thenBuilder.create<memref::StoreOp>(loc, newCapacity, capacity);
+            thenBuilder.create<scf::YieldOp>(loc);
+          });
     }
 
-    OpBuilder::InsertionGuard insertionGuard(b);
-    b.setInsertionPointToStart(moduleOp.getBody());
-
-    auto pushFnType = FunctionType::get(
-        context, /*inputs=*/
-        {elements.getType(), size.getType(), capacity.getType(), elementType},
-        /*outputs=*/{});
-    auto pushFn = b.create<func::FuncOp>(loc, funcName, pushFnType);
-    pushFn.setPrivate();
-    Block *entryBlock = pushFn.addEntryBlock();
-    b.setInsertionPointToStart(entryBlock);
-    BlockArgument elementsField = pushFn.getArgument(0);
-    BlockArgument sizeField = pushFn.getArgument(1);
-    BlockArgument capacityField = pushFn.getArgument(2);
-    BlockArgument value = pushFn.getArgument(3);
-
-    Value sizeVal = b.create<memref::LoadOp>(loc, sizeField);
-    Value capacityVal = b.create<memref::LoadOp>(loc, capacityField);
-
-    Value predicate = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
-                                              sizeVal, capacityVal);
-    b.create<scf::IfOp>(
-        loc, predicate, [&](OpBuilder &thenBuilder, Location loc) {
-          Value two = thenBuilder.create<arith::ConstantIndexOp>(loc, 2);
-          Value newCapacity =
-              thenBuilder.create<arith::MulIOp>(loc, capacityVal, two);
-          Value oldElements =
-              thenBuilder.create<memref::LoadOp>(loc, elementsField);
-          Value newElements = thenBuilder.create<memref::AllocOp>(
-              loc, oldElements.getType().cast<MemRefType>(), newCapacity);
-          thenBuilder.create<memref::CopyOp>(loc, oldElements, newElements);
-          thenBuilder.create<memref::DeallocOp>(loc, oldElements);
-          thenBuilder.create<memref::StoreOp>(loc, newElements, elementsField);
-          thenBuilder.create<memref::StoreOp>(loc, newCapacity, capacityField);
-          thenBuilder.create<scf::YieldOp>(loc);
-        });
-
-    Value elementsVal = b.create<memref::LoadOp>(loc, elementsField);
+    Value elementsVal = b.create<memref::LoadOp>(loc, elements);
     b.create<memref::StoreOp>(loc, value, elementsVal,
                               /*indices=*/sizeVal);
 
     Value one = b.create<arith::ConstantIndexOp>(loc, 1);
     Value newSize = b.create<arith::AddIOp>(loc, sizeVal, one);
-
-    b.create<memref::StoreOp>(loc, newSize, sizeField);
-    b.create<func::ReturnOp>(loc);
-
-    return SymbolRefAttr::get(context, funcName);
+    b.create<memref::StoreOp>(loc, newSize, size);
   }
 
-  FlatSymbolRefAttr getOrInsertPopFunction(Location loc, ModuleOp moduleOp,
-                                           OpBuilder &b) {
-    MLIRContext *context = b.getContext();
-    std::string funcName = "__enzyme_pop_";
-    llvm::raw_string_ostream funcStream{funcName};
-    funcStream << elementType;
-    if (moduleOp.lookupSymbol<func::FuncOp>(funcName)) {
-      return SymbolRefAttr::get(context, funcName);
+  Value emitPop(Location loc, OpBuilder &b) const {
+    Value elementsVal = b.create<memref::LoadOp>(loc, elements);
+    Value sizeVal = b.create<memref::LoadOp>(loc, size);
+    if (!isStatic) {
+      Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+      Value pred = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sgt,
+                                           sizeVal, zero);
+      b.create<cf::AssertOp>(loc, pred, "pop on empty cache");
     }
 
-    OpBuilder::InsertionGuard insertionGuard(b);
-    b.setInsertionPointToStart(moduleOp.getBody());
-    auto popFnType = FunctionType::get(
-        context,
-        /*inputs=*/{elements.getType(), size.getType(), capacity.getType()},
-        /*outputs=*/elementType);
-    auto popFn = b.create<func::FuncOp>(loc, funcName, popFnType);
-    popFn.setPrivate();
-    Block *entryBlock = popFn.addEntryBlock();
-    b.setInsertionPointToStart(entryBlock);
-    BlockArgument elementsField = popFn.getArgument(0);
-    BlockArgument sizeField = popFn.getArgument(1);
-
-    Value elementsVal = b.create<memref::LoadOp>(loc, elementsField);
-    Value sizeVal = b.create<memref::LoadOp>(loc, sizeField);
-    Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
-    Value pred =
-        b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sgt, sizeVal, zero);
-    b.create<cf::AssertOp>(loc, pred, "pop on empty cache");
-
     Value one = b.create<arith::ConstantIndexOp>(loc, 1);
     Value newSize = b.create<arith::SubIOp>(loc, sizeVal, one);
-    b.create<memref::StoreOp>(loc, newSize, sizeField);
-
-    Value result = b.create<memref::LoadOp>(loc, elementsVal, newSize);
-    b.create<func::ReturnOp>(loc, result);
-    return SymbolRefAttr::get(context, funcName);
-  }
+    b.create<memref::StoreOp>(loc, newSize, size);
 
-  void emitPush(Location loc, Value value, OpBuilder &b,
-                FlatSymbolRefAttr pushFn) const {
-    b.create<func::CallOp>(
-        loc, pushFn, /*results=*/TypeRange{},
-        /*operands=*/ValueRange{elements, size, capacity, value});
+    return b.create<memref::LoadOp>(loc, elementsVal, newSize);
   }
 
-  Value emitPop(Location loc, OpBuilder &b, FlatSymbolRefAttr popFn) const {
-    return b
-        .create<func::CallOp>(loc, popFn, /*results=*/
-                              elements.getType()
-                                  .cast<ShapedType>()
-                                  .getElementType()
-                                  .cast<ShapedType>()
-                                  .getElementType(),
-                              ValueRange{elements, size, capacity})
-        .getResult(0);
-  }
-
-  FlatSymbolRefAttr getOrInsertGetFunction(Location loc, ModuleOp moduleOp,
-                                           OpBuilder &b) {
-    MLIRContext *context = b.getContext();
-    std::string funcName = "__enzyme_get_";
-    llvm::raw_string_ostream funcStream{funcName};
-    funcStream << elementType;
-    if (moduleOp.lookupSymbol<func::FuncOp>(funcName)) {
-      return SymbolRefAttr::get(context, funcName);
+  Value emitGet(Location loc, OpBuilder &b) const {
+    Value elementsVal = b.create<memref::LoadOp>(loc, elements);
+    Value sizeVal = b.create<memref::LoadOp>(loc, size);
+    if (!isStatic) {
+      Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+      Value pred = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sgt,
+                                           sizeVal, zero);
+      b.create<cf::AssertOp>(loc, pred, "get on empty cache");
     }
 
-    OpBuilder::InsertionGuard insertionGuard(b);
-    b.setInsertionPointToStart(moduleOp.getBody());
-    auto popFnType = FunctionType::get(
-        context,
-        /*inputs=*/{elements.getType(), size.getType(), capacity.getType()},
-        /*outputs=*/elementType);
-    auto popFn = b.create<func::FuncOp>(loc, funcName, popFnType);
-    popFn.setPrivate();
-    Block *entryBlock = popFn.addEntryBlock();
-    b.setInsertionPointToStart(entryBlock);
-    BlockArgument elementsField = popFn.getArgument(0);
-    BlockArgument sizeField = popFn.getArgument(1);
-
-    Value elementsVal = b.create<memref::LoadOp>(loc, elementsField);
-    Value sizeVal = b.create<memref::LoadOp>(loc, sizeField);
-    Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
     Value one = b.create<arith::ConstantIndexOp>(loc, 1);
-    Value pred =
-        b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sgt, sizeVal, zero);
-    b.create<cf::AssertOp>(loc, pred, "get on empty cache");
-
     Value lastIndex = b.create<arith::SubIOp>(loc, sizeVal, one);
-    Value result = b.create<memref::LoadOp>(loc, elementsVal, lastIndex);
-    b.create<func::ReturnOp>(loc, result);
-    return SymbolRefAttr::get(context, funcName);
-  }
-
-  Value emitGet(Location loc, OpBuilder &b, FlatSymbolRefAttr getFn) const {
-    return b
-        .create<func::CallOp>(loc, getFn, /*results=*/
-                              elements.getType()
-                                  .cast<ShapedType>()
-                                  .getElementType()
-                                  .cast<ShapedType>()
-                                  .getElementType(),
-                              ValueRange{elements, size, capacity})
-        .getResult(0);
+    return b.create<memref::LoadOp>(loc, elementsVal, lastIndex);
   }
 
   static llvm::Optional<LoweredCache>
   getFromEnzymeCache(Location loc, TypeConverter *typeConverter,
-                     Value enzymeCache, OpBuilder &b) {
+                     Value enzymeCache, const StaticCapacityMap &capacities,
+                     OpBuilder &b) {
     assert(enzymeCache.getType().isa<enzyme::CacheType>());
     auto cacheType = enzymeCache.getType().cast<enzyme::CacheType>();
     SmallVector<Type> resultTypes;
@@ -213,12 +179,24 @@ struct LoweredCache {
     return LoweredCache{.elements = unpackedCache.getResult(0),
                         .size = unpackedCache.getResult(1),
                         .capacity = unpackedCache.getResult(2),
-                        .elementType = cacheType.getType()};
+                        .elementType = cacheType.getType(),
+                        .isStatic = capacities.count(enzymeCache) != 0};
   }
 };
 
-struct InitOpConversion : public OpConversionPattern<enzyme::InitOp> {
-  using OpConversionPattern::OpConversionPattern;
+/// Base for patterns that need to know which caches have a static capacity.
+template <typename OpTy>
+struct CacheOpConversion : public OpConversionPattern<OpTy> {
+  CacheOpConversion(TypeConverter &typeConverter, MLIRContext *context,
+                    const StaticCapacityMap &capacities)
+      : OpConversionPattern<OpTy>(typeConverter, context),
+        capacities(capacities) {}
+
+  const StaticCapacityMap &capacities;
+};
+
+struct InitOpConversion : public CacheOpConversion<enzyme::InitOp> {
+  using CacheOpConversion::CacheOpConversion;
 
   LogicalResult
   matchAndRewrite(enzyme::InitOp op, OpAdaptor adaptor,
@@ -243,7 +221,14 @@ struct InitOpConversion : public OpConversionPattern<enzyme::InitOp> {
         return failure();
       }
 
-      Value capacity = rewriter.create<arith::ConstantIndexOp>(op.getLoc(), 1);
+      // Caches with a statically known number of pushes are allocated at
+      // their final size, everything else starts small and grows on demand.
+      int64_t initialCapacity = 1;
+      auto found = capacities.find(op.getResult());
+      if (found != capacities.end())
+        initialCapacity = std::max<int64_t>(found->second, 1);
+      Value capacity = rewriter.create<arith::ConstantIndexOp>(
+          op.getLoc(), initialCapacity);
       Value initialSize =
           rewriter.create<arith::ConstantIndexOp>(op.getLoc(), 0);
       auto dataType = resultTypes[0].cast<MemRefType>();
@@ -274,43 +259,39 @@ struct InitOpConversion : public OpConversionPattern<enzyme::InitOp> {
   }
 };
 
-struct PushOpConversion : public OpConversionPattern<enzyme::PushOp> {
-  using OpConversionPattern::OpConversionPattern;
+struct PushOpConversion : public CacheOpConversion<enzyme::PushOp> {
+  using CacheOpConversion::CacheOpConversion;
 
   LogicalResult
   matchAndRewrite(enzyme::PushOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     Location loc = op.getLoc();
     auto loweredCache = LoweredCache::getFromEnzymeCache(
-        loc, getTypeConverter(), op.getCache(), rewriter);
+        loc, getTypeConverter(), op.getCache(), capacities, rewriter);
     if (!loweredCache.has_value()) {
       return failure();
     }
 
-    FlatSymbolRefAttr pushFn = loweredCache.value().getOrInsertPushFunction(
-        loc, op->getParentOfType<ModuleOp>(), rewriter);
-    loweredCache.value().emitPush(loc, op.getValue(), rewriter, pushFn);
+    loweredCache.value().emitPush(loc, op.getValue(), rewriter);
     rewriter.eraseOp(op);
     return success();
   }
 };
 
-struct PopOpConversion : public OpConversionPattern<enzyme::PopOp> {
-  using OpConversionPattern::OpConversionPattern;
+struct PopOpConversion : public CacheOpConversion<enzyme::PopOp> {
+  using CacheOpConversion::CacheOpConversion;
 
   LogicalResult
   matchAndRewrite(enzyme::PopOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     Location loc = op.getLoc();
     auto loweredCache = LoweredCache::getFromEnzymeCache(
-        loc, getTypeConverter(), op.getCache(), rewriter);
+        loc, getTypeConverter(), op.getCache(), capacities, rewriter);
     if (!loweredCache.has_value()) {
       return failure();
     }
 
-    FlatSymbolRefAttr popFn = loweredCache.value().getOrInsertPopFunction(
-        loc, op->getParentOfType<ModuleOp>(), rewriter);
-    rewriter.replaceOp(op, loweredCache.value().emitPop(loc, rewriter, popFn));
+    rewriter.replaceOp(op, loweredCache.value().emitPop(loc, rewriter));
     return success();
   }
 };
@@ -337,8 +318,8 @@ struct SetOpConversion : public OpConversionPattern<enzyme::SetOp> {
   }
 };
 
-struct GetOpConversion : public OpConversionPattern<enzyme::GetOp> {
-  using OpConversionPattern<enzyme::GetOp>::OpConversionPattern;
+struct GetOpConversion : public CacheOpConversion<enzyme::GetOp> {
+  using CacheOpConversion::CacheOpConversion;
 
   LogicalResult
   matchAndRewrite(enzyme::GetOp op, OpAdaptor adaptor,
@@ -347,15 +328,12 @@ struct GetOpConversion : public OpConversionPattern<enzyme::GetOp> {
     if (auto type = dyn_cast<enzyme::CacheType>(op.getGradient().getType())) {
       Location loc = op.getLoc();
       auto loweredCache = LoweredCache::getFromEnzymeCache(
-          loc, getTypeConverter(), op.getGradient(), rewriter);
+          loc, getTypeConverter(), op.getGradient(), capacities, rewriter);
       if (!loweredCache.has_value()) {
         return failure();
       }
 
-      FlatSymbolRefAttr getFn = loweredCache.value().getOrInsertGetFunction(
-          loc, op->getParentOfType<ModuleOp>(), rewriter);
-      rewriter.replaceOp(op,
-                         loweredCache.value().emitGet(loc, rewriter, getFn));
+      rewriter.replaceOp(op, loweredCache.value().emitGet(loc, rewriter));
     } else if (auto type =
                    dyn_cast<enzyme::GradientType>(op.getGradient().getType())) {
       auto memrefType =
@@ -398,11 +376,19 @@ struct EnzymeToMemRefPass
           return success();
         });
 
-    patterns.add<InitOpConversion>(typeConverter, context);
-    patterns.add<PushOpConversion>(typeConverter, context);
-    patterns.add<PopOpConversion>(typeConverter, context);
+    StaticCapacityMap capacities;
+    getOperation()->walk([&](enzyme::InitOp initOp) {
+      if (!initOp.getType().isa<enzyme::CacheType>())
+        return;
+      if (auto capacity = getStaticCacheCapacity(initOp))
+        capacities[initOp.getResult()] = *capacity;
+    });
+
+    patterns.add<InitOpConversion>(typeConverter, context, capacities);
+    patterns.add<PushOpConversion>(typeConverter, context, capacities);
+    patterns.add<PopOpConversion>(typeConverter, context, capacities);
     patterns.add<SetOpConversion>(typeConverter, context);
-    patterns.add<GetOpConversion>(typeConverter, context);
+    patterns.add<GetOpConversion>(typeConverter, context, capacities);
 
     ConversionTarget target(*context);
     target.addLegalDialect<memref::MemRefDialect>();
@@ -49,6 +49,14 @@ namespace memref {
 class MemRefDialect;
 } // end namespace memref
 
+namespace linalg {
+class LinalgDialect;
+} // end namespace linalg
+
+namespace tensor {
+class TensorDialect;
+} // end namespace tensor
+
 namespace func {
 class FuncDialect;
 }
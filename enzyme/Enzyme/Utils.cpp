@@ -89,11 +89,17 @@ llvm::PointerType *getDefaultAnonymousTapeType(llvm::LLVMContext &C) {
   return Type::getInt8PtrTy(C);
 }
 
+/// Create a function which grows \p ptr by powers of two as \p size passes
+/// them, with \p Realloc standing in for realloc if given
 Function *getOrInsertExponentialAllocator(Module &M, Function *newFunc,
-                                          bool ZeroInit, llvm::Type *RT) {
+                                          bool ZeroInit, llvm::Type *RT,
+                                          Function *Realloc) {
   bool custom = true;
   llvm::PointerType *allocType;
-  {
+  if (Realloc) {
+    custom = false;
+    allocType = cast<PointerType>(Realloc->getReturnType());
+  } else {
     auto i64 = Type::getInt64Ty(newFunc->getContext());
     BasicBlock *BB = BasicBlock::Create(M.getContext(), "entry", newFunc);
     IRBuilder<> B(BB);
@@ -115,6 +121,8 @@ Function *getOrInsertExponentialAllocator(Module &M, Function *newFunc,
     name += "zero";
   if (custom)
     name += ".custom@" + std::to_string((size_t)RT);
+  if (Realloc)
+    name += "." + Realloc->getName().str();
 
   FunctionType *FT = FunctionType::get(allocType, types, false);
 
@@ -170,7 +178,10 @@ Function *getOrInsertExponentialAllocator(Module &M, Function *newFunc,
                      ConstantInt::get(next->getType(), 0),
                      B.CreateLShr(next, ConstantInt::get(next->getType(), 1)));
 
-  if (!custom) {
+  if (Realloc) {
+    Value *args[] = {B.CreatePointerCast(ptr, allocType), next};
+    gVal = B.CreateCall(Realloc, args);
+  } else if (!custom) {
     auto reallocF = M.getOrInsertFunction("realloc", allocType, allocType,
                                           Type::getInt64Ty(M.getContext()));
 
@@ -248,7 +259,8 @@ Function *getOrInsertExponentialAllocator(Module &M, Function *newFunc,
 llvm::Value *CreateReAllocation(llvm::IRBuilder<> &B, llvm::Value *prev,
                                 llvm::Type *T, llvm::Value *OuterCount,
                                 llvm::Value *InnerCount, llvm::Twine Name,
-                                llvm::CallInst **caller, bool ZeroMem) {
+                                llvm::CallInst **caller, bool ZeroMem,
+                                llvm::Function *Realloc) {
   auto newFunc = B.GetInsertBlock()->getParent();
 
   Value *tsize = ConstantInt::get(
@@ -265,8 +277,8 @@ llvm::Value *CreateReAllocation(llvm::IRBuilder<> &B, llvm::Value *prev,
                   /*NSW*/ true)};
 
   auto realloccall =
-      B.CreateCall(getOrInsertExponentialAllocator(*newFunc->getParent(),
-                                                   newFunc, ZeroMem, T),
+      B.CreateCall(getOrInsertExponentialAllocator(
+                       *newFunc->getParent(), newFunc, ZeroMem, T, Realloc),
                    idxs, Name);
   if (caller)
     *caller = realloccall;
@@ -99,7 +99,8 @@ llvm::Value *CreateReAllocation(llvm::IRBuilder<> &B, llvm::Value *prev,
                                 llvm::Type *T, llvm::Value *OuterCount,
                                 llvm::Value *InnerCount, llvm::Twine Name = "",
                                 llvm::CallInst **caller = nullptr,
-                                bool ZeroMem = false);
+                                bool ZeroMem = false,
+                                llvm::Function *Realloc = nullptr);
 
 llvm::PointerType *getDefaultAnonymousTapeType(llvm::LLVMContext &C);
 
@@ -0,0 +1,204 @@
+//===- tapearena.h - Runtime for caller provided tape memory -------------===//
+//
+//                             Enzyme Project
+//
+// Part of the Enzyme Project, under the Apache License v2.0 with LLVM
+// Exceptions. See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the runtime used by derivatives compiled with
+// -enzyme-tape-arena. Include it in exactly one translation unit of the
+// program being differentiated.
+//
+// Loop caches and anonymous tapes are carved out of a buffer the caller hands
+// to __enzyme_tape_arena_init rather than malloc'd. The reverse pass releases
+// them in the opposite order they were allocated, so the arena is empty again
+// once a gradient evaluation completes and the same buffer serves the next
+// one. Dynamic trip counts make the size of an evaluation a runtime property:
+// run it once, possibly with no buffer at all, read the size it needed from
+// __enzyme_tape_arena_required and allocate the buffer from that. Requests
+// that do not fit the buffer fall back to malloc, so an undersized arena is
+// only slower.
+//
+// Typical use:
+//
+//   __enzyme_tape_arena_init(NULL, 0);
+//   gradient(...);
+//   size_t size = __enzyme_tape_arena_required();
+//   void *buffer = malloc(size);
+//   __enzyme_tape_arena_init(buffer, size);
+//   for (...)
+//     gradient(...);
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ENZYME_TAPEARENA_H
+#define ENZYME_TAPEARENA_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+#define __ENZYME_THREAD_LOCAL thread_local
+extern "C" {
+#else
+#define __ENZYME_THREAD_LOCAL _Thread_local
+#endif
+
+/// Every block is preceded by a header, aligned as malloc would align it
+struct __enzyme_tape_block {
+  /// Offset of the block below this one within the arena
+  size_t prev;
+  /// Rounded size of the block, with the low bits holding its state
+  size_t size;
+};
+
+#define __ENZYME_ARENA_ALIGN ((size_t)16)
+#define __ENZYME_ARENA_FREED ((size_t)1)
+#define __ENZYME_ARENA_MALLOCED ((size_t)2)
+#define __ENZYME_ARENA_STATE (__ENZYME_ARENA_ALIGN - 1)
+#define __ENZYME_ARENA_NONE ((size_t)-1)
+
+struct __enzyme_tape_arena {
+  char *base;
+  size_t capacity;
+  /// Offset one past the topmost block
+  size_t used;
+  /// Offset of the topmost block
+  size_t top;
+  /// Bytes currently held by blocks that did not fit the arena
+  size_t overflow;
+  size_t required;
+};
+
+static __ENZYME_THREAD_LOCAL struct __enzyme_tape_arena __enzyme_arena = {
+    NULL, 0, 0, __ENZYME_ARENA_NONE, 0, 0};
+
+static size_t __enzyme_tape_arena_round(uint64_t size) {
+  return ((size_t)size + __ENZYME_ARENA_ALIGN - 1) &
+         ~(__ENZYME_ARENA_ALIGN - 1);
+}
+
+static void __enzyme_tape_arena_note(void) {
+  size_t live = __enzyme_arena.used + __enzyme_arena.overflow;
+  if (live > __enzyme_arena.required)
+    __enzyme_arena.required = live;
+}
+
+/// Hand \p buffer of \p size bytes to the arena of the calling thread. Any
+/// tape still allocated must have been released first.
+void __enzyme_tape_arena_init(void *buffer, size_t size) {
+  __enzyme_arena.base = (char *)buffer;
+  __enzyme_arena.capacity = buffer ? size : 0;
+  __enzyme_arena.used = 0;
+  __enzyme_arena.top = __ENZYME_ARENA_NONE;
+  __enzyme_arena.overflow = 0;
+  __enzyme_arena.required = 0;
+}
+
+/// The largest number of bytes live at once since the arena was initialized,
+/// the buffer size which would have served every allocation
+size_t __enzyme_tape_arena_required(void) { return __enzyme_arena.required; }
+
+void *__enzyme_tape_arena_alloc(uint64_t size) {
+  size_t len = __enzyme_tape_arena_round(size);
+  size_t need = sizeof(struct __enzyme_tape_block) + len;
+  struct __enzyme_tape_block *block;
+  if (__enzyme_arena.capacity - __enzyme_arena.used >= need) {
+    block = (struct __enzyme_tape_block *)(__enzyme_arena.base +
+                                           __enzyme_arena.used);
+    block->prev = __enzyme_arena.top;
+    block->size = len;
+    __enzyme_arena.top = __enzyme_arena.used;
+    __enzyme_arena.used += need;
+  } else {
+    block = (struct __enzyme_tape_block *)malloc(need);
+    if (!block) {
+      fprintf(stderr, "enzyme: could not allocate %zu bytes of tape\n", need);
+      abort();
+    }
+    block->prev = __ENZYME_ARENA_NONE;
+    block->size = len | __ENZYME_ARENA_MALLOCED;
+    __enzyme_arena.overflow += need;
+  }
+  __enzyme_tape_arena_note();
+  return block + 1;
+}
+
+void __enzyme_tape_arena_free(void *ptr) {
+  if (!ptr)
+    return;
+  struct __enzyme_tape_block *block = (struct __enzyme_tape_block *)ptr - 1;
+  if (block->size & __ENZYME_ARENA_MALLOCED) {
+    __enzyme_arena.overflow -= sizeof(struct __enzyme_tape_block) +
+                               (block->size & ~__ENZYME_ARENA_STATE);
+    free(block);
+    return;
+  }
+  block->size |= __ENZYME_ARENA_FREED;
+  // Blocks are normally released last to first, anything freed out of order
+  // is reclaimed once the blocks above it are gone
+  while (__enzyme_arena.top != __ENZYME_ARENA_NONE) {
+    struct __enzyme_tape_block *top =
+        (struct __enzyme_tape_block *)(__enzyme_arena.base +
+                                       __enzyme_arena.top);
+    if (!(top->size & __ENZYME_ARENA_FREED))
+      break;
+    __enzyme_arena.used = __enzyme_arena.top;
+    __enzyme_arena.top = top->prev;
+  }
+}
+
+void *__enzyme_tape_arena_realloc(void *ptr, uint64_t size) {
+  if (!ptr)
+    return __enzyme_tape_arena_alloc(size);
+  struct __enzyme_tape_block *block = (struct __enzyme_tape_block *)ptr - 1;
+  size_t len = __enzyme_tape_arena_round(size);
+  size_t old = block->size & ~__ENZYME_ARENA_STATE;
+  if (block->size & __ENZYME_ARENA_MALLOCED) {
+    block = (struct __enzyme_tape_block *)realloc(
+        block, sizeof(struct __enzyme_tape_block) + len);
+    if (!block) {
+      fprintf(stderr, "enzyme: could not grow tape to %zu bytes\n", len);
+      abort();
+    }
+    block->size = len | __ENZYME_ARENA_MALLOCED;
+    __enzyme_arena.overflow += len - old;
+    __enzyme_tape_arena_note();
+    return block + 1;
+  }
+  // The most recent block grows in place, which is the common case of a
+  // single loop cache being extended iteration by iteration
+  if (__enzyme_arena.top != __ENZYME_ARENA_NONE &&
+      (char *)block == __enzyme_arena.base + __enzyme_arena.top &&
+      __enzyme_arena.capacity - __enzyme_arena.top >=
+          sizeof(struct __enzyme_tape_block) + len) {
+    block->size = len;
+    __enzyme_arena.used =
+        __enzyme_arena.top + sizeof(struct __enzyme_tape_block) + len;
+    __enzyme_tape_arena_note();
+    return ptr;
+  }
+  void *next = __enzyme_tape_arena_alloc(size);
+  memcpy(next, ptr, old < len ? old : len);
+  __enzyme_tape_arena_free(ptr);
+  return next;
+}
+
+#undef __ENZYME_ARENA_NONE
+#undef __ENZYME_ARENA_STATE
+#undef __ENZYME_ARENA_MALLOCED
+#undef __ENZYME_ARENA_FREED
+#undef __ENZYME_ARENA_ALIGN
+
+#ifdef __cplusplus
+}
+#endif
+
+#undef __ENZYME_THREAD_LOCAL
+
+#endif // ENZYME_TAPEARENA_H
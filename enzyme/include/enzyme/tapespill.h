@@ -0,0 +1,119 @@
+//===- tapespill.h - Runtime for out-of-core loop caches ------------------===//
+//
+//                             Enzyme Project
+//
+// Part of the Enzyme Project, under the Apache License v2.0 with LLVM
+// Exceptions. See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the runtime used by derivatives compiled with
+// -enzyme-out-of-core-cache. Include it in exactly one translation unit of
+// the program being differentiated.
+//
+// Each loop cache is a shared mapping of an unlinked temporary file in
+// $ENZYME_SPILL_DIR (or $TMPDIR, or /tmp). Values written in the forward pass
+// are flushed to the file by the kernel's asynchronous writeback, so the
+// resident size of the cache is bounded by the page cache rather than by the
+// number of iterations. The reverse pass reads the cache from its end and
+// calls __enzyme_spill_prefetch on every lookup. On entering a chunk it asks
+// for the preceding chunk to be read ahead and releases the chunk it left.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ENZYME_TAPESPILL_H
+#define ENZYME_TAPESPILL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef ENZYME_SPILL_CHUNK
+/// Granularity of read ahead in the reverse pass, a multiple of the page size
+#define ENZYME_SPILL_CHUNK (1UL << 22)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The first page of every mapping holds its length, the cache itself starts
+/// on the following page. The page size is queried once, as this is called
+/// on every lookup in the reverse pass.
+static size_t __enzyme_spill_header(void) {
+  static size_t pagesize = 0;
+  if (!pagesize)
+    pagesize = (size_t)sysconf(_SC_PAGESIZE);
+  return pagesize;
+}
+
+void *__enzyme_spill_alloc(uint64_t size) {
+  const char *dir = getenv("ENZYME_SPILL_DIR");
+  if (!dir)
+    dir = getenv("TMPDIR");
+  if (!dir)
+    dir = "/tmp";
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/enzyme-tape-XXXXXX", dir);
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("enzyme: could not create tape file");
+    abort();
+  }
+  unlink(path);
+  size_t len = __enzyme_spill_header() + size;
+  if (ftruncate(fd, (off_t)len) != 0) {
+    perror("enzyme: could not size tape file");
+    abort();
+  }
+  char *base =
+      (char *)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == (char *)MAP_FAILED) {
+    perror("enzyme: could not map tape file");
+    abort();
+  }
+  *(size_t *)base = len;
+  return base + __enzyme_spill_header();
+}
+
+void __enzyme_spill_free(void *ptr) {
+  char *base = (char *)ptr - __enzyme_spill_header();
+  munmap(base, *(size_t *)base);
+}
+
+void __enzyme_spill_prefetch(void *ptr, void *elem, uint64_t elemsize) {
+  char *start = (char *)ptr;
+  size_t off = (size_t)((char *)elem - start);
+  size_t size = *(size_t *)(start - __enzyme_spill_header()) -
+                __enzyme_spill_header();
+  size_t chunk = off / ENZYME_SPILL_CHUNK;
+  int last = off + elemsize >= size;
+  // Only act on the first lookup within a chunk, which is its last element
+  if (!last && off % ENZYME_SPILL_CHUNK < ENZYME_SPILL_CHUNK - elemsize)
+    return;
+  if (last)
+    madvise(start + chunk * ENZYME_SPILL_CHUNK,
+            size - chunk * ENZYME_SPILL_CHUNK, MADV_WILLNEED);
+  if (chunk > 0)
+    madvise(start + (chunk - 1) * ENZYME_SPILL_CHUNK, ENZYME_SPILL_CHUNK,
+            MADV_WILLNEED);
+  // The file keeps the contents of a shared mapping, dropping the chunk above
+  // only gives back its pages
+  size_t above = (chunk + 1) * ENZYME_SPILL_CHUNK;
+  if (above < size) {
+    size_t len = size - above;
+    if (len > ENZYME_SPILL_CHUNK)
+      len = ENZYME_SPILL_CHUNK;
+    madvise(start + above, len, MADV_DONTNEED);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENZYME_TAPESPILL_H
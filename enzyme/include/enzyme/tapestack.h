@@ -0,0 +1,147 @@
+//===- tapestack.h - Runtime for the tapes of recursive calls -------------===//
+//
+//                             Enzyme Project
+//
+// Part of the Enzyme Project, under the Apache License v2.0 with LLVM
+// Exceptions. See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the runtime used by derivatives compiled with
+// -enzyme-tape-stack. Include it in exactly one translation unit of the
+// program being differentiated.
+//
+// Every augmented call of a recursive function pushes its tape onto a thread
+// local stack and the derivative consuming that tape pops it when it returns.
+// Derivatives usually run in the reverse order of the augmented calls they
+// belong to, but tapes reached from a split mode tape are consumed in whatever
+// order the user calls the reverse passes. Popping a frame therefore only marks
+// it released, and the stack shrinks past the released frames at its top. The
+// stack grows by segments which are kept for reuse, so frames never move and
+// steady state evaluations do not call malloc at all.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ENZYME_TAPESTACK_H
+#define ENZYME_TAPESTACK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef ENZYME_TAPE_STACK_SEGMENT
+/// Minimum number of bytes allocated whenever the stack needs a new segment
+#define ENZYME_TAPE_STACK_SEGMENT (1UL << 20)
+#endif
+
+#ifdef __cplusplus
+#define __ENZYME_THREAD_LOCAL thread_local
+extern "C" {
+#else
+#define __ENZYME_THREAD_LOCAL _Thread_local
+#endif
+
+struct __enzyme_tape_segment {
+  struct __enzyme_tape_segment *prev;
+  struct __enzyme_tape_segment *next;
+  size_t capacity;
+  size_t used;
+  /// Offset of the topmost frame within the segment, if used is nonzero
+  size_t last;
+};
+
+struct __enzyme_tape_frame {
+  /// Offset of the frame below this one within the same segment
+  size_t prev;
+  size_t released;
+};
+
+/// Frames are aligned as malloc would align them
+#define __ENZYME_TAPE_ALIGN 16
+#define __ENZYME_TAPE_ROUND(size)                                              \
+  (((size) + __ENZYME_TAPE_ALIGN - 1) & ~(size_t)(__ENZYME_TAPE_ALIGN - 1))
+#define __ENZYME_TAPE_HEADER                                                   \
+  __ENZYME_TAPE_ROUND(sizeof(struct __enzyme_tape_segment))
+#define __ENZYME_TAPE_FRAME                                                    \
+  __ENZYME_TAPE_ROUND(sizeof(struct __enzyme_tape_frame))
+
+static __ENZYME_THREAD_LOCAL struct __enzyme_tape_segment *__enzyme_tape_top;
+
+static struct __enzyme_tape_frame *
+__enzyme_tape_frame_at(struct __enzyme_tape_segment *seg, size_t offset) {
+  return (struct __enzyme_tape_frame *)((char *)seg + __ENZYME_TAPE_HEADER +
+                                        offset);
+}
+
+void *__enzyme_tape_push(uint64_t size) {
+  size = __ENZYME_TAPE_FRAME + __ENZYME_TAPE_ROUND(size);
+  struct __enzyme_tape_segment *seg = __enzyme_tape_top;
+  if (!seg || seg->capacity - seg->used < size) {
+    struct __enzyme_tape_segment *next = seg ? seg->next : NULL;
+    if (!next || next->capacity < size) {
+      // Segments above the top are only kept for reuse, drop those too small
+      while (next) {
+        struct __enzyme_tape_segment *above = next->next;
+        free(next);
+        next = above;
+      }
+      size_t capacity =
+          size > ENZYME_TAPE_STACK_SEGMENT ? size : ENZYME_TAPE_STACK_SEGMENT;
+      next = (struct __enzyme_tape_segment *)malloc(__ENZYME_TAPE_HEADER +
+                                                    capacity);
+      if (!next) {
+        fprintf(stderr, "enzyme: could not grow tape stack by %zu bytes\n",
+                capacity);
+        abort();
+      }
+      next->prev = seg;
+      next->next = NULL;
+      next->capacity = capacity;
+      if (seg)
+        seg->next = next;
+    }
+    next->used = 0;
+    next->last = 0;
+    __enzyme_tape_top = seg = next;
+  }
+  struct __enzyme_tape_frame *frame = __enzyme_tape_frame_at(seg, seg->used);
+  frame->prev = seg->last;
+  frame->released = 0;
+  seg->last = seg->used;
+  seg->used += size;
+  return (char *)frame + __ENZYME_TAPE_FRAME;
+}
+
+void __enzyme_tape_pop(void *ptr) {
+  struct __enzyme_tape_frame *frame =
+      (struct __enzyme_tape_frame *)((char *)ptr - __ENZYME_TAPE_FRAME);
+  frame->released = 1;
+  // Frames below the top stay allocated until everything above them is gone
+  struct __enzyme_tape_segment *seg = __enzyme_tape_top;
+  while (seg) {
+    while (seg->used) {
+      struct __enzyme_tape_frame *top = __enzyme_tape_frame_at(seg, seg->last);
+      if (!top->released)
+        return;
+      seg->used = seg->last;
+      seg->last = top->prev;
+    }
+    if (!seg->prev)
+      return;
+    __enzyme_tape_top = seg = seg->prev;
+  }
+}
+
+#undef __ENZYME_TAPE_FRAME
+#undef __ENZYME_TAPE_HEADER
+#undef __ENZYME_TAPE_ROUND
+#undef __ENZYME_TAPE_ALIGN
+
+#ifdef __cplusplus
+}
+#endif
+
+#undef __ENZYME_THREAD_LOCAL
+
+#endif // ENZYME_TAPESTACK_H
@@ -55,14 +55,14 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK-DAG:   %[[dsum:.+]] = phi {{(fast )?}}double [ %[[i4:.+]], %end ], [ 0.000000e+00, %entry ]
 ; CHECK-NEXT:   %iv.next = add nuw nsw i64 %iv, 1
 ; CHECK-NEXT:   %[[i1:.+]] = getelementptr inbounds i1*, i1** %truetape, i64 %iv
-; CHECK-NEXT:   %.pre = load i1*, i1** %[[i1]], align 8, !invariant.group !1
+; CHECK-NEXT:   %.pre = load i1*, i1** %[[i1]], align 8, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   br label %body
 
 ; CHECK: body:                                             ; preds = %body, %loop
 ; CHECK-NEXT:   %iv1 = phi i64 [ %iv.next2, %body ], [ 0, %loop ]
 ; CHECK-NEXT:   %iv.next2 = add nuw nsw i64 %iv1, 1
 ; CHECK-NEXT:   %[[i2:.+]] = getelementptr inbounds i1, i1* %.pre, i64 %iv1
-; CHECK-NEXT:   %cmp = load i1, i1* %[[i2]], align 1, !invariant.group !2
+; CHECK-NEXT:   %cmp = load i1, i1* %[[i2]], align 1, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   br i1 %cmp, label %body, label %end
 
 ; CHECK: end:                                              ; preds = %body
@@ -86,7 +86,7 @@ attributes #3 = { nounwind }
 ; CHECK-NEXT:   %"call'ipg" = getelementptr inbounds double, double* %[[matil_phi]], i64 %iv
 ; CHECK-NEXT:   %[[i2:.+]] = load double, double* %"call'ipg", align 8
 ; CHECK-NEXT:   %[[i1:.+]] = getelementptr inbounds double, double* %0, i64 %iv
-; CHECK-NEXT:   %ld = load double, double* %[[i1]], align 8, !invariant.group !
+; CHECK-NEXT:   %ld = load double, double* %[[i1]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %[[i3:.+]] = fmul fast double %[[i2]], %ld
 ; CHECK-NEXT:   %[[i4:.+]] = fmul fast double %[[i2]], %ld
 ; CHECK-NEXT:   %[[i5:.+]] = fadd fast double %[[i3]], %[[i4]]
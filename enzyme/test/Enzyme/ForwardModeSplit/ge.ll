@@ -86,7 +86,7 @@ attributes #3 = { nounwind }
 ; CHECK-NEXT:   %"arrayidx'ipg" = getelementptr inbounds double, double* %"x'", i64 %idxprom
 ; CHECK-NEXT:   %[[i4:.+]] = load double, double* %"arrayidx'ipg", align 8
 ; CHECK-NEXT:   %[[i2:.+]] = getelementptr inbounds double, double* %truetape, i64 %iv
-; CHECK-NEXT:   %[[i3:.+]] = load double, double* %[[i2]], align 8, !invariant.group !
+; CHECK-NEXT:   %[[i3:.+]] = load double, double* %[[i2]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %[[i5:.+]] = fmul fast double %[[i4]], %[[i3]]
 ; CHECK-NEXT:   %[[i6:.+]] = fadd fast double %[[i5]], %[[i5]]
 ; CHECK-NEXT:   %[[i7]] = fadd fast double %[[sum012]], %[[i6]]
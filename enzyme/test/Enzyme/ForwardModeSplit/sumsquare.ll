@@ -48,7 +48,7 @@ attributes #2 = { nounwind }
 ; CHECK-NEXT:   %"arrayidx'ipg.i" = getelementptr inbounds double, double* %xp, i64 %iv.i
 ; CHECK-NEXT:   %[[i3:.+]] = load double, double* %"arrayidx'ipg.i", align 8
 ; CHECK-NEXT:   %[[i1:.+]] = getelementptr inbounds double, double* %truetape.i, i64 %iv.i
-; CHECK-NEXT:   %[[i2:.+]] = load double, double* %[[i1]], align 8, !invariant.group !{{[0-9]+}}
+; CHECK-NEXT:   %[[i2:.+]] = load double, double* %[[i1]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %[[i4:.+]] = fmul fast double %[[i3]], %[[i2]]
 ; CHECK-NEXT:   %[[i5:.+]] = fadd fast double %[[i4]], %[[i4]]
 ; CHECK-NEXT:   %[[i6]] = fadd fast double %[[i5]], %[[total011]]
@@ -53,7 +53,7 @@ attributes #0 = { noinline nounwind uwtable }
 ; CHECK-DAG:   %iv = phi i64 [ %iv.next, %if.end ], [ 0, %entry ]
 ; CHECK-DAG:   %[[data016:.+]] = phi {{(fast )?}}double [ %[[i5:.+]], %if.end ], [ 0.000000e+00, %entry ]
 ; CHECK-NEXT:   %[[i1:.+]] = getelementptr inbounds i1, i1* %truetape, i64 %iv
-; CHECK-NEXT:   %cmp2 = load i1, i1* %[[i1]], align 1, !invariant.group !{{[0-9]+}}
+; CHECK-NEXT:   %cmp2 = load i1, i1* %[[i1]], align 1, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   br i1 %cmp2, label %if.then, label %if.end
 
 ; CHECK: if.then:                                          ; preds = %for.body
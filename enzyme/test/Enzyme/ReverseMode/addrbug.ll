@@ -78,7 +78,7 @@ exit:                                             ; preds = %L50
 ; CHECK: invertL1e:                                        ; preds = %top, %incinvertL1
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ 9, %top ], [ %2, %incinvertL1 ]
 ; CHECK-NEXT:   %.phi.trans.insert = getelementptr inbounds double, double* %ld_malloccache, i64 %"iv'ac.0"
-; CHECK-NEXT:   %.pre = load double, double* %.phi.trans.insert, align 8, !invariant.group !
+; CHECK-NEXT:   %.pre = load double, double* %.phi.trans.insert, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %"gep'ipg_unwrap.phi.trans.insert" = getelementptr inbounds double, double addrspace(1)* %"in'", i64 %"iv'ac.0"
 ; CHECK-NEXT:   %[[pre5]] = load double, double addrspace(1)* %"gep'ipg_unwrap.phi.trans.insert", align 8
 ; CHECK-NEXT:   br label %invertL50
@@ -46,9 +46,9 @@ declare dso_local noalias nonnull i8* @_Znwm(i64)
 ; CHECK-NEXT:   %call6.i.i = extractvalue { { i8*, i8* }, double*, double* } %call6.i.i_augmented, 1
 ; CHECK-NEXT:   %"call6.i.i'ac" = extractvalue { { i8*, i8* }, double*, double* } %call6.i.i_augmented, 2
 ; CHECK-NEXT:   store double %v, double* %call6.i.i, align 8, !alias.scope !0, !noalias !3
-; CHECK-NEXT:   %0 = load double, double* %"call6.i.i'ac", align 8, !alias.scope !3, !noalias !0
+; CHECK-NEXT:   %0 = load double, double* %"call6.i.i'ac", align 8, !alias.scope !3, !noalias ![[CNA:[0-9]+]]
 ; CHECK-NEXT:   %1 = fadd fast double %0, %differeturn
-; CHECK-NEXT:   store double 0.000000e+00, double* %"call6.i.i'ac", align 8, !alias.scope !3, !noalias !0
+; CHECK-NEXT:   store double 0.000000e+00, double* %"call6.i.i'ac", align 8, !alias.scope !3, !noalias ![[CNA]]
 ; CHECK-NEXT:   call void @diffe_ZNSt16allocator_traitsISaIdEE8allocateERS0_m(i64 1, { i8*, i8* } %subcache)
 ; CHECK-NEXT:   %2 = insertvalue { double } {{(undef|poison)}}, double %1, 0
 ; CHECK-NEXT:   ret { double } %2
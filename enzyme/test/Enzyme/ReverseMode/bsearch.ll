@@ -93,7 +93,7 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK: invertend:                                        ; preds = %end, %incinvertloop
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %2, %incinvertloop ], [ 9, %end ]
 ; CHECK-NEXT:   %5 = getelementptr inbounds i64, i64* %loopLimit_malloccache, i64 %"iv'ac.0"
-; CHECK-NEXT:   %6 = load i64, i64* %5, align 8, !invariant.group !{{[0-9]+}}
+; CHECK-NEXT:   %6 = load i64, i64* %5, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %"gep2'ipg_unwrap" = getelementptr inbounds double, double* %"x'", i64 %6
 ; CHECK-NEXT:   %7 = load double, double* %"gep2'ipg_unwrap", align 8
 ; CHECK-NEXT:   %8 = fadd fast double %7, %differeturn
@@ -71,7 +71,7 @@ attributes #1 = { noinline nounwind uwtable }
 
 ; CHECK: end:                                              ; preds = %body
 ; CHECK-NEXT:   %0 = getelementptr inbounds i64, i64* %"idx!manual_lcssa_malloccache", i64 %iv
-; CHECK-NEXT:   store i64 %idx, i64* %0, align 8, !invariant.group ![[ig0:[0-9]+]]
+; CHECK-NEXT:   store i64 %idx, i64* %0, align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig0:[0-9]+]]
 ; CHECK-NEXT:   %cmp2 = icmp ne i64 %iv.next, 10
 ; CHECK-NEXT:   br i1 %cmp2, label %loop, label %invertend
 
@@ -100,7 +100,7 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK: invertend:                                        ; preds = %end, %incinvertloop
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %3, %incinvertloop ], [ 9, %end ]
 ; CHECK-NEXT:   %6 = getelementptr inbounds i64, i64* %"idx!manual_lcssa_malloccache", i64 %"iv'ac.0"
-; CHECK-NEXT:   %7 = load i64, i64* %6, align 8, !invariant.group ![[ig0]]
+; CHECK-NEXT:   %7 = load i64, i64* %6, align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig0]]
 ; CHECK-NEXT:   %"gep2'ipg_unwrap" = getelementptr inbounds double, double* %"x'", i64 %7
 ; CHECK-NEXT:   %8 = load double, double* %"gep2'ipg_unwrap", align 8
 ; CHECK-NEXT:   %9 = fadd fast double %8, %differeturn
@@ -0,0 +1,48 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-cache-fp-width=32 -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @prod(double* nocapture readonly %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %p = phi double [ 1.000000e+00, %entry ], [ %m, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %a = load double, double* %gep, align 8
+  %m = fmul double %p, %a
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %m
+}
+
+define void @dprod(double* %x, double* %dx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; CHECK: define internal void @diffeprod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = add i64 %n, -1
+; CHECK-NEXT:   %mallocsize = mul nuw nsw i64 %n, 4
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull i8* @malloc(i64 %mallocsize), !enzyme_cache_alloc
+; CHECK-NEXT:   %p_malloccache = bitcast i8* %malloccall to float*
+; CHECK-NEXT:   br label %loop
+
+; CHECK: loop:
+; CHECK-NEXT:   %iv = phi i64 [ %iv.next, %loop ], [ 0, %entry ]
+; CHECK-NEXT:   %p = phi double [ 1.000000e+00, %entry ], [ %m, %loop ]
+; CHECK-NEXT:   %1 = getelementptr inbounds float, float* %p_malloccache, i64 %iv
+; CHECK-NEXT:   %2 = fptrunc double %p to float
+; CHECK-NEXT:   store float %2, float* %1, align 4, !alias.scope ![[SCOPE:[0-9]+]], !invariant.group ![[INVG:[0-9]+]]
+
+; CHECK: invertloop:
+; CHECK:   %3 = getelementptr inbounds float, float* %p_malloccache, i64 %"iv'ac.0"
+; CHECK-NEXT:   %4 = load float, float* %3, align 4, !alias.scope ![[SCOPE]], !invariant.group ![[INVG]]
+; CHECK-NEXT:   %5 = fpext float %4 to double
+; CHECK-NEXT:   %m1diffea = fmul fast double %"m'de.0", %5
@@ -0,0 +1,58 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-cache-fp-width=16 -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @prod(double* nocapture readonly %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %p = phi double [ 1.000000e+00, %entry ], [ %m, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %a = load double, double* %gep, align 8
+  %m = fmul double %p, %a
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %m
+}
+
+define void @dprod(double* %x, double* %dx, i64 %n) {
+entry:
+  %t = call { i8*, double } (i8*, ...) @__enzyme_augmentfwd(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n)
+  %tape = extractvalue { i8*, double } %t, 0
+  call void (i8*, ...) @__enzyme_reverse(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n, double 1.0, i8* %tape)
+  ret void
+}
+
+declare { i8*, double } @__enzyme_augmentfwd(i8*, ...)
+declare void @__enzyme_reverse(i8*, ...)
+
+; CHECK: define internal { i8*, double } @augmented_prod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n)
+; CHECK:   %tapemem = bitcast i8* %malloccall1 to { half*, half* }*
+; CHECK:   %mallocsize = mul nuw nsw i64 %n, 2
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull i8* @malloc(i64 %mallocsize)
+; CHECK-NEXT:   %p_malloccache = bitcast i8* %malloccall to half*
+
+; CHECK: loop:
+; CHECK:   %4 = getelementptr inbounds half, half* %p_malloccache, i64 %iv
+; CHECK-NEXT:   %5 = fptrunc double %p to half
+; CHECK-NEXT:   store half %5, half* %4, align 2
+
+; CHECK: define internal void @diffeprod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn, i8* %tapeArg)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = bitcast i8* %tapeArg to { half*, half* }*
+; CHECK-NEXT:   %truetape = load { half*, half* }, { half*, half* }* %0, align 8
+
+; CHECK: invertloop:
+; CHECK:   %6 = extractvalue { half*, half* } %truetape, 1
+; CHECK-NEXT:   %7 = getelementptr inbounds half, half* %6, i64 %"iv'ac.0"
+; CHECK-NEXT:   %8 = load half, half* %7, align 2
+; CHECK-NEXT:   %9 = fpext half %8 to double
+; CHECK-NEXT:   %m0diffep = fmul fast double %"m'de.0", %9
+; CHECK-NEXT:   %10 = extractvalue { half*, half* } %truetape, 0
+; CHECK-NEXT:   %11 = getelementptr inbounds half, half* %10, i64 %"iv'ac.0"
+; CHECK-NEXT:   %12 = load half, half* %11, align 2
+; CHECK-NEXT:   %13 = fpext half %12 to double
+; CHECK-NEXT:   %m1diffea = fmul fast double %"m'de.0", %13
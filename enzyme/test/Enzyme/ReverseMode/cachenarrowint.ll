@@ -0,0 +1,50 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-cache-narrow-int -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* nocapture readonly %x, i64* nocapture readonly %idx, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %res, %loop ]
+  %ip = getelementptr inbounds i64, i64* %idx, i64 %i
+  %raw = load i64, i64* %ip, align 8
+  %j = and i64 %raw, 65535
+  %gep = getelementptr inbounds double, double* %x, i64 %j
+  %a = load double, double* %gep, align 8
+  %m = fmul double %a, %a
+  %res = fadd double %acc, %m
+  store i64 0, i64* %ip, align 8
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %res
+}
+
+define void @df(double* %x, double* %dx, i64* %idx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64*, i64)* @f to i8*), double* %x, double* %dx, i64* %idx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; The masked index is known to fit in 16 bits and is cached as an i16.
+
+; CHECK: define internal void @diffef(double* nocapture readonly %x, double* nocapture %"x'", i64* nocapture readonly %idx, i64 %n, double %differeturn)
+; CHECK:   %mallocsize5 = mul nuw nsw i64 %n, 2
+; CHECK-NEXT:   %malloccall6 = tail call noalias nonnull i8* @malloc(i64 %mallocsize5)
+; CHECK-NEXT:   %j_malloccache = bitcast i8* %malloccall6 to i16*
+
+; CHECK: loop:
+; CHECK:   %1 = getelementptr inbounds i16, i16* %j_malloccache, i64 %iv
+; CHECK-NEXT:   %2 = trunc i64 %j to i16
+; CHECK-NEXT:   store i16 %2, i16* %1, align 2
+
+; CHECK: invertloop:
+; CHECK:   %7 = getelementptr inbounds i16, i16* %j_malloccache, i64 %"iv'ac.0"
+; CHECK-NEXT:   %8 = load i16, i16* %7, align 2
+; CHECK-NEXT:   %9 = zext i16 %8 to i64
+; CHECK-NEXT:   %"gep'ipg_unwrap" = getelementptr inbounds double, double* %"x'", i64 %9
@@ -376,7 +376,7 @@ attributes #22 = { readnone speculatable }
 ; CHECK-NEXT:   %[[iv54:.+]] = mul {{(nuw )?}}nsw i64 %"iv3'ac.0", 4
 ; CHECK-NEXT:   %[[iv35a:.+]] = add {{(nuw )?}}nsw i64 %"iv5'ac.0", %[[iv54]]
 ; CHECK-NEXT:   %[[bcq:.+]] = getelementptr inbounds double, double* %[[malloccache]], i64 %[[iv35a]]
-; CHECK-NEXT:   %[[unwrap13:.+]] = load double, double* %[[bcq]], align 8, !invariant.group !
+; CHECK-NEXT:   %[[unwrap13:.+]] = load double, double* %[[bcq]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %m0diffe = fmul fast double %[[fad]], %[[unwrap13]]
 ; CHECK-NEXT:   %[[m2a:.+]] = fadd fast double %m0diffe, %m0diffe
 ; CHECK-NEXT:   %[[dessa:.+]] = bitcast double %[[m2a]] to i64
@@ -413,7 +413,7 @@ attributes #22 = { readnone speculatable }
 ; CHECK-NEXT:   %arrayidx.i.i.i = getelementptr inbounds double, double* %a3, i64 %mul.i.i.i
 ; CHECK-NEXT:   %a6 = load double, double* %arrayidx.i.i.i, align 8, !tbaa !2
 ; CHECK-NEXT:   %[[a6gep:.+]] = getelementptr inbounds double, double* %a6_malloccache, i64 %iv
-; CHECK-NEXT:   store double %a6, double* %[[a6gep]], align 8, !tbaa !2, !invariant.group ![[iga6:[0-9]+]]
+; CHECK-NEXT:   store double %a6, double* %[[a6gep]], align 8, !tbaa !2, !alias.scope !{{[0-9]+}}, !invariant.group ![[iga6:[0-9]+]]
 ; CHECK-NEXT:   %mul.i.i8 = fmul double %a6, %a6
 ; CHECK-NEXT:   %add.i = fadd double %res.0, %mul.i.i8
 ; CHECK-NEXT:   %cmp = icmp ne i64 %iv.next, 4
@@ -563,7 +563,7 @@ attributes #22 = { readnone speculatable }
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %[[inciv:.+]], %incinvertfor.body ], [ 3, %for.body ]
 ; CHECK-NEXT:   %[[ge1:.+]] = getelementptr inbounds double, double* %tapeArg, i64 %"iv'ac.0"
 ; TODO make this use iga6
-; CHECK-NEXT:   %[[loc:.+]] = load double, double* %[[ge1]], align 8, !tbaa !2, !invariant.group ![[iga6_other:[0-9]+]]
+; CHECK-NEXT:   %[[loc:.+]] = load double, double* %[[ge1]], align 8, !tbaa !2, !alias.scope !{{[0-9]+}}, !invariant.group ![[iga6_other:[0-9]+]]
 ; CHECK-NEXT:   %m0diffea6 = fmul fast double %differeturn, %[[loc]]
 ; CHECK-NEXT:   %[[adx:.+]] = fadd fast double %m0diffea6, %m0diffea6
 ; CHECK-NEXT:   %mul.i.i.i_unwrap = mul nsw i64 4, %"iv'ac.0"
@@ -134,11 +134,11 @@ attributes #9 = { nounwind }
 ; CHECK-NEXT:   %"a6'ipc_unwrap" = bitcast i8* %"a5'mi" to double*
 ; CHECK-NEXT:   call void @diffef(double* %a6_unwrap, double* %"a6'ipc_unwrap", double %2)
 ; CHECK-NEXT:   %3 = load double, double* %"a6'ipc_unwrap", align 8, !alias.scope ![[scope16:[0-9]+]], !noalias ![[scope10:[0-9]+]]
-; CHECK-NEXT:   store double 0.000000e+00, double* %"a6'ipc_unwrap", align 8, !alias.scope ![[scope16]], !noalias ![[scope10]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"a6'ipc_unwrap", align 8, !alias.scope ![[scope16]], !noalias !{{[0-9]+}}
 ; CHECK-NEXT:   %"a10'ipg_unwrap" = getelementptr inbounds double, double* %"a1'", i32 %_unwrap
 ; CHECK-NEXT:   %4 = load double, double* %"a10'ipg_unwrap", align 8, !alias.scope ![[scope21:[0-9]+]], !noalias ![[scope24:[0-9]+]]
 ; CHECK-NEXT:   %5 = fadd fast double %4, %3
-; CHECK-NEXT:   store double %5, double* %"a10'ipg_unwrap", align 8, !alias.scope ![[scope21]], !noalias ![[scope24]]
+; CHECK-NEXT:   store double %5, double* %"a10'ipg_unwrap", align 8, !alias.scope ![[scope21]], !noalias !{{[0-9]+}}
 ; CHECK-NEXT:   call void @llvm.memset.p0i8.i64(i8* %"a5'mi", i8 0, i64 8, i1 false)
 ; CHECK-NEXT:   tail call void @free(i8* nonnull %"a5'mi")
 ; CHECK-NEXT:   tail call void @free(i8* %remat_a5)
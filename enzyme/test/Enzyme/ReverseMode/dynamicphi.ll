@@ -61,7 +61,7 @@ attributes #1 = { noinline nounwind uwtable }
 
 ; CHECK: for.outerbody.loopexit:
 ; CHECK-NEXT:   %0 = getelementptr inbounds i64, i64* %[[loopLimit_realloccast:.+]], i64 %iv
-; CHECK-NEXT:   store i64 %iv1, i64* %0, align 8, !invariant.group !0
+; CHECK-NEXT:   store i64 %iv1, i64* %0, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   br label %for.outerbody
 
 ; CHECK: for.outerbody: 
@@ -170,9 +170,9 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK: incinvertfor.outerbody:                           ; preds = %invertfor.outerbody
 ; CHECK-NEXT:   %[[a11]] = add nsw i64 %"iv'ac.0", -1
 ; CHECK-NEXT:   %[[a12:.+]] = getelementptr inbounds i64, i64* %[[loopLimit_realloccast]], i64 %[[a11]]
-; CHECK-NEXT:   %[[a13:.+]] = load i64, i64* %[[a12]], align 8, !invariant.group !0
+; CHECK-NEXT:   %[[a13:.+]] = load i64, i64* %[[a12]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %.phi.trans.insert = getelementptr inbounds double*, double** %[[phi_realloccast]], i64 %[[a11]]
-; CHECK-NEXT:   %[[pre6:.+]] = load double*, double** %.phi.trans.insert, align 8, !invariant.group !2
+; CHECK-NEXT:   %[[pre6:.+]] = load double*, double** %.phi.trans.insert, align 8, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   br label %invertfor.body
 
 ; CHECK: invertfor.body.ph:                                ; preds = %invertfor.body
@@ -188,7 +188,7 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK-NEXT:   %"iv1'ac.0" = phi i64 [ %[[a13]], %incinvertfor.outerbody ], [ %[[a22:.+]], %incinvertfor.body ]
 ; CHECK-NEXT:   %[[a16]] = fadd fast double %"innersum'de.1", %"add'de.1"
 ; CHECK-NEXT:   %[[a17:.+]] = getelementptr inbounds double, double* %[[pre6]], i64 %"iv1'ac.0"
-; CHECK-NEXT:   %[[a18:.+]] = load double, double* %[[a17]], align 8, !invariant.group !1
+; CHECK-NEXT:   %[[a18:.+]] = load double, double* %[[a17]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %m0diffephi = fmul fast double %"add'de.1", %[[a18]]
 ; CHECK-NEXT:   %[[a19:.+]] = fadd fast double %"phiadd'de.1", %m0diffephi
 ; CHECK-NEXT:   %[[a20]] = fadd fast double %[[a19]], %m0diffephi
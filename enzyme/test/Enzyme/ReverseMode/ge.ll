@@ -105,7 +105,7 @@ attributes #3 = { nounwind }
 ; SHARED:   %"add'de.0" = phi double [ %differeturn, %for.cond.cleanup ], [ %"add'de.0", %incinvertfor.body ]
 ; SHARED:   %"iv'ac.0" = phi i64 [ %[[a1]], %for.cond.cleanup ], [ %[[a12:.+]], %incinvertfor.body ]
 ; SHARED-NEXT:   %[[a6:.+]] = getelementptr inbounds double, double* %_malloccache, i64 %"iv'ac.0"
-; SHARED-NEXT:   %[[a7:.+]] = load double, double* %[[a6]], align 8, {{(!tbaa !2, )?}}!invariant.group !
+; SHARED-NEXT:   %[[a7:.+]] = load double, double* %[[a6]], align 8, {{(!tbaa !2, )?}}!alias.scope !{{[0-9]+}}, !invariant.group !
 ; SHARED-NEXT:   %m0diffe = fmul fast double %"add'de.0", %[[a7]]
 ; SHARED-NEXT:   %[[a8:.+]] = fadd fast double %m0diffe, %m0diffe
 ; SHARED-NEXT:   %[[unwrap:.+]] = trunc i64 %"iv'ac.0" to i32
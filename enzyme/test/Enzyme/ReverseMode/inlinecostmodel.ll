@@ -0,0 +1,63 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-inline-cost-model -enzyme-inline-threshold=8 -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+
+define double @square(double %x) {
+entry:
+  %m = fmul fast double %x, %x
+  ret double %m
+}
+
+define double @poly(double %x) {
+entry:
+  %a = fmul fast double %x, %x
+  %b = fmul fast double %a, %x
+  %c = fmul fast double %b, %x
+  %d = fadd fast double %a, %b
+  %e = fadd fast double %d, %c
+  %f = fmul fast double %e, 3.000000e+00
+  %g = fadd fast double %f, %x
+  %h = fmul fast double %g, %g
+  %i = fadd fast double %h, %a
+  %j = fmul fast double %i, %x
+  ret double %j
+}
+
+define double @f(double %x, i64 %n) {
+entry:
+  %s = call fast double @square(double %x)
+  %p = call fast double @poly(double %s)
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi double [ %p, %entry ], [ %add, %loop ]
+  %q = call fast double @poly(double %x)
+  %add = fadd fast double %acc, %q
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp ult i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret double %add
+}
+
+define double @df(double %x, i64 %n) {
+entry:
+  %r = call double (...) @__enzyme_autodiff(double (double, i64)* @f, double %x, i64 %n)
+  ret double %r
+}
+
+declare double @__enzyme_autodiff(...)
+
+; square is small enough to inline anywhere, poly only within the loop where
+; its augmented call would be paid on every iteration
+
+; CHECK: define internal { double } @diffef(double %x, i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %m.i = fmul fast double %x, %x
+; CHECK-NOT:    call
+; CHECK:      invertentry:
+; CHECK-NEXT:   %1 = call { double } @diffepoly(double %m.i, double %19)
+; CHECK-NOT:    call
+; CHECK:        ret { double }
+
+; CHECK-NOT: @diffesquare(
@@ -0,0 +1,49 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-inline-cost-model -enzyme-inline-threshold=2 -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+
+define internal double @once(double %x) {
+entry:
+  %a = fmul fast double %x, %x
+  %b = fmul fast double %a, %x
+  %c = fadd fast double %a, %b
+  %d = fmul fast double %c, %x
+  ret double %d
+}
+
+define internal double @twice(double %x) {
+entry:
+  %a = fmul fast double %x, %x
+  %b = fmul fast double %a, %x
+  %c = fadd fast double %a, %b
+  %d = fmul fast double %c, %x
+  ret double %d
+}
+
+define double @f(double %x) {
+entry:
+  %o = call fast double @once(double %x)
+  %t1 = call fast double @twice(double %o)
+  %t2 = call fast double @twice(double %t1)
+  ret double %t2
+}
+
+define double @df(double %x) {
+entry:
+  %r = call double (...) @__enzyme_autodiff(double (double)* @f, double %x)
+  ret double %r
+}
+
+declare double @__enzyme_autodiff(...)
+
+; once is too large for the threshold, but the derivative of f is its only
+; caller besides f itself, so it is inlined all the same
+
+; CHECK: define internal { double } @diffef(double %x, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %a.i = fmul fast double %x, %x
+; CHECK-NOT:    @diffeonce(
+; CHECK:        call { double } @diffetwice(
+; CHECK:        call { double } @diffetwice.2(
+; CHECK-NOT:    @diffeonce(
+; CHECK:        ret { double }
+
+; CHECK-NOT: @diffeonce(
@@ -63,7 +63,7 @@ declare double @__enzyme_autodiff(i8*, double)
 ; CHECK-NEXT:   %[[_realloccast:.+]] = bitcast i8* %[[phiptr]] to double*
 
 ; CHECK-NEXT:   %[[storeloc:.+]] = getelementptr inbounds double, double* %[[_realloccast]], i64 %iv
-; CHECK-NEXT:   store double %1, double* %[[storeloc]], align 8, !invariant.group ![[grp:[0-9]+]]
+; CHECK-NEXT:   store double %1, double* %[[storeloc]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[grp:[0-9]+]]
 ; CHECK-NEXT:   %mul2 = fmul fast double %1, %t
 ; CHECK-NEXT:   %cmp2 = fcmp fast ugt double %mul2, 2.000000e+00
 ; CHECK-NEXT:   br i1 %cmp2, label %exit, label %while
@@ -85,7 +85,7 @@ declare double @__enzyme_autodiff(i8*, double)
 ; CHECK-NEXT:   %"mul2'de.0" = phi double [ %differeturn, %exit ], [ %[[m0diffe:.+]], %incinvertwhile ]
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %iv, %exit ], [ %[[d11:.+]], %incinvertwhile ]
 ; CHECK-NEXT:   %[[gepalloc:.+]] = getelementptr inbounds double, double* %[[_realloccast]], i64 %"iv'ac.0"
-; CHECK-NEXT:   %[[d8:.+]] = load double, double* %[[gepalloc]], align 8, !invariant.group ![[grp]]
+; CHECK-NEXT:   %[[d8:.+]] = load double, double* %[[gepalloc]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[grp]]
 ; CHECK-NEXT:   %[[m1diffet:.+]] = fmul fast double %"mul2'de.0", %[[d8]]
 ; CHECK-NEXT:   %[[d9]] = fadd fast double %"t'de.0", %[[m1diffet]]
 ; CHECK-NEXT:   %[[icmp:.+]] = icmp eq i64 %"iv'ac.0", 0
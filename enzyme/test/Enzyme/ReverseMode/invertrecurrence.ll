@@ -0,0 +1,50 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-invert-recurrences -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* nocapture readonly %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %h = phi i64 [ 1, %entry ], [ %h.next, %loop ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %res, %loop ]
+  %j = and i64 %h, 15
+  %gep = getelementptr inbounds double, double* %x, i64 %j
+  %a = load double, double* %gep, align 8
+  %m = fmul double %a, %a
+  %res = fadd double %acc, %m
+  %h.next = mul i64 %h, 6364136223846793005
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %res
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64)* @f to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; The hash is not cached, each reverse iteration multiplies by the inverse of
+; the odd factor modulo 2^64.
+
+; CHECK: define internal void @diffef(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = add i64 %n, -1
+; CHECK-NEXT:   br label %loop
+
+; CHECK: invertloop:
+; CHECK-NEXT:   %"h'rec.0" = phi i64 [ %h_inv, %incinvertloop ], [ %h, %loop ]
+; CHECK-NEXT:   %"res'de.0" = phi double [ %5, %incinvertloop ], [ %differeturn, %loop ]
+; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %6, %incinvertloop ], [ %0, %loop ]
+; CHECK-NEXT:   %j_unwrap = and i64 %"h'rec.0", 15
+
+; CHECK: incinvertloop:
+; CHECK-NEXT:   %6 = add nsw i64 %"iv'ac.0", -1
+; CHECK-NEXT:   %h_inv = mul i64 %"h'rec.0", -4568919932995229531
+; CHECK-NEXT:   br label %invertloop
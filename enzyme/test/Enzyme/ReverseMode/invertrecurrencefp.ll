@@ -0,0 +1,66 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-invert-recurrences -enzyme-invert-fp-recurrences -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* nocapture readonly %x, i64 %n, double %dt) {
+entry:
+  br label %outer
+
+outer:
+  %o = phi i64 [ 0, %entry ], [ %o.next, %outer.latch ]
+  %acc.o = phi double [ 0.000000e+00, %entry ], [ %res, %outer.latch ]
+  %gep = getelementptr inbounds double, double* %x, i64 %o
+  %a = load double, double* %gep, align 8
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %outer ], [ %inc, %loop ]
+  %t = phi double [ %a, %outer ], [ %t.next, %loop ]
+  %acc = phi double [ %acc.o, %outer ], [ %res, %loop ]
+  %m = fmul double %t, %t
+  %res = fadd double %acc, %m
+  %t.next = fadd double %t, %dt
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %outer.latch, label %loop
+
+outer.latch:
+  %o.next = add nuw nsw i64 %o, 1
+  %ocmp = icmp eq i64 %o.next, 4
+  br i1 %ocmp, label %exit, label %outer
+
+exit:
+  ret double %res
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64, double)* @f to i8*), double* %x, double* %dx, i64 %n, metadata !"enzyme_const", double 0.25)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; Only the value of %t at the exit of the inner loop is cached per outer
+; iteration, earlier values are recovered by subtracting the time step.
+
+; CHECK: define internal void @diffef(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %dt, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = add i64 %n, -1
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull dereferenceable(32) dereferenceable_or_null(32) i8* @malloc(i64 32)
+; CHECK-NEXT:   %"t!manual_lcssa_malloccache" = bitcast i8* %malloccall to double*
+
+; CHECK: invertloop:
+; CHECK-NEXT:   %"t'rec.0" = phi double [ %t_inv3, %invertouter.latch ], [ %t_inv, %incinvertloop ]
+; CHECK:   %m0diffet = fmul fast double %"res'de.0", %"t'rec.0"
+; CHECK-NEXT:   %m1diffet = fmul fast double %"res'de.0", %"t'rec.0"
+
+; CHECK: incinvertloop:
+; CHECK-NEXT:   %17 = add nsw i64 %"iv1'ac.0", -1
+; CHECK-NEXT:   %t_inv = fsub double %"t'rec.0", %dt
+; CHECK-NEXT:   br label %invertloop
+
+; CHECK: invertouter.latch:
+; CHECK:   %18 = getelementptr inbounds double, double* %"t!manual_lcssa_malloccache", i64 %"iv'ac.0"
+; CHECK-NEXT:   %19 = load double, double* %18, align 8
+; CHECK-NEXT:   %t.next_unwrap = fadd double %19, %dt
+; CHECK-NEXT:   %t_inv3 = fsub double %t.next_unwrap, %dt
+; CHECK-NEXT:   br label %invertloop
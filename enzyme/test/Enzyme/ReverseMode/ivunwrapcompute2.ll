@@ -94,7 +94,7 @@ exit:                                        ; preds = %.lr.ph
 ; CHECK-NEXT:   %iv.next2 = add nuw nsw i64 %iv1, 1
 ; CHECK-NEXT:   %g = call double @get()
 ; CHECK-NEXT:   %[[a2:.+]] = getelementptr inbounds double, double* %g_malloccache, i64 %iv1
-; CHECK-NEXT:   store double %g, double* %[[a2]], align 8, !invariant.group !
+; CHECK-NEXT:   store double %g, double* %[[a2]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %cmp2 = icmp eq i64 %iv.next2, %lim
 ; CHECK-NEXT:   br i1 %cmp2, label %invertloop2, label %loop2
 
@@ -123,7 +123,7 @@ exit:                                        ; preds = %.lr.ph
 ; CHECK-NEXT:   %"arg'de.0" = phi double [ %[[a8]], %incinvertloop2 ], [ 0.000000e+00, %loop2 ]
 ; CHECK-NEXT:   %"iv1'ac.0" = phi i64 [ %[[a10:.+]], %incinvertloop2 ], [ %[[a0]], %loop2 ]
 ; CHECK-NEXT:   %[[a6:.+]] = getelementptr inbounds double, double* %g_malloccache, i64 %"iv1'ac.0"
-; CHECK-NEXT:   %[[a7:.+]] = load double, double* %[[a6]], align 8, !invariant.group !{{[0-9]+}}
+; CHECK-NEXT:   %[[a7:.+]] = load double, double* %[[a6]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %m1diffearg = fmul fast double %differeturn, %[[a7]]
 ; CHECK-NEXT:   %[[a8]] = fadd fast double %"arg'de.0", %m1diffearg
 ; CHECK-NEXT:   %[[a9:.+]] = icmp eq i64 %"iv1'ac.0", 0
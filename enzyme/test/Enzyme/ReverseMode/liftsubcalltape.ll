@@ -0,0 +1,51 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-lift-subcall-tape -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* %x, i64 %n) {
+entry:
+  %gep = getelementptr inbounds double, double* %x, i64 %n
+  %xn = load double, double* %gep
+  %cmp = icmp eq i64 %n, 0
+  br i1 %cmp, label %base, label %rec
+
+base:
+  %sq = fmul double %xn, %xn
+  ret double %sq
+
+rec:
+  %nm1 = sub i64 %n, 1
+  %sub = call double @f(double* %x, i64 %nm1)
+  %mul = fmul double %sub, %xn
+  ret double %mul
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  %r = tail call double (...) @__enzyme_autodiff(double (double*, i64)* @f, double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(...)
+
+; CHECK: define internal void @diffef(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK: rec:
+; CHECK-NEXT:   %nm1 = sub i64 %n, 1
+; CHECK-NEXT:   %sub_augmented = call { { i8*, double, double }, double } @augmented_f.2(double* %x, double* %"x'", i64 %nm1)
+; CHECK-NEXT:   %subcache = extractvalue { { i8*, double, double }, double } %sub_augmented, 0
+; CHECK-NEXT:   %sub = extractvalue { { i8*, double, double }, double } %sub_augmented, 1
+; CHECK-NEXT:   %m0diffesub = fmul fast double %differeturn, %xn
+; CHECK-NEXT:   %m1diffexn1 = fmul fast double %differeturn, %sub
+; CHECK-NEXT:   %nm1_unwrap = sub i64 %n, 1
+; CHECK-NEXT:   call void @diffef.3(double* %x, double* %"x'", i64 %nm1_unwrap, double %m0diffesub, { i8*, double, double } %subcache)
+; CHECK-NEXT:   br label %invertentry
+
+; CHECK: define internal { i8*, double } @augmented_f(double* %x, double* %"x'", i64 %n)
+; CHECK: @malloc(i64 24)
+; CHECK: %sub_augmented = call { i8*, double } @augmented_f(double* %x, double* %"x'", i64 %nm1)
+
+; CHECK: define internal { { i8*, double, double }, double } @augmented_f.2(double* %x, double* %"x'", i64 %n)
+; CHECK-NOT: @malloc
+; CHECK: %sub_augmented = call { i8*, double } @augmented_f(double* %x, double* %"x'", i64 %nm1)
+; CHECK: ret
+
+; CHECK: define internal void @diffef.3(double* %x, double* %"x'", i64 %n, double %differeturn, { i8*, double, double } %tapeArg)
+; CHECK: call void @diffef.3(double* %x, double* %"x'", i64 %nm1_unwrap, double %m0diffesub, { i8*, double, double } %tapeld)
@@ -0,0 +1,48 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-lift-subcall-tape -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define void @f(double* %x, i64 %n) {
+entry:
+  %cmp = icmp eq i64 %n, 0
+  br i1 %cmp, label %base, label %rec
+
+base:
+  ret void
+
+rec:
+  %nm1 = sub i64 %n, 1
+  call void @f(double* %x, i64 %nm1)
+  %gep = getelementptr inbounds double, double* %x, i64 %n
+  %xn = load double, double* %gep
+  %mul = fmul double %xn, 2.000000e+00
+  store double %mul, double* %gep
+  ret void
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  call void (...) @__enzyme_autodiff(void (double*, i64)* @f, double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare void @__enzyme_autodiff(...)
+
+; The only value cached by f is the tape of its recursive call, so the tape is
+; returned directly rather than as an element of the returned struct
+
+; CHECK: define internal void @diffef(double* %x, double* %"x'", i64 %n)
+; CHECK: rec:
+; CHECK-NEXT:   %nm1 = sub i64 %n, 1
+; CHECK-NEXT:   %_augmented = call i8* @augmented_f.2(double* %x, double* %"x'", i64 %nm1)
+; CHECK:   call void @diffef.3(double* %x, double* %"x'", i64 %nm1_unwrap, i8* %_augmented)
+
+; CHECK: define internal i8* @augmented_f(double* %x, double* %"x'", i64 %n)
+; CHECK: @malloc(i64 8)
+
+; CHECK: define internal i8* @augmented_f.2(double* %x, double* %"x'", i64 %n)
+; CHECK-NOT: @malloc
+; CHECK: %_augmented = call i8* @augmented_f(double* %x, double* %"x'", i64 %nm1)
+; CHECK: ret
+
+; CHECK: define internal void @diffef.3(double* %x, double* %"x'", i64 %n, i8* %tapeArg1)
+; CHECK: %tapeld = load i8*, i8** %0, align 8
+; CHECK-NEXT:   tail call void @free(i8* nonnull %tapeArg1)
@@ -0,0 +1,69 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-merge-generated -mem2reg -instsimplify -adce -correlated-propagation -simplifycfg -S | FileCheck %s
+
+; Function Attrs: noinline norecurse nounwind uwtable
+define dso_local zeroext i1 @metasubf(double* nocapture %x) local_unnamed_addr #0 {
+entry:
+  %arrayidx = getelementptr inbounds double, double* %x, i64 1
+  store double 3.000000e+00, double* %arrayidx, align 8
+  %0 = load double, double* %x, align 8
+  %cmp = fcmp fast oeq double %0, 2.000000e+00
+  ret i1 %cmp
+}
+
+; Function Attrs: noinline norecurse nounwind uwtable
+define dso_local zeroext i1 @othermetasubf(double* nocapture %x) local_unnamed_addr #0 {
+entry:
+  %arrayidx = getelementptr inbounds double, double* %x, i64 1
+  store double 4.000000e+00, double* %arrayidx, align 8
+  %0 = load double, double* %x, align 8
+  %cmp = fcmp fast oeq double %0, 3.000000e+00
+  ret i1 %cmp
+}
+
+; Function Attrs: noinline norecurse nounwind uwtable
+define dso_local zeroext i1 @subf(double* nocapture %x) local_unnamed_addr #0 {
+entry:
+  %0 = load double, double* %x, align 8
+  %mul = fmul fast double %0, 2.000000e+00
+  store double %mul, double* %x, align 8
+  %call = tail call zeroext i1 @metasubf(double* %x)
+  %call1 = tail call zeroext i1 @othermetasubf(double* %x)
+  ret i1 %call1
+}
+
+; Function Attrs: noinline norecurse nounwind uwtable
+define dso_local void @f(double* nocapture %x) #0 {
+entry:
+  %call = tail call zeroext i1 @subf(double* %x)
+  store double 2.000000e+00, double* %x, align 8
+  ret void
+}
+
+; Function Attrs: noinline nounwind uwtable
+define dso_local double @dsumsquare(double* %x, double* %xp) local_unnamed_addr #1 {
+entry:
+  %call = tail call fast double @__enzyme_autodiff(i8* bitcast (void (double*)* @f to i8*), double* %x, double* %xp)
+  ret double %call
+}
+
+declare dso_local double @__enzyme_autodiff(i8*, double*, double*) local_unnamed_addr
+
+; The two subcalls store different constants, their augmented forward passes
+; differ but their derivatives both only zero the shadow of x[1]
+
+; CHECK: define internal void @augmented_othermetasubf(
+; CHECK: define internal void @augmented_metasubf(
+
+; CHECK: define internal void @diffesubf(double* nocapture %x, double* nocapture %"x'")
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   call void @diffeothermetasubf(double* %x, double* %"x'")
+; CHECK-NEXT:   call void @diffeothermetasubf(double* %x, double* %"x'")
+
+; CHECK: define internal void @diffeothermetasubf(double* nocapture %x, double* nocapture %"x'")
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %"arrayidx'ipg" = getelementptr inbounds double, double* %"x'", i64 1
+; CHECK-NEXT:   store double 0.000000e+00, double* %"arrayidx'ipg", align 8
+; CHECK-NEXT:   ret void
+; CHECK-NEXT: }
+
+; CHECK-NOT: @diffemetasubf(
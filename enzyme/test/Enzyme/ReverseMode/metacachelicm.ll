@@ -79,7 +79,7 @@ attributes #2 = { nounwind }
 ; CHECK-NEXT:   %iv.next = add nuw nsw i64 %iv, 1
 ; CHECK-NEXT:   %call = tail call i64 @getSize()
 ; CHECK-NEXT:   %[[a1:.+]] = getelementptr inbounds i64, i64* %call_malloccache, i64 %iv
-; CHECK-NEXT:   store i64 %call, i64* %[[a1]], align 8, !invariant.group ![[g6:[0-9]+]]
+; CHECK-NEXT:   store i64 %call, i64* %[[a1]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[g6:[0-9]+]]
 ; CHECK-NEXT:   %[[a2:.+]] = getelementptr inbounds double*, double** %i0_malloccache, i64 %iv
 ; CHECK-NEXT:   %mallocsize = mul nuw nsw i64 %call, 8
 ; CHECK-NEXT:   %[[malloccall5:.+]] = tail call noalias nonnull i8* @malloc(i64 %mallocsize)
@@ -135,7 +135,7 @@ attributes #2 = { nounwind }
 ; CHECK-NEXT:   store double 0.000000e+00, double* %"arrayidx7'ipg_unwrap", align 8
 ; CHECK-NEXT:   %[[a12:.+]] = fadd fast double %"add'de.0", %[[a11]]
 ; CHECK-NEXT:   %[[a13:.+]] = getelementptr inbounds i64, i64* %call_malloccache, i64 %"iv'ac.0"
-; CHECK-NEXT:   %[[cload:.+]] = load i64, i64* %[[a13]], align 8, !invariant.group ![[g6]]
+; CHECK-NEXT:   %[[cload:.+]] = load i64, i64* %[[a13]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[g6]]
 ; CHECK-NEXT:   %[[a14:.+]] = add i64 %[[cload]], -1
 ; CHECK-NEXT:   br label %invertfor.body5
 
@@ -145,7 +145,7 @@ attributes #2 = { nounwind }
 ; CHECK-NEXT:   %[[a15:.+]] = getelementptr inbounds double*, double** %i0_malloccache, i64 %"iv'ac.0"
 ; CHECK-NEXT:   %[[a16:.+]] = load double*, double** %[[a15]], align 8, !dereferenceable !{{[0-9]+}}, !invariant.group ![[g7]]
 ; CHECK-NEXT:   %[[a17:.+]] = getelementptr inbounds double, double* %[[a16:.+]], i64 %"iv1'ac.0"
-; CHECK-NEXT:   %[[a18:.+]] = load double, double* %[[a17]], align 8, !invariant.group !
+; CHECK-NEXT:   %[[a18:.+]] = load double, double* %[[a17]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %m0diffei0 = fmul fast double %"add'de.1", %[[a18]]
 ; CHECK-NEXT:   %m1diffei0 = fmul fast double %"add'de.1", %[[a18]]
 ; CHECK-NEXT:   %[[a19:.+]] = fadd fast double %m0diffei0, %m1diffei0
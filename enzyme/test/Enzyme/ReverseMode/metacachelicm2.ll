@@ -142,7 +142,7 @@ attributes #2 = { "correctly-rounded-divide-sqrt-fp-math"="false" "disable-tail-
 ; CHECK-NEXT:   %11 = getelementptr inbounds double*, double** %ld_malloccache, i64 %"iv'ac.0"
 ; CHECK-NEXT:   %12 = load double*, double** %11, align 8, !dereferenceable !{{[0-9]+}}, !invariant.group ![[g9]]
 ; CHECK-NEXT:   %13 = getelementptr inbounds double, double* %12, i64 %"iv1'ac.0"
-; CHECK-NEXT:   %14 = load double, double* %13, align 8, !invariant.group !
+; CHECK-NEXT:   %14 = load double, double* %13, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !
 ; CHECK-NEXT:   %m0diffeld = fmul fast double %"add'de.1", %14
 ; CHECK-NEXT:   %m1diffeld = fmul fast double %"add'de.1", %14
 ; CHECK-NEXT:   %15 = fadd fast double %m0diffeld, %m1diffeld
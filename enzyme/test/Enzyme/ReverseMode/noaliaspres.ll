@@ -69,16 +69,16 @@ exit:
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %5, %incinvertloop ], [ 9, %loop ]
 ; CHECK-NEXT:   %"out'il_phi_unwrap" = load double*, double** %"outp'", align 8, !alias.scope !35, !noalias !36
 ; CHECK-NEXT:   %0 = load double, double* %"out'il_phi_unwrap", align 8, !alias.scope ![[scope18:[0-9]+]], !noalias ![[scope19:[0-9]+]]
-; CHECK-NEXT:   store double 0.000000e+00, double* %"out'il_phi_unwrap", align 8, !alias.scope ![[scope18]], !noalias ![[scope19]]
-; CHECK-NEXT:   %in_unwrap = load double*, double** %inp, align 8, !alias.scope ![[scope7]], !noalias ![[scope8]]
-; CHECK-NEXT:   %v_unwrap = load double, double* %in_unwrap, align 8, !alias.scope ![[scope9]], !noalias ![[scope10]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"out'il_phi_unwrap", align 8, !alias.scope ![[scope18]], !noalias !{{[0-9]+}}
+; CHECK-NEXT:   %in_unwrap = load double*, double** %inp, align 8, !alias.scope ![[scope7]], !noalias !{{[0-9]+}}
+; CHECK-NEXT:   %v_unwrap = load double, double* %in_unwrap, align 8, !alias.scope ![[scope9]], !noalias !{{[0-9]+}}
 ; CHECK-NEXT:   %m0diffev = fmul fast double %0, %v_unwrap
 ; CHECK-NEXT:   %m1diffev = fmul fast double %0, %v_unwrap
 ; CHECK-NEXT:   %1 = fadd fast double %m0diffev, %m1diffev
-; CHECK-NEXT:   %"in'il_phi_unwrap" = load double*, double** %"inp'", align 8, !alias.scope !39, !noalias !40
+; CHECK-NEXT:   %"in'il_phi_unwrap" = load double*, double** %"inp'", align 8, !alias.scope !{{[0-9]+}}, !noalias !{{[0-9]+}}
 ; CHECK-NEXT:   %2 = load double, double* %"in'il_phi_unwrap", align 8, !alias.scope ![[scope20:[0-9]+]], !noalias ![[scope23:[0-9]+]]
 ; CHECK-NEXT:   %3 = fadd fast double %2, %1
-; CHECK-NEXT:   store double %3, double* %"in'il_phi_unwrap", align 8, !alias.scope ![[scope20]], !noalias ![[scope23]]
+; CHECK-NEXT:   store double %3, double* %"in'il_phi_unwrap", align 8, !alias.scope ![[scope20]], !noalias !{{[0-9]+}}
 ; CHECK-NEXT:   %4 = icmp eq i64 %"iv'ac.0", 0
 ; CHECK-NEXT:   br i1 %4, label %invertentry, label %incinvertloop
 
@@ -0,0 +1,52 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-out-of-core-cache -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @prod(double* nocapture readonly %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %p = phi double [ 1.000000e+00, %entry ], [ %m, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %a = load double, double* %gep, align 8
+  %m = fmul double %p, %a
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %m
+}
+
+define void @dprod(double* %x, double* %dx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+
+
+; CHECK: define internal void @diffeprod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = add i64 %n, -1
+; CHECK-NEXT:   %1 = mul nuw nsw i64 %n, 8
+; CHECK-NEXT:   %p_spillcache = call i8* @__enzyme_spill_alloc(i64 %1), !enzyme_cache_alloc ![[ID:[0-9]+]]
+; CHECK-NEXT:   %p_malloccache = bitcast i8* %p_spillcache to double*
+; CHECK-NEXT:   br label %loop
+
+; CHECK: loop:
+; CHECK:   %2 = getelementptr inbounds double, double* %p_malloccache, i64 %iv
+; CHECK-NEXT:   store double %p, double* %2, align 8
+
+; CHECK: invertentry:
+; CHECK-NEXT:   call void @__enzyme_spill_free(i8* %p_spillcache), !enzyme_cache_free ![[ID]]
+; CHECK-NEXT:   ret void
+
+; CHECK: invertloop:
+; CHECK:   %3 = getelementptr inbounds double, double* %p_malloccache, i64 %"iv'ac.0"
+; CHECK-NEXT:   %4 = bitcast double* %3 to i8*
+; CHECK-NEXT:   call void @__enzyme_spill_prefetch(i8* %p_spillcache, i8* %4, i64 8)
+; CHECK-NEXT:   %5 = load double, double* %3, align 8
+; CHECK-NEXT:   %m1diffea = fmul fast double %"m'de.0", %5
@@ -0,0 +1,63 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-parallel-reverse-loops -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+
+define void @square(double* %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %v = load double, double* %gep, align 8, !llvm.access.group !0
+  %sq = fmul double %v, %v
+  store double %sq, double* %gep, align 8, !llvm.access.group !0
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp ult i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit, !llvm.loop !1
+
+exit:
+  ret void
+}
+
+define void @dsquare(double* %x, double* %dx, i64 %n) {
+entry:
+  call void (i8*, ...) @__enzyme_autodiff(i8* bitcast (void (double*, i64)* @square to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare void @__enzyme_autodiff(i8*, ...)
+
+!0 = distinct !{}
+!1 = distinct !{!1, !2}
+!2 = !{!"llvm.loop.parallel_accesses", !0}
+
+; CHECK: define internal void @diffesquare(double* %x, double* %"x'", i64 %n)
+; CHECK: loop:
+; CHECK:   store double %v, double* %1, align 8, !alias.scope ![[CACHE:[0-9]+]], !invariant.group ![[INVG:[0-9]+]]
+; CHECK-NEXT:   %cmp = icmp ne i64 %iv.next, %n
+; CHECK-NEXT:   br i1 %cmp, label %loop, label %invertloop, !llvm.loop !1
+
+; CHECK: invertloop:
+; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %9, %incinvertloop ], [ %0, %loop ]
+; CHECK-NEXT:   %"gep'ipg_unwrap" = getelementptr inbounds double, double* %"x'", i64 %"iv'ac.0"
+; CHECK-NEXT:   %2 = load double, double* %"gep'ipg_unwrap", align 8, !alias.scope !{{[0-9]+}}, !noalias !{{[0-9]+}}, !llvm.access.group ![[AG:[0-9]+]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"gep'ipg_unwrap", align 8, !alias.scope !{{[0-9]+}}, !noalias !{{[0-9]+}}, !llvm.access.group ![[AG]]
+; CHECK-NEXT:   %3 = getelementptr inbounds double, double* %v_malloccache, i64 %"iv'ac.0"
+; CHECK-NEXT:   %4 = load double, double* %3, align 8, !alias.scope ![[CACHE]], !invariant.group ![[INVG]], !llvm.access.group ![[AG]]
+; CHECK-NEXT:   %m0diffev = fmul fast double %2, %4
+; CHECK-NEXT:   %m1diffev = fmul fast double %2, %4
+; CHECK-NEXT:   %5 = fadd fast double %m0diffev, %m1diffev
+; CHECK-NEXT:   %6 = load double, double* %"gep'ipg_unwrap", align 8, !alias.scope !{{[0-9]+}}, !noalias !{{[0-9]+}}, !llvm.access.group ![[AG]]
+; CHECK-NEXT:   %7 = fadd fast double %6, %5
+; CHECK-NEXT:   store double %7, double* %"gep'ipg_unwrap", align 8, !alias.scope !{{[0-9]+}}, !noalias !{{[0-9]+}}, !llvm.access.group ![[AG]]
+; CHECK-NEXT:   %8 = icmp eq i64 %"iv'ac.0", 0
+; CHECK-NEXT:   br i1 %8, label %invertentry, label %incinvertloop
+
+; CHECK: incinvertloop:
+; CHECK-NEXT:   %9 = add nsw i64 %"iv'ac.0", -1
+; CHECK-NEXT:   br label %invertloop, !llvm.loop ![[LOOP:[0-9]+]]
+
+; CHECK: ![[CACHE]] = !{![[CSC:[0-9]+]]}
+; CHECK-NEXT: ![[CSC]] = distinct !{![[CSC]], ![[CDOM:[0-9]+]], !"cache"}
+; CHECK-NEXT: ![[CDOM]] = distinct !{![[CDOM]], !" cache: %diffesquare"}
+; CHECK: ![[LOOP]] = distinct !{![[LOOP]], ![[PA:[0-9]+]]}
+; CHECK-NEXT: ![[PA]] = !{!"llvm.loop.parallel_accesses", ![[AG]]}
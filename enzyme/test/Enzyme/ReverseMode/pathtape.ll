@@ -0,0 +1,157 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-path-tape -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* nocapture readonly %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %latch ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %res, %latch ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %a = load double, double* %gep, align 8
+  %m0 = fmul double %a, %a
+  %c1 = fcmp ogt double %a, 1.000000e+00
+  br i1 %c1, label %latch, label %b
+
+b:
+  %m1 = fmul double %a, 3.000000e+00
+  %c2 = fcmp ogt double %a, 0.000000e+00
+  br i1 %c2, label %latch, label %c
+
+c:
+  %m2 = fmul double %m1, %a
+  %c3 = fcmp ogt double %a, -1.000000e+00
+  br i1 %c3, label %latch, label %d
+
+d:
+  %m3 = fmul double %m2, %a
+  br label %latch
+
+latch:
+  %w = phi double [ %m0, %loop ], [ %m1, %b ], [ %m2, %c ], [ %m3, %d ]
+  %res = fadd double %acc, %w
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %res
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64)* @f to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+define double @g(double* nocapture readonly %x, i32* nocapture readonly %k, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %latch ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %res, %latch ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %a = load double, double* %gep, align 8
+  %c1 = fcmp ogt double %a, 1.000000e+00
+  br i1 %c1, label %p, label %q
+
+p:
+  %mp0 = fmul double %a, %a
+  %mp1 = fdiv double %mp0, 7.000000e+00
+  %mp = fmul double %mp1, %a
+  br label %join
+
+q:
+  %mq0 = fmul double %a, 3.000000e+00
+  %mq1 = fdiv double %mq0, 5.000000e+00
+  %mq = fmul double %mq1, %mq0
+  br label %join
+
+join:
+  %v = phi double [ %mp, %p ], [ %mq, %q ]
+  %kgep = getelementptr inbounds i32, i32* %k, i64 %i
+  %kv = load i32, i32* %kgep, align 4
+  switch i32 %kv, label %latch [
+    i32 1, label %e
+    i32 2, label %e
+  ]
+
+e:
+  %me = fmul double %v, %a
+  br label %latch
+
+latch:
+  %w = phi double [ %v, %join ], [ %me, %e ]
+  %res = fadd double %acc, %w
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %res
+}
+
+define void @dg(double* %x, double* %dx, i32* %k, i64 %n) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i32*, i64)* @g to i8*), double* %x, double* %dx, metadata !"enzyme_const", i32* %k, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; The four paths through the loop body are recorded as a single i8 per
+; iteration instead of one cache per branching block. They are numbered in the
+; order of the blocks they leave the body from, so no table is needed to map
+; them back.
+
+; CHECK: @diffeg_pathtable = private unnamed_addr constant [4 x i8] c"\00\01\00\01"
+; CHECK: @diffeg_pathtable.1 = private unnamed_addr constant [4 x i8] c"\00\01\00\01"
+
+; CHECK: define internal void @diffef(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = add i64 %n, -1
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull i8* @malloc(i64 %n)
+; CHECK-NEXT:   br label %loop
+
+; CHECK: latch:
+; CHECK-NEXT:   %pathid16 = phi i8 [ 3, %d ], [ 2, %c ], [ 1, %b ], [ 0, %loop ]
+; CHECK-NEXT:   %cmp = icmp eq i64 %iv.next, %n
+; CHECK-NEXT:   %1 = getelementptr inbounds i8, i8* %malloccall, i64 %iv
+; CHECK-NEXT:   store i8 %pathid16, i8* %1, align 1
+; CHECK-NEXT:   br i1 %cmp, label %invertlatch, label %loop
+
+; CHECK: invertlatch:
+; CHECK:   %[[p1:.+]] = getelementptr inbounds i8, i8* %malloccall, i64 %"iv'ac.0"
+; CHECK-NEXT:   %[[l1:.+]] = load i8, i8* %[[p1]], align 1
+; CHECK-NEXT:   %{{.+}} = icmp eq i8 0, %[[l1]]
+; CHECK-NOT:    pathtable
+; CHECK:   switch i8 %{{.+}}, label %invertd [
+; CHECK-NEXT:     i8 0, label %invertloop
+; CHECK-NEXT:     i8 1, label %invertb
+; CHECK-NEXT:     i8 2, label %invertc
+; CHECK-NEXT:   ]
+; CHECK-NEXT: }
+
+; Both edges of the switch to %e share the identifier of their block, and
+; every path through %e maps back to it
+
+; CHECK: define internal void @diffeg(double* nocapture readonly %x, double* nocapture %"x'", i32* nocapture readonly %k, i64 %n, double %differeturn)
+; CHECK:   %pathid.next = add nuw i8 %[[pj:.+]], 1
+; CHECK-NEXT:   switch i32 %kv, label %latch [
+; CHECK-NEXT:     i32 1, label %e
+; CHECK-NEXT:     i32 2, label %e
+; CHECK-NEXT:   ]
+
+; CHECK: latch:
+; CHECK-NEXT:   %[[pl:.+]] = phi i8 [ %pathid.next, %e ], [ %[[pj]], %loop ]
+; CHECK-NEXT:   %cmp = icmp eq i64 %iv.next, %n
+; CHECK-NEXT:   %[[gl:.+]] = getelementptr inbounds i8, i8* %malloccall, i64 %iv
+; CHECK-NEXT:   store i8 %[[pl]], i8* %[[gl]], align 1
+
+; CHECK: invertlatch:
+; CHECK:   %[[t2:.+]] = getelementptr inbounds [4 x i8], [4 x i8]* @diffeg_pathtable.1, i64 0, i64 %{{.+}}
+; CHECK-NEXT:   %[[w2:.+]] = load i8, i8* %[[t2]], align 1
+; CHECK-NEXT:   %[[c2:.+]] = trunc i8 %[[w2]] to i1
+; CHECK-NEXT:   br i1 %[[c2]], label %inverte, label %invertjoin
+; CHECK-NEXT: }
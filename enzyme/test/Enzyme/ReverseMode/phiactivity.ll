@@ -64,7 +64,7 @@ declare double @__enzyme_autodiff(i8*, double)
 
 ; CHECK-NEXT:   %[[_realloccast:.+]] = bitcast i8* %[[_realloccache]] to double*
 ; CHECK-NEXT:   %[[loc1:.+]] = getelementptr inbounds double, double* %[[_realloccast]], i64 %iv
-; CHECK-NEXT:   store double %[[mphi]], double* %[[loc1]], align 8, !invariant.group ![[grp:[0-9]+]]
+; CHECK-NEXT:   store double %[[mphi]], double* %[[loc1]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[grp:[0-9]+]]
 ; CHECK-NEXT:   %[[trunc:.+]] = trunc i64 %iv to i32
 ; CHECK-NEXT:   %inc = add nuw nsw i32 %[[trunc]], 1
 ; CHECK-NEXT:   %mul2 = fmul fast double %[[mphi]], %t
@@ -88,7 +88,7 @@ declare double @__enzyme_autodiff(i8*, double)
 ; CHECK-NEXT:   %"mul2'de.0" = phi double [ %differeturn, %exit ], [ %[[m0diffe:.+]], %incinvertwhile ]
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %iv, %exit ], [ %[[dinc:.+]], %incinvertwhile ]
 ; CHECK-NEXT:   %[[philoc:.+]] = getelementptr inbounds double, double* %[[_realloccast]], i64 %"iv'ac.0"
-; CHECK-NEXT:   %[[prevphi:.+]] = load double, double* %[[philoc]], align 8, !invariant.group ![[grp]]
+; CHECK-NEXT:   %[[prevphi:.+]] = load double, double* %[[philoc]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[grp]]
 ; CHECK-NEXT:   %[[m1diffet:.+]] = fmul fast double %"mul2'de.0", %[[prevphi]]
 ; CHECK-NEXT:   %[[dt2]] = fadd fast double %"t'de.0", %[[m1diffet]]
 ; CHECK-NEXT:   %[[dcmp:.+]] = icmp eq i64 %"iv'ac.0", 0
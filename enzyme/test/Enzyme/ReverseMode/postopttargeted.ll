@@ -0,0 +1,40 @@
+; RUN: if [ %llvmver -ge 12 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-postopt -S | FileCheck %s; fi
+
+define double @square(double %x) {
+entry:
+  %mul = fmul double %x, %x
+  ret double %mul
+}
+
+define double @unrelated(double %x) {
+entry:
+  %a = alloca double
+  store double %x, double* %a
+  %l = load double, double* %a
+  ret double %l
+}
+
+define double @dsquare(double %x) {
+entry:
+  %0 = tail call double (double (double)*, ...) @__enzyme_autodiff(double (double)* nonnull @square, double %x)
+  ret double %0
+}
+
+declare double @__enzyme_autodiff(double (double)*, ...)
+
+; Functions unrelated to differentiation are left untouched by the post
+; optimizations, while the caller of the derivative is simplified.
+
+; CHECK: define double @unrelated(double %x) {
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %a = alloca double
+; CHECK-NEXT:   store double %x, double* %a
+; CHECK-NEXT:   %l = load double, double* %a
+; CHECK-NEXT:   ret double %l
+; CHECK-NEXT: }
+
+; CHECK: define double @dsquare(double %x) {
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = fadd fast double %x, %x
+; CHECK-NEXT:   ret double %0
+; CHECK-NEXT: }
@@ -0,0 +1,65 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-progressive-free-cache -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @f(double* nocapture readonly %x, i64 %n, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %o = phi i64 [ 0, %entry ], [ %o.next, %outer.latch ]
+  %acc.o = phi double [ 0.000000e+00, %entry ], [ %res, %outer.latch ]
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %outer ], [ %inc, %loop ]
+  %p = phi double [ %acc.o, %outer ], [ %res, %loop ]
+  %k = mul nuw nsw i64 %o, %n
+  %idx = add nuw nsw i64 %k, %i
+  %gep = getelementptr inbounds double, double* %x, i64 %idx
+  %a = load double, double* %gep, align 8
+  %res = fmul double %p, %a
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %outer.latch, label %loop
+
+outer.latch:
+  %o.next = add nuw nsw i64 %o, 1
+  %ocmp = icmp eq i64 %o.next, %m
+  br i1 %ocmp, label %exit, label %outer
+
+exit:
+  ret double %res
+}
+
+define void @df(double* %x, double* %dx, i64 %n, i64 %m) {
+entry:
+  %call = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64, i64)* @f to i8*), double* %x, double* %dx, i64 %n, i64 %m)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; The inner loop cache is allocated once per outer iteration and freed as soon
+; as the reverse of that outer iteration completes.
+
+; CHECK: define internal void @diffef(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, i64 %m, double %differeturn)
+; CHECK:   %mallocsize = mul nuw nsw i64 %m, 8
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull i8* @malloc(i64 %mallocsize)
+; CHECK-NEXT:   %p_malloccache = bitcast i8* %malloccall to double**
+
+; CHECK: outer:
+; CHECK:   %[[slot:.+]] = getelementptr inbounds double*, double** %p_malloccache, i64 %iv
+; CHECK-NEXT:   %mallocsize3 = mul nuw nsw i64 %n, 8
+; CHECK-NEXT:   %malloccall4 = tail call noalias nonnull i8* @malloc(i64 %mallocsize3)
+; CHECK-NEXT:   %p_malloccache5 = bitcast i8* %malloccall4 to double*
+; CHECK-NEXT:   store double* %p_malloccache5, double** %[[slot]], align 8
+
+; CHECK: invertentry:
+; CHECK-NEXT:   tail call void @free(i8* nonnull %malloccall)
+; CHECK-NEXT:   ret void
+
+; CHECK: invertouter:
+; CHECK:   %_unwrap6 = getelementptr inbounds double*, double** %p_malloccache, i64 %"iv'ac.0"
+; CHECK-NEXT:   %forfree7 = load double*, double** %_unwrap6, align 8
+; CHECK-NEXT:   %[[i8:.+]] = bitcast double* %forfree7 to i8*
+; CHECK-NEXT:   tail call void @free(i8* nonnull %[[i8]])
+; CHECK-NEXT:   br i1 %{{.+}}, label %invertentry, label %incinvertouter
@@ -62,7 +62,7 @@ declare void @_Z17__enzyme_autodiffPviS_S_(...)
 ; CHECK-NEXT:   %11 = phi i8* [ %10, %grow.i ], [ %1, %for.body ]
 ; CHECK-NEXT:   %12 = bitcast i8* %11 to double**
 ; CHECK-NEXT:   %13 = getelementptr inbounds double*, double** %12, i64 %iv
-; CHECK-NEXT:   store double* %0, double** %13, align 8, !invariant.group !0
+; CHECK-NEXT:   store double* %0, double** %13, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %14 = call double* @_ZSt18_Rb_tree_incrementPKSt18_Rb_tree_node_base(double* %0)
 ; CHECK-NEXT:   %call.i = tail call double* @_ZSt18_Rb_tree_incrementPKSt18_Rb_tree_node_base(double* %iter)
 ; CHECK-NEXT:   %cmp.i.not = icmp eq double* %call.i, null
@@ -75,7 +75,7 @@ declare void @_Z17__enzyme_autodiffPviS_S_(...)
 ; CHECK: invertfor.body:                                   ; preds = %__enzyme_exponentialallocation.exit, %incinvertfor.body
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %21, %incinvertfor.body ], [ %iv, %__enzyme_exponentialallocation.exit ]
 ; CHECK-NEXT:   %15 = getelementptr inbounds double*, double** %12, i64 %"iv'ac.0"
-; CHECK-NEXT:   %16 = load double*, double** %15, align 8, !invariant.group !0
+; CHECK-NEXT:   %16 = load double*, double** %15, align 8, !alias.scope !{{[0-9]+}}, !invariant.group !{{[0-9]+}}
 ; CHECK-NEXT:   %17 = load double, double* %16, align 8
 ; CHECK-NEXT:   %18 = fadd fast double %17, %differeturn
 ; CHECK-NEXT:   store double %18, double* %16, align 8
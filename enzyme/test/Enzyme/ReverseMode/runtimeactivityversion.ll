@@ -0,0 +1,49 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-runtime-activity -enzyme-runtime-activity-versioning -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+; RUN: if [ %llvmver -ge 12 ]; then %opt < %s %newLoadEnzyme -passes="enzyme,function(mem2reg,instsimplify,simplifycfg)" -enzyme-preopt=false -enzyme-runtime-activity -enzyme-runtime-activity-versioning -S | FileCheck %s; fi
+
+define double @sum(double* %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %add, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %ld = load double, double* %gep
+  %add = fadd double %acc, %ld
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %exit, label %loop
+
+exit:
+  ret double %add
+}
+
+define void @dsum(double* %x, double* %dx, i64 %n) {
+entry:
+  %0 = tail call double (double (double*, i64)*, ...) @__enzyme_autodiff(double (double*, i64)* nonnull @sum, double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(double (double*, i64)*, ...)
+
+; CHECK: define internal void @diffesum(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: dispatch:
+; CHECK-NEXT:   %"x'active" = icmp ne double* %x, %"x'"
+; CHECK-NEXT:   br i1 %"x'active", label %dispatch.distinct, label %entry
+
+; CHECK: dispatch.distinct:
+; CHECK-NEXT:   tail call void @diffesum_distinct(double* %x, double* %"x'", i64 %n, double %differeturn)
+
+; CHECK: invertloop:
+; CHECK:   br i1 %"x'active", label %invertloop_active, label %invertloop_amerge
+
+; CHECK: define internal void @diffesum_distinct(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK-NOT: icmp ne double*
+; CHECK: invertloop:
+; CHECK-NEXT:   %"add'de.0" = phi double [ %4, %incinvertloop ], [ %differeturn, %loop ]
+; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %5, %incinvertloop ], [ %0, %loop ]
+; CHECK-NEXT:   %"gep'ipg_unwrap" = getelementptr inbounds double, double* %"x'", i64 %"iv'ac.0"
+; CHECK-NEXT:   %1 = load double, double* %"gep'ipg_unwrap", align 8
+; CHECK-NEXT:   %2 = fadd fast double %1, %"add'de.0"
+; CHECK-NEXT:   store double %2, double* %"gep'ipg_unwrap", align 8
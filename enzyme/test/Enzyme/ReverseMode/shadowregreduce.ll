@@ -0,0 +1,47 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-preopt=false -enzyme-shadow-register-reduction -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+
+target datalayout = "e-i64:64-i128:128-v16:16-v32:32-n16:32:64"
+target triple = "nvptx64-nvidia-cuda"
+
+define double @sum(double* %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi double [ 0.000000e+00, %entry ], [ %add, %loop ]
+  %v = load double, double* %x, align 8
+  %w = uitofp i64 %i to double
+  %mul = fmul double %v, %w
+  %add = fadd double %acc, %mul
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp ult i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret double %add
+}
+
+define void @dsum(double* %x, double* %dx, i64 %n) {
+entry:
+  %r = call double (i8*, ...) @__enzyme_autodiff(i8* bitcast (double (double*, i64)* @sum to i8*), double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(i8*, ...)
+
+; CHECK: define internal void @diffesum(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK: invertentry:                                      ; preds = %invertloop
+; CHECK-NEXT:   %1 = atomicrmw fadd double* %"x'", double %2 monotonic, align 8
+; CHECK-NEXT:   ret void
+
+; CHECK: invertloop:                                       ; preds = %loop, %incinvertloop
+; CHECK-NEXT:   %"add'de.0" = phi double [ %4, %incinvertloop ], [ %differeturn, %loop ]
+; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %5, %incinvertloop ], [ %0, %loop ]
+; CHECK-NEXT:   %"x''rr.0" = phi double [ %2, %incinvertloop ], [ 0.000000e+00, %loop ]
+; CHECK-NEXT:   %w_unwrap = uitofp i64 %"iv'ac.0" to double
+; CHECK-NEXT:   %m0diffev = fmul fast double %"add'de.0", %w_unwrap
+; CHECK-NEXT:   %2 = fadd fast double %"x''rr.0", %m0diffev
+; CHECK-NEXT:   %3 = icmp eq i64 %"iv'ac.0", 0
+; CHECK-NEXT:   %4 = select fast i1 %3, double 0.000000e+00, double %"add'de.0"
+; CHECK-NEXT:   br i1 %3, label %invertentry, label %incinvertloop
@@ -0,0 +1,53 @@
+; RUN: %opt < %s %loadEnzyme -enzyme -enzyme-specialize-constants -mem2reg -instsimplify -simplifycfg -S | FileCheck %s
+
+define double @f(double* %x, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi double [ 1.000000e+00, %entry ], [ %mul, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %ld = load double, double* %gep
+  %mul = fmul fast double %acc, %ld
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp ult i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret double %mul
+}
+
+define void @df(double* %x, double* %dx) {
+entry:
+  %r = call double (...) @__enzyme_autodiff(double (double*, i64)* @f, double* %x, double* %dx, i64 4)
+  ret void
+}
+
+define void @dg(double* %x, double* %dx, i64 %n) {
+entry:
+  %r = call double (...) @__enzyme_autodiff(double (double*, i64)* @f, double* %x, double* %dx, i64 %n)
+  ret void
+}
+
+declare double @__enzyme_autodiff(...)
+
+; CHECK: define void @df(double* %x, double* %dx)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   call void @diffef.spec(double* %x, double* %dx, i64 4, double 1.000000e+00)
+
+; CHECK: define void @dg(double* %x, double* %dx, i64 %n)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   call void @diffef(double* %x, double* %dx, i64 %n, double 1.000000e+00)
+
+; CHECK: define internal void @diffef.spec(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %malloccall = tail call noalias nonnull dereferenceable(32) dereferenceable_or_null(32) i8* @malloc(i64 32)
+; CHECK:        %cmp = icmp ne i64 %iv.next, 4
+; CHECK:        %"iv'ac.0" = phi i64 [ %7, %incinvertloop ], [ 3, %loop ]
+
+; CHECK: define internal void @diffef(double* %x, double* %"x'", i64 %n, double %differeturn)
+; CHECK:        %mallocsize = mul nuw nsw i64 %n, 8
+; CHECK:        %cmp = icmp ne i64 %iv.next, %n
+
+; CHECK-NOT: define {{.*}} @f.spec(
@@ -59,7 +59,7 @@ attributes #0 = { noinline nounwind uwtable }
 ; CHECK-NEXT:   %add = fadd fast double %[[finaly]], %2
 ; CHECK-NEXT:   store double %add, double* %[[yload]]
 ; CHECK-NEXT:   %[[cachegep:.+]] = getelementptr inbounds double*, double** %[[antimallocs]], i64 %iv
-; CHECK-NEXT:   store double* %[[ipload]], double** %[[cachegep]], align 8, !invariant.group ![[g0:[0-9]+]]
+; CHECK-NEXT:   store double* %[[ipload]], double** %[[cachegep]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[g0:[0-9]+]]
 ; CHECK-NEXT:   br label %for.cond
 
 ; CHECK: invertentry:
@@ -74,7 +74,7 @@ attributes #0 = { noinline nounwind uwtable }
 ; CHECK: incinvertfor.cond:
 ; CHECK-NEXT:   %[[sub]] = add nsw i64 %[[ivp]], -1
 ; CHECK-NEXT:   %8 = getelementptr inbounds double*, double** %[[antimallocs]], i64 %[[sub]]
-; CHECK-NEXT:   %9 = load double*, double** %8, align 8, !invariant.group ![[g0]]
+; CHECK-NEXT:   %9 = load double*, double** %8, align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[g0]]
 ; CHECK-NEXT:   %10 = load double, double* %9
 ; CHECK-NEXT:   store double %10, double* %9
 ; CHECK-NEXT:   %11 = load double, double* %"x'"
@@ -0,0 +1,69 @@
+; RUN: if [ %llvmver -lt 16 ]; then %opt < %s %loadEnzyme -enzyme -enzyme-tape-arena -mem2reg -instsimplify -simplifycfg -S | FileCheck %s; fi
+
+define double @prod(double* nocapture readonly %x, i64 %n) {
+entry:
+  %xa = getelementptr inbounds double, double* %x, i64 1
+  %a = load double, double* %xa, align 8
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %p = phi double [ 1.000000e+00, %entry ], [ %m, %loop ]
+  %gep = getelementptr inbounds double, double* %x, i64 %i
+  %v = load double, double* %gep, align 8
+  %m = fmul double %p, %v
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp eq i64 %inc, %n
+  br i1 %cmp, label %grow, label %loop
+
+grow:
+  %q = phi double [ %m, %loop ], [ %q2, %grow ]
+  %qa = fmul double %q, %a
+  %q2 = fadd double %qa, 1.000000e+00
+  %done = fcmp ogt double %q2, 1.000000e+02
+  br i1 %done, label %exit, label %grow
+
+exit:
+  ret double %q2
+}
+
+define void @df(double* %x, double* %dx, i64 %n) {
+entry:
+  %t = call { i8*, double } (i8*, ...) @__enzyme_augmentfwd(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n)
+  %tape = extractvalue { i8*, double } %t, 0
+  call void (i8*, ...) @__enzyme_reverse(i8* bitcast (double (double*, i64)* @prod to i8*), double* %x, double* %dx, i64 %n, double 1.0, i8* %tape)
+  ret void
+}
+
+declare { i8*, double } @__enzyme_augmentfwd(i8*, ...)
+declare void @__enzyme_reverse(i8*, ...)
+
+; CHECK: define internal i8* @__enzyme_exponentialallocation.__enzyme_tape_arena_realloc(i8* %ptr, i64 %size, i64 %tsize)
+; CHECK: grow:
+; CHECK:   %8 = call i8* @__enzyme_tape_arena_realloc(i8* %ptr, i64 %7)
+
+; CHECK: define internal { i8*, double } @augmented_prod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n)
+; CHECK:   %tapemem = call i8* @__enzyme_tape_arena_alloc(i64 32)
+; CHECK:   %p_arenacache = call i8* @__enzyme_tape_arena_alloc(i64 %4)
+; CHECK-NEXT:   %p_malloccache = bitcast i8* %p_arenacache to double*
+; CHECK:   %v_arenacache = call i8* @__enzyme_tape_arena_alloc(i64 %6)
+; CHECK-NEXT:   %v_malloccache = bitcast i8* %v_arenacache to double*
+; CHECK-NOT: @malloc
+; CHECK: grow:
+; CHECK:   call i8* @__enzyme_tape_arena_realloc(
+; CHECK-NOT: @malloc
+; CHECK: ret { i8*, double }
+
+; CHECK: define internal void @diffeprod(double* nocapture readonly %x, double* nocapture %"x'", i64 %n, double %differeturn, i8* %tapeArg)
+; CHECK-NEXT: entry:
+; CHECK-NEXT:   %0 = bitcast i8* %tapeArg to { double, double*, double*, double* }*
+; CHECK-NEXT:   %truetape = load { double, double*, double*, double* }, { double, double*, double*, double* }* %0, align 8
+; CHECK-NEXT:   call void @__enzyme_tape_arena_free(i8* %tapeArg)
+
+; CHECK: invertentry:
+; CHECK:   call void @__enzyme_tape_arena_free(i8* %8)
+; CHECK:   call void @__enzyme_tape_arena_free(i8* %9)
+
+; CHECK: invertgrow.preheader:
+; CHECK:   call void @__enzyme_tape_arena_free(i8* %21)
+; CHECK-NOT: @free(
@@ -77,7 +77,7 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK-NEXT:   %iv.next2 = add nuw nsw i64 %iv1, 1
 ; CHECK-NEXT:   %[[augmented:.+]] = call fast double @augmented_get(double* %x, double* %"x'", i64 undef, i64 %iv1)
 ; CHECK-NEXT:   %[[mallocgep2:.+]] = getelementptr inbounds double, double* %[[call_malloccache3]], i64 %iv1
-; CHECK-NEXT:   store double %[[augmented]], double* %[[mallocgep2]], align 8, !invariant.group ![[ig1:[0-9]+]]
+; CHECK-NEXT:   store double %[[augmented]], double* %[[mallocgep2]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig1:[0-9]+]]
 ; CHECK-NEXT:   %exitcond = icmp eq i64 %iv1, %iv
 ; CHECK-NEXT:   br i1 %exitcond, label %for.cond.cleanup6, label %for.body7
 
@@ -102,7 +102,7 @@ attributes #1 = { noinline nounwind uwtable }
 ; CHECK: invertfor.body7:
 ; CHECK-NEXT:   %[[iv1:.+]] = phi i64 [ %[[iv]], %invertfor.cond.cleanup6 ], [ %[[subinner:.+]], %incinvertfor.body7 ]
 ; CHECK-NEXT:   %[[invertedgep2:.+]] = getelementptr inbounds double, double* %[[innerdata]], i64 %[[iv1]]
-; CHECK-NEXT:   %[[cached:.+]] = load double, double* %[[invertedgep2]], align 8, !invariant.group ![[ig1]]
+; CHECK-NEXT:   %[[cached:.+]] = load double, double* %[[invertedgep2]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig1]]
 ; CHECK-NEXT:   %m0diffecall = fmul fast double %differeturn, %[[cached]]
 ; CHECK-NEXT:   %[[innerdiffe:.+]] = fadd fast double %m0diffecall, %m0diffecall
 ; CHECK-NEXT:   call void @diffeget(double* %x, double* %"x'", i64 undef, i64 %[[iv1]], double %[[innerdiffe]])
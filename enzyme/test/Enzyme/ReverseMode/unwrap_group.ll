@@ -52,12 +52,12 @@ declare dso_local void @__enzyme_autodiff(i8*, double*, double*, i32*) local_unn
 
 ; CHECK: bb12:                                             ; preds = %bb5
 ; CHECK-NEXT:   store double 0.000000e+00, double* %arg, align 8, !alias.scope ![[ARG_SC]], !noalias ![[NA_SC]]
-; CHECK-NEXT:   store double 0.000000e+00, double* %"arg'", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"arg'", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_CNA:[0-9]+]]
 ; CHECK-NEXT:   br i1 %tmp, label %invert, label %invertbb5
 
 ; CHECK: invert.critedge:                                  ; preds = %0
 ; CHECK-NEXT:   store double 0.000000e+00, double* %arg, align 8, !alias.scope ![[ARG_SC]], !noalias ![[NA_SC]]
-; CHECK-NEXT:   store double 0.000000e+00, double* %"arg'", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"arg'", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_CNA]]
 ; CHECK-NEXT:   br label %invert
 
 ; CHECK: invert:                                           ; preds = %invert.critedge, %invertbb5, %bb12
@@ -67,13 +67,13 @@ declare dso_local void @__enzyme_autodiff(i8*, double*, double*, i32*) local_unn
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ %5, %incinvertbb5 ], [ 199, %bb12 ]
 ; CHECK-NEXT:   %"tmp7'ipg_unwrap" = getelementptr inbounds double, double* %"arg'", i64 %"iv'ac.0"
 ; CHECK-NEXT:   %1 = load double, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
-; CHECK-NEXT:   store double 0.000000e+00, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
-; CHECK-NEXT:   %tmp3_unwrap = load i32, i32* %arg1, align 4, !alias.scope ![[ARG1_SC]], !noalias ![[NA1_SC]], !invariant.group ![[INVG]]
+; CHECK-NEXT:   store double 0.000000e+00, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_CNA]]
+; CHECK-NEXT:   %tmp3_unwrap = load i32, i32* %arg1, align 4, !alias.scope ![[ARG1_SC]], !noalias !{{[0-9]+}}, !invariant.group ![[INVG]]
 ; CHECK-NEXT:   %tmp4_unwrap = sitofp i32 %tmp3_unwrap to double
 ; CHECK-NEXT:   %m0diffetmp8 = fmul fast double %1, %tmp4_unwrap
-; CHECK-NEXT:   %2 = load double, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
+; CHECK-NEXT:   %2 = load double, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_CNA]]
 ; CHECK-NEXT:   %3 = fadd fast double %2, %m0diffetmp8
-; CHECK-NEXT:   store double %3, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_SC]]
+; CHECK-NEXT:   store double %3, double* %"tmp7'ipg_unwrap", align 8, !alias.scope ![[NA_SC]], !noalias ![[ARG_CNA]]
 ; CHECK-NEXT:   %4 = icmp eq i64 %"iv'ac.0", 0
 ; CHECK-NEXT:   br i1 %4, label %invert, label %incinvertbb5
 
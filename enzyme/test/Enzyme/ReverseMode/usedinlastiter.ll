@@ -87,7 +87,7 @@ declare void @__enzyme_autodiff(i8*, float*, float*, float*, float*, i64* %l, i1
 
 ; CHECK: _ZNK11OuterStruct4sizeEv.exit:                    ; preds = %merge
 ; CHECK-NEXT:   %[[i0:.+]] = getelementptr inbounds i64, i64* %cond.lcssa_malloccache, i64 %iv
-; CHECK-NEXT:   store i64 %cond, i64* %[[i0]], align 8, !invariant.group ![[ig0:.+]]
+; CHECK-NEXT:   store i64 %cond, i64* %[[i0]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig0:.+]]
 ; CHECK-NEXT:   %cmp3.not233 = icmp eq i64 %cond, 0
 ; CHECK-NEXT:   br i1 %cmp3.not233, label %for.cond.cleanup4, label %for.cond6.preheader.preheader
 
@@ -106,7 +106,7 @@ declare void @__enzyme_autodiff(i8*, float*, float*, float*, float*, i64* %l, i1
 ; CHECK-NEXT:   %sq = fmul float %a17.pre, %a17.pre
 ; CHECK-NEXT:   store float %sq, float* %out, align 8
 ; CHECK-NEXT:   %[[i3:.+]] = getelementptr inbounds float, float* %[[a17_malloccache6]], i64 %iv3
-; CHECK-NEXT:   store float %a17.pre, float* %[[i3]], align 4, !invariant.group ![[g2:[0-9]+]]
+; CHECK-NEXT:   store float %a17.pre, float* %[[i3]], align 4, !alias.scope !{{[0-9]+}}, !invariant.group ![[g2:[0-9]+]]
 ; CHECK-NEXT:   %cmp3.not = icmp eq i64 %iv.next4, %cond
 ; CHECK-NEXT:   br i1 %cmp3.not, label %for.cond.cleanup4, label %for.cond6.preheader
 
@@ -159,7 +159,7 @@ declare void @__enzyme_autodiff(i8*, float*, float*, float*, float*, i64* %l, i1
 ; CHECK-NEXT:   store float 0.000000e+00, float* %"out'", align 8
 ; CHECK-NEXT:   %[[i10:.+]] = fadd fast float %"sq'de.1", %[[i9]]
 ; CHECK-NEXT:   %[[i11:.+]] = getelementptr inbounds float, float* %.pre, i64 %"iv3'ac.0"
-; CHECK-NEXT:   %[[i12:.+]] = load float, float* %[[i11]], align 4, !invariant.group ![[g2]]
+; CHECK-NEXT:   %[[i12:.+]] = load float, float* %[[i11]], align 4, !alias.scope !{{[0-9]+}}, !invariant.group ![[g2]]
 ; CHECK-NEXT:   %m0diffea17 = fmul fast float %[[i10]], %[[i12]]
 ; CHECK-NEXT:   %[[i13:.+]] = fadd fast float %"a17'de.1", %m0diffea17
 ; CHECK-NEXT:   %[[i14:.+]] = fadd fast float %[[i13]], %m0diffea17
@@ -184,7 +184,7 @@ declare void @__enzyme_autodiff(i8*, float*, float*, float*, float*, i64* %l, i1
 ; CHECK-NEXT:   %"sq'de.2" = phi float [ 0.000000e+00, %for.cond.cleanup ], [ %"sq'de.0", %incinvertfor.body ]
 ; CHECK-NEXT:   %"iv'ac.0" = phi i64 [ 9, %for.cond.cleanup ], [ %[[i5]], %incinvertfor.body ]
 ; CHECK-NEXT:   %[[i19:.+]] = getelementptr inbounds i64, i64* %cond.lcssa_malloccache, i64 %"iv'ac.0"
-; CHECK-NEXT:   %[[i22]] = load i64, i64* %[[i19]], align 8, !invariant.group ![[ig0]]
+; CHECK-NEXT:   %[[i22]] = load i64, i64* %[[i19]], align 8, !alias.scope !{{[0-9]+}}, !invariant.group ![[ig0]]
 ; CHECK-NEXT:   %cmp3.not233_unwrap = icmp eq i64 %[[i22]], 0
 ; CHECK-NEXT:   br i1 %cmp3.not233_unwrap, label %invert_ZNK11OuterStruct4sizeEv.exit, label %invertfor.cond.cleanup4.loopexit
 ; CHECK-NEXT: }
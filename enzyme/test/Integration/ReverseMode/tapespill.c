@@ -0,0 +1,46 @@
+// RUN: %clang -std=c11 -O0 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-out-of-core-cache -S | %lli - 
+// RUN: %clang -std=c11 -O1 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-out-of-core-cache -S | %lli - 
+// RUN: %clang -std=c11 -O2 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-out-of-core-cache -S | %lli - 
+// RUN: %clang -std=c11 -O3 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-out-of-core-cache -S | %lli - 
+
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+
+#include "test_utils.h"
+
+// Use small chunks so that the reverse pass crosses many of them
+#define ENZYME_SPILL_CHUNK 4096
+#include "../../../include/enzyme/tapespill.h"
+
+double __enzyme_autodiff(void*, ...);
+
+__attribute__((noinline))
+double prod(double* x, int n) {
+  double p = 1;
+  for (int i = 0; i < n; i++) {
+    p *= x[i];
+  }
+  return p;
+}
+
+int main(int argc, char** argv) {
+  int n = 10000;
+  double* x = (double*)malloc(sizeof(double) * n);
+  double* dx = (double*)malloc(sizeof(double) * n);
+  for (int i = 0; i < n; i++) {
+    x[i] = 1;
+    dx[i] = 0;
+  }
+  x[7] = 2;
+
+  __enzyme_autodiff((void*)prod, x, dx, n);
+
+  for (int i = 0; i < n; i++) {
+    APPROX_EQ(dx[i], i == 7 ? 1.0 : 2.0, 1e-10);
+  }
+  printf("dx[0]=%f dx[7]=%f dx[%d]=%f\n", dx[0], dx[7], n - 1, dx[n - 1]);
+  free(x);
+  free(dx);
+  return 0;
+}
@@ -0,0 +1,91 @@
+// RUN: %clang -std=c11 -O0 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-tape-stack -S | %lli -
+// RUN: %clang -std=c11 -O1 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-tape-stack -S | %lli -
+// RUN: %clang -std=c11 -O2 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-tape-stack -S | %lli -
+// RUN: %clang -std=c11 -O3 %s -S -emit-llvm -o - | %opt - %loadEnzyme -enzyme -enzyme-tape-stack -S | %lli -
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "test_utils.h"
+
+// Use small segments so that the frames below span several of them
+#define ENZYME_TAPE_STACK_SEGMENT 64
+#include "../../../include/enzyme/tapestack.h"
+
+void* __enzyme_augmentfwd(void*, ...);
+void __enzyme_reverse(void*, ...);
+void __enzyme_autodiff(void*, ...);
+
+#define N 5
+
+__attribute__((noinline))
+void prod(double* x, double* out, int n) {
+  if (n == 0) {
+    *out = x[0];
+    return;
+  }
+  prod(x, out, n - 1);
+  *out = *out * x[n];
+}
+
+void check(double* x, double* dx) {
+  double p = 1;
+  for (int i = 0; i <= N; i++)
+    p *= x[i];
+  for (int i = 0; i <= N; i++)
+    APPROX_EQ(dx[i], p / x[i], 1e-10);
+}
+
+int main(int argc, char** argv) {
+  // Frames popped out of order must stay intact until the ones above go
+  char* frames[4];
+  frames[0] = (char*)__enzyme_tape_push(48);
+  frames[1] = (char*)__enzyme_tape_push(48);
+  memset(frames[1], 1, 48);
+  __enzyme_tape_pop(frames[0]);
+  frames[2] = (char*)__enzyme_tape_push(48);
+  frames[3] = (char*)__enzyme_tape_push(48);
+  memset(frames[2], 2, 48);
+  memset(frames[3], 3, 48);
+  for (int i = 0; i < 48; i++)
+    assert(frames[1][i] == 1);
+  __enzyme_tape_pop(frames[1]);
+  __enzyme_tape_pop(frames[3]);
+  __enzyme_tape_pop(frames[2]);
+  assert(__enzyme_tape_top->used == 0);
+
+  double x[4][N + 1], dx[4][N + 1], out[4], dout[4];
+  void* tape[4];
+  for (int k = 0; k < 4; k++) {
+    for (int i = 0; i <= N; i++) {
+      x[k][i] = 1 + 0.1 * (i + 7 * k);
+      dx[k][i] = 0;
+    }
+    out[k] = 0;
+    dout[k] = 1;
+  }
+
+  // The tapes of the split mode are consumed in an order of the user's choice
+  tape[0] = __enzyme_augmentfwd((void*)prod, x[0], dx[0], &out[0], &dout[0], N);
+  tape[1] = __enzyme_augmentfwd((void*)prod, x[1], dx[1], &out[1], &dout[1], N);
+  __enzyme_reverse((void*)prod, x[0], dx[0], &out[0], &dout[0], N, tape[0]);
+  tape[2] = __enzyme_augmentfwd((void*)prod, x[2], dx[2], &out[2], &dout[2], N);
+  tape[3] = __enzyme_augmentfwd((void*)prod, x[3], dx[3], &out[3], &dout[3], N);
+  __enzyme_reverse((void*)prod, x[1], dx[1], &out[1], &dout[1], N, tape[1]);
+  __enzyme_reverse((void*)prod, x[3], dx[3], &out[3], &dout[3], N, tape[3]);
+  __enzyme_reverse((void*)prod, x[2], dx[2], &out[2], &dout[2], N, tape[2]);
+  for (int k = 0; k < 4; k++)
+    check(x[k], dx[k]);
+
+  for (int i = 0; i <= N; i++)
+    dx[0][i] = 0;
+  dout[0] = 1;
+  __enzyme_autodiff((void*)prod, x[0], dx[0], &out[0], &dout[0], N);
+  check(x[0], dx[0]);
+  assert(__enzyme_tape_top->used == 0);
+
+  printf("dx[0]=%f dx[%d]=%f\n", dx[0][0], N, dx[0][N]);
+  return 0;
+}
@@ -0,0 +1,22 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @inactive(%x : f64, %y : f64) -> f64 {
+    %ysq = arith.mulf %y, %y : f64
+    %unused = arith.mulf %x, %x : f64
+    %r = arith.mulf %x, %ysq : f64
+    return %r : f64
+  }
+  func.func @dinactive(%x : f64, %dx : f64, %y : f64) -> f64 {
+    %r = enzyme.fwddiff @inactive(%x, %dx, %y) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_const>] } : (f64, f64, f64) -> (f64)
+    return %r : f64
+  }
+}
+
+// CHECK:   func.func private @fwddiffeinactive(%[[x:.+]]: f64, %[[dx:.+]]: f64, %[[y:.+]]: f64) -> f64 {
+// CHECK-NEXT:     %[[ysq:.+]] = arith.mulf %[[y]], %[[y]] : f64
+// CHECK-NEXT:     %{{.+}} = arith.mulf %[[x]], %[[x]] : f64
+// CHECK-NEXT:     %[[dr:.+]] = arith.mulf %[[dx]], %[[ysq]] : f64
+// CHECK-NEXT:     %{{.+}} = arith.mulf %[[x]], %[[ysq]] : f64
+// CHECK-NEXT:     return %[[dr]] : f64
+// CHECK-NEXT:   }
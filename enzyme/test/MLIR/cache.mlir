@@ -0,0 +1,43 @@
+// RUN: %eopt --convert-enzyme-to-memref %s | FileCheck %s
+
+module {
+  func.func @static_cache(%x : f64) -> f64 {
+    %cache = "enzyme.init"() : () -> !enzyme.Cache<f64>
+    %c0 = arith.constant 0 : index
+    %c2 = arith.constant 2 : index
+    %c10 = arith.constant 10 : index
+    scf.for %i = %c0 to %c10 step %c2 {
+      "enzyme.push"(%cache, %x) : (!enzyme.Cache<f64>, f64) -> ()
+    }
+    %r = "enzyme.pop"(%cache) : (!enzyme.Cache<f64>) -> f64
+    return %r : f64
+  }
+
+  func.func @dynamic_cache(%x : f64, %n : index) -> f64 {
+    %cache = "enzyme.init"() : () -> !enzyme.Cache<f64>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    scf.for %i = %c0 to %n step %c1 {
+      "enzyme.push"(%cache, %x) : (!enzyme.Cache<f64>, f64) -> ()
+    }
+    %r = "enzyme.pop"(%cache) : (!enzyme.Cache<f64>) -> f64
+    return %r : f64
+  }
+}
+
+// CHECK-NOT: func.func private @__enzyme_push
+// CHECK-LABEL: func.func @static_cache
+// CHECK:         %[[cap:.+]] = arith.constant 5 : index
+// CHECK:         memref.alloc(%[[cap]]) : memref<?xf64>
+// CHECK-NOT:     scf.if
+// CHECK-NOT:     cf.assert
+// CHECK-NOT:     call
+// CHECK:         return
+
+// CHECK-LABEL: func.func @dynamic_cache
+// CHECK:         scf.for
+// CHECK:           scf.if
+// CHECK:             memref.copy
+// CHECK:         cf.assert
+// CHECK-NOT:     call
+// CHECK:         return
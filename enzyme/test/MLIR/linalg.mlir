@@ -0,0 +1,134 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @matmul(%a : memref<4x8xf64>, %b : memref<8x4xf64>, %c : memref<4x4xf64>) {
+    linalg.matmul ins(%a, %b : memref<4x8xf64>, memref<8x4xf64>) outs(%c : memref<4x4xf64>)
+    return
+  }
+  func.func @dmatmul(%a : memref<4x8xf64>, %da : memref<4x8xf64>, %b : memref<8x4xf64>, %db : memref<8x4xf64>, %c : memref<4x4xf64>, %dc : memref<4x4xf64>) {
+    enzyme.fwddiff @matmul(%a, %da, %b, %db, %c, %dc) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>] } : (memref<4x8xf64>, memref<4x8xf64>, memref<8x4xf64>, memref<8x4xf64>, memref<4x4xf64>, memref<4x4xf64>) -> ()
+    return
+  }
+  func.func @rmatmul(%a : memref<4x8xf64>, %b : memref<8x4xf64>, %c : memref<4x4xf64>) {
+    linalg.matmul ins(%a, %b : memref<4x8xf64>, memref<8x4xf64>) outs(%c : memref<4x4xf64>)
+    return
+  }
+  func.func @drmatmul(%a : memref<4x8xf64>, %da : memref<4x8xf64>, %b : memref<8x4xf64>, %db : memref<8x4xf64>, %c : memref<4x4xf64>, %dc : memref<4x4xf64>) {
+    enzyme.autodiff @rmatmul(%a, %da, %b, %db, %c, %dc) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>] } : (memref<4x8xf64>, memref<4x8xf64>, memref<8x4xf64>, memref<8x4xf64>, memref<4x4xf64>, memref<4x4xf64>) -> ()
+    return
+  }
+
+  func.func @product(%a : memref<8xf64>, %b : memref<8xf64>, %c : memref<8xf64>) {
+    linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%a, %b : memref<8xf64>, memref<8xf64>) outs(%c : memref<8xf64>) {
+    ^bb0(%x : f64, %y : f64, %out : f64):
+      %p = arith.mulf %x, %y : f64
+      linalg.yield %p : f64
+    }
+    return
+  }
+  func.func @dproduct(%a : memref<8xf64>, %da : memref<8xf64>, %b : memref<8xf64>, %c : memref<8xf64>, %dc : memref<8xf64>) {
+    enzyme.autodiff @product(%a, %da, %b, %c, %dc) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_const>, #enzyme<activity enzyme_dup>] } : (memref<8xf64>, memref<8xf64>, memref<8xf64>, memref<8xf64>, memref<8xf64>) -> ()
+    return
+  }
+
+  func.func @sumsq(%x : memref<8xf64>, %s : memref<f64>) {
+    linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> ()>], iterator_types = ["reduction"]} ins(%x : memref<8xf64>) outs(%s : memref<f64>) {
+    ^bb0(%v : f64, %acc : f64):
+      %sq = arith.mulf %v, %v : f64
+      %sum = arith.addf %acc, %sq : f64
+      linalg.yield %sum : f64
+    }
+    return
+  }
+  func.func @dsumsq(%x : memref<8xf64>, %dx : memref<8xf64>, %s : memref<f64>, %ds : memref<f64>) {
+    enzyme.autodiff @sumsq(%x, %dx, %s, %ds) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>] } : (memref<8xf64>, memref<8xf64>, memref<f64>, memref<f64>) -> ()
+    return
+  }
+
+  func.func @conv(%in : memref<10xf64>, %f : memref<3xf64>, %out : memref<8xf64>) {
+    linalg.conv_1d ins(%in, %f : memref<10xf64>, memref<3xf64>) outs(%out : memref<8xf64>)
+    return
+  }
+  func.func @dconv(%in : memref<10xf64>, %din : memref<10xf64>, %f : memref<3xf64>, %df : memref<3xf64>, %out : memref<8xf64>, %dout : memref<8xf64>) {
+    enzyme.autodiff @conv(%in, %din, %f, %df, %out, %dout) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>, #enzyme<activity enzyme_dup>] } : (memref<10xf64>, memref<10xf64>, memref<3xf64>, memref<3xf64>, memref<8xf64>, memref<8xf64>) -> ()
+    return
+  }
+}
+
+// CHECK-DAG: #[[mA:.+]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+// CHECK-DAG: #[[mB:.+]] = affine_map<(d0, d1, d2) -> (d2, d1)>
+// CHECK-DAG: #[[mC:.+]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-DAG: #[[id:.+]] = affine_map<(d0) -> (d0)>
+// CHECK-DAG: #[[scalar:.+]] = affine_map<(d0) -> ()>
+// CHECK-DAG: #[[cin:.+]] = affine_map<(d0, d1) -> (d0 + d1)>
+// CHECK-DAG: #[[cf:.+]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-DAG: #[[cout:.+]] = affine_map<(d0, d1) -> (d0)>
+
+// CHECK-LABEL: func.func private @fwddiffematmul
+// CHECK:         linalg.generic
+// CHECK-SAME:      iterator_types = ["parallel", "parallel", "reduction"]
+// CHECK:           arith.mulf
+// CHECK:           arith.addf
+// CHECK:           linalg.yield
+// CHECK:         linalg.matmul
+// CHECK-NOT:     enzyme.placeholder
+// CHECK:         return
+
+// The adjoints of a matmul are matmuls against the output shadow with
+// transposed maps: dA += dC * B^T reduces over the columns of C, dB += A^T * dC
+// over its rows.
+// CHECK-LABEL: func.func private @differmatmul
+// CHECK:         linalg.matmul
+// CHECK:         linalg.generic {indexing_maps = [#[[mA]], #[[mB]], #[[mC]], #[[mA]]], iterator_types = ["parallel", "reduction", "parallel"]}
+// CHECK-NEXT:    ^bb0(%[[a:.+]]: f64, %[[b:.+]]: f64, %[[dc:.+]]: f64, %[[da:.+]]: f64):
+// CHECK:           %[[t:.+]] = arith.mulf %[[dc]], %[[b]] : f64
+// CHECK:           %[[acc:.+]] = arith.addf %[[da]], %[[t]] : f64
+// CHECK:           linalg.yield %[[acc]] : f64
+// CHECK:         linalg.generic {indexing_maps = [#[[mA]], #[[mB]], #[[mC]], #[[mB]]], iterator_types = ["reduction", "parallel", "parallel"]}
+// CHECK-NEXT:    ^bb0(%[[a2:.+]]: f64, %[[b2:.+]]: f64, %[[dc2:.+]]: f64, %[[db:.+]]: f64):
+// CHECK:           %[[t2:.+]] = arith.mulf %[[dc2]], %[[a2]] : f64
+// CHECK:           %[[acc2:.+]] = arith.addf %[[db]], %[[t2]] : f64
+// CHECK:           linalg.yield %[[acc2]] : f64
+// The matmul accumulates into its output, whose gradient passes through.
+// CHECK-NOT:     linalg.fill
+// CHECK:         return
+
+// The output is overwritten, its previous value gets no gradient.
+// CHECK-LABEL: func.func private @diffeproduct
+// CHECK:         linalg.generic {indexing_maps = [#[[id]], #[[id]], #[[id]], #[[id]]], iterator_types = ["parallel"]}
+// CHECK-NEXT:    ^bb0(%[[x:.+]]: f64, %[[y:.+]]: f64, %[[dp:.+]]: f64, %[[dx:.+]]: f64):
+// CHECK:           %[[t:.+]] = arith.mulf %[[dp]], %[[y]] : f64
+// CHECK:           arith.addf %[[dx]], %[[t]] : f64
+// CHECK-NOT:     linalg.generic
+// CHECK:         linalg.fill
+// CHECK:         return
+
+// The reduction loop becomes parallel in the adjoint, which broadcasts the
+// gradient of the sum. The accumulated output keeps its gradient.
+// CHECK-LABEL: func.func private @diffesumsq
+// CHECK:         linalg.generic {indexing_maps = [#[[id]], #[[scalar]], #[[id]]], iterator_types = ["parallel"]}
+// CHECK-NEXT:    ^bb0(%[[v:.+]]: f64, %[[ds:.+]]: f64, %[[dv:.+]]: f64):
+// CHECK:           arith.mulf %[[ds]], %[[v]] : f64
+// CHECK:           arith.mulf %[[ds]], %[[v]] : f64
+// CHECK:           arith.addf
+// CHECK:           arith.addf %[[dv]],
+// CHECK-NOT:     linalg.fill
+// CHECK:         return
+
+// The input of a convolution is read at d0 + d1, its adjoint is scattered in
+// sequential loops. The filter adjoint is a structured reduction over the
+// output positions.
+// CHECK-LABEL: func.func private @diffeconv
+// CHECK:         linalg.conv_1d
+// CHECK:         scf.for %[[i:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK-NEXT:      scf.for %[[j:.+]] = %{{.+}} to %{{.+}} step %{{.+}} {
+// CHECK:             %[[idx:.+]] = arith.addi %[[i]], %[[j]] : index
+// CHECK:             %[[w:.+]] = memref.load %{{.+}}[%[[j]]] : memref<3xf64>
+// CHECK:             %[[dout:.+]] = memref.load %{{.+}}[%[[i]]] : memref<8xf64>
+// CHECK:             %[[t:.+]] = arith.mulf %[[dout]], %[[w]] : f64
+// CHECK:             %[[sidx:.+]] = arith.addi %[[i]], %[[j]] : index
+// CHECK:             %[[old:.+]] = memref.load %[[din:.+]][%[[sidx]]] : memref<10xf64>
+// CHECK:             %[[new:.+]] = arith.addf %[[old]], %[[t]] : f64
+// CHECK:             memref.store %[[new]], %[[din]][%[[sidx]]] : memref<10xf64>
+// CHECK:         linalg.generic {indexing_maps = [#[[cin]], #[[cf]], #[[cout]], #[[cf]]], iterator_types = ["reduction", "parallel"]}
+// CHECK:         return
@@ -0,0 +1,110 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @f(%x : f64) -> f64 {
+    %s = math.sin %x : f64
+    %e = math.exp %s : f64
+    return %e : f64
+  }
+  func.func @df(%x : f64, %dx : f64) -> f64 {
+    %r = enzyme.fwddiff @f(%x, %dx) { activity=[#enzyme<activity enzyme_dup>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+
+  func.func @g(%x : vector<4xf64>, %y : vector<4xf64>) -> vector<4xf64> {
+    %r = vector.fma %x, %y, %x : vector<4xf64>
+    return %r : vector<4xf64>
+  }
+  func.func @dg(%x : vector<4xf64>, %dx : vector<4xf64>, %y : vector<4xf64>) -> vector<4xf64> {
+    %r = enzyme.fwddiff @g(%x, %dx, %y) { activity=[#enzyme<activity enzyme_dup>, #enzyme<activity enzyme_const>] } : (vector<4xf64>, vector<4xf64>, vector<4xf64>) -> (vector<4xf64>)
+    return %r : vector<4xf64>
+  }
+
+  func.func @rexp(%x : f64) -> f64 {
+    %e = math.exp %x : f64
+    return %e : f64
+  }
+  func.func @drexp(%x : f64, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @rexp(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+
+  func.func @rlog(%x : f64) -> f64 {
+    %l = math.log %x : f64
+    return %l : f64
+  }
+  func.func @drlog(%x : f64, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @rlog(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+
+  func.func @rpowf(%x : f64, %y : f64) -> f64 {
+    %p = math.powf %x, %y : f64
+    return %p : f64
+  }
+  func.func @drpowf(%x : f64, %y : f64, %dr : f64) -> (f64, f64) {
+    %r:2 = enzyme.autodiff @rpowf(%x, %y, %dr) { activity=[#enzyme<activity enzyme_out>, #enzyme<activity enzyme_out>] } : (f64, f64, f64) -> (f64, f64)
+    return %r#0, %r#1 : f64, f64
+  }
+
+  func.func @rfma(%x : vector<4xf64>, %y : vector<4xf64>) -> vector<4xf64> {
+    %r = vector.fma %x, %y, %x : vector<4xf64>
+    return %r : vector<4xf64>
+  }
+  func.func @drfma(%x : vector<4xf64>, %y : vector<4xf64>, %dr : vector<4xf64>) -> vector<4xf64> {
+    %r = enzyme.autodiff @rfma(%x, %y, %dr) { activity=[#enzyme<activity enzyme_out>, #enzyme<activity enzyme_const>] } : (vector<4xf64>, vector<4xf64>, vector<4xf64>) -> (vector<4xf64>)
+    return %r : vector<4xf64>
+  }
+}
+
+// CHECK-LABEL: func.func private @fwddiffef
+// CHECK-SAME:      (%[[x:.+]]: f64, %[[dx:.+]]: f64) -> f64
+// CHECK:         %[[cos:.+]] = math.cos %[[x]] : f64
+// CHECK:         %[[ds:.+]] = arith.mulf %[[dx]], %[[cos]] : f64
+// CHECK:         %[[s:.+]] = math.sin %[[x]] : f64
+// CHECK:         %[[e:.+]] = math.exp %[[s]] : f64
+// CHECK:         %[[de:.+]] = arith.mulf %[[ds]], %[[e]] : f64
+// CHECK:         return %[[de]] : f64
+
+// CHECK-LABEL: func.func private @fwddiffeg
+// CHECK-SAME:      (%[[x:.+]]: vector<4xf64>, %[[dx:.+]]: vector<4xf64>, %[[y:.+]]: vector<4xf64>)
+// CHECK:         %[[d0:.+]] = arith.mulf %[[dx]], %[[y]] : vector<4xf64>
+// CHECK:         %[[d:.+]] = arith.addf %[[d0]], %[[dx]] : vector<4xf64>
+// CHECK:         vector.fma
+// CHECK:         return %[[d]] : vector<4xf64>
+
+// CHECK-LABEL: func.func private @differexp
+// CHECK-SAME:      (%[[x:.+]]: f64, %[[dr:.+]]: f64) -> f64
+// CHECK:         %[[e:.+]] = math.exp %[[x]] : f64
+// CHECK:         %[[d:.+]] = arith.mulf %[[dr]], %[[e]] : f64
+// CHECK:         %[[dx:.+]] = arith.addf %{{.+}}, %[[d]] : f64
+// CHECK:         return %[[dx]] : f64
+
+// CHECK-LABEL: func.func private @differlog
+// CHECK-SAME:      (%[[x:.+]]: f64, %[[dr:.+]]: f64) -> f64
+// CHECK:         %[[d:.+]] = arith.divf %[[dr]], %[[x]] : f64
+// CHECK:         %[[dx:.+]] = arith.addf %{{.+}}, %[[d]] : f64
+// CHECK:         return %[[dx]] : f64
+
+// CHECK-LABEL: func.func private @differpowf
+// CHECK-SAME:      (%[[x:.+]]: f64, %[[y:.+]]: f64, %[[dr:.+]]: f64) -> (f64, f64)
+// CHECK:         %[[r:.+]] = math.powf %[[x]], %[[y]] : f64
+// CHECK:         %[[t0:.+]] = arith.mulf %[[dr]], %[[y]] : f64
+// CHECK:         %[[one:.+]] = arith.constant 1.0{{.*}} : f64
+// CHECK:         %[[ym1:.+]] = arith.subf %[[y]], %[[one]] : f64
+// CHECK:         %[[p:.+]] = math.powf %[[x]], %[[ym1]] : f64
+// CHECK:         %[[d0:.+]] = arith.mulf %[[t0]], %[[p]] : f64
+// CHECK:         %[[dx:.+]] = arith.addf %{{.+}}, %[[d0]] : f64
+// CHECK:         %[[t1:.+]] = arith.mulf %[[dr]], %[[r]] : f64
+// CHECK:         %[[l:.+]] = math.log %[[x]] : f64
+// CHECK:         %[[d1:.+]] = arith.mulf %[[t1]], %[[l]] : f64
+// CHECK:         %[[dy:.+]] = arith.addf %{{.+}}, %[[d1]] : f64
+// CHECK:         return %[[dx]], %[[dy]] : f64, f64
+
+// Both uses of %x accumulate into its adjoint.
+// CHECK-LABEL: func.func private @differfma
+// CHECK-SAME:      (%[[x:.+]]: vector<4xf64>, %[[y:.+]]: vector<4xf64>, %[[dr:.+]]: vector<4xf64>) -> vector<4xf64>
+// CHECK:         %[[da:.+]] = arith.mulf %[[dr]], %[[y]] : vector<4xf64>
+// CHECK:         %[[g:.+]] = arith.addf %{{.+}}, %[[da]] : vector<4xf64>
+// CHECK:         %[[dx:.+]] = arith.addf %[[g]], %[[dr]] : vector<4xf64>
+// CHECK:         return %[[dx]] : vector<4xf64>
@@ -0,0 +1,37 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @square(%x : f64) -> f64 {
+    %y = arith.mulf %x, %x : f64
+    return %y : f64
+  }
+  func.func @cube(%x : f64) -> f64 {
+    %y = arith.mulf %x, %x : f64
+    %z = arith.mulf %y, %x : f64
+    return %z : f64
+  }
+  func.func @d1(%x : f64, %dx : f64) -> f64 {
+    %r = enzyme.fwddiff @square(%x, %dx) { activity=[#enzyme<activity enzyme_dup>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+  func.func @d2(%x : f64, %dx : f64) -> f64 {
+    %r = enzyme.fwddiff @square(%x, %dx) { activity=[#enzyme<activity enzyme_dup>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+  func.func @d3(%x : f64, %dx : f64) -> f64 {
+    %r = enzyme.fwddiff @cube(%x, %dx) { activity=[#enzyme<activity enzyme_dup>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+}
+
+// Identical requests share one derivative; derivatives are appended in the
+// order they are first requested.
+// CHECK-LABEL: func.func @d1
+// CHECK:         call @fwddiffesquare(
+// CHECK-LABEL: func.func @d2
+// CHECK:         call @fwddiffesquare(
+// CHECK-LABEL: func.func @d3
+// CHECK:         call @fwddiffecube(
+// CHECK:       func.func private @fwddiffesquare(
+// CHECK-NOT:   func.func private @fwddiffesquare
+// CHECK:       func.func private @fwddiffecube(
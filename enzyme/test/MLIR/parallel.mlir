@@ -0,0 +1,65 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @scale(%x : f64, %m : memref<4xf64>) -> f64 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    scf.parallel (%i) = (%c0) to (%c4) step (%c1) {
+      %v = arith.mulf %x, %x : f64
+      memref.store %v, %m[%i] : memref<4xf64>
+      scf.yield
+    }
+    return %x : f64
+  }
+  func.func @dscale(%x : f64, %m : memref<4xf64>, %dm : memref<4xf64>, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @scale(%x, %m, %dm, %dr) { activity=[#enzyme<activity enzyme_out>, #enzyme<activity enzyme_dup>] } : (f64, memref<4xf64>, memref<4xf64>, f64) -> (f64)
+    return %r : f64
+  }
+
+  func.func @gather(%x : f64, %m : memref<4xf64>) -> f64 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    scf.parallel (%i) = (%c0) to (%c4) step (%c1) {
+      %v = memref.load %m[%i] : memref<4xf64>
+      %w = arith.mulf %v, %x : f64
+      memref.store %w, %m[%i] : memref<4xf64>
+      scf.yield
+    }
+    return %x : f64
+  }
+  func.func @dgather(%x : f64, %m : memref<4xf64>, %dm : memref<4xf64>, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @gather(%x, %m, %dm, %dr) { activity=[#enzyme<activity enzyme_out>, #enzyme<activity enzyme_dup>] } : (f64, memref<4xf64>, memref<4xf64>, f64) -> (f64)
+    return %r : f64
+  }
+}
+
+// The adjoint loop stays parallel, recomputes each iteration and reduces the
+// gradient of the captured scalar.
+// CHECK-LABEL: func.func private @diffescale
+// CHECK:         scf.parallel
+// CHECK:         %[[red:.+]] = scf.parallel ({{.+}}) = ({{.+}}) to ({{.+}}) step ({{.+}}) init ({{.+}}) -> f64 {
+// CHECK:           arith.mulf
+// CHECK:           scf.reduce
+// CHECK:             arith.addf
+// CHECK:             scf.reduce.return
+// CHECK:         arith.addf {{.*}}%[[red]]
+
+// The loaded value is stored per iteration by the forward loop, because the
+// loop overwrites %m, and the adjoint loop reads it back instead of loading
+// %m again or replaying the store.
+// CHECK-LABEL: func.func private @diffegather
+// CHECK-SAME:      (%[[x:.+]]: f64, %[[m:.+]]: memref<4xf64>, %[[dm:.+]]: memref<4xf64>, %[[dr:.+]]: f64) -> f64
+// CHECK:         %[[buf:.+]] = memref.alloc(%{{.+}}) : memref<?xf64>
+// CHECK:         scf.parallel (%[[i:.+]]) =
+// CHECK:           %[[v:.+]] = memref.load %[[m]][%[[i]]] : memref<4xf64>
+// CHECK:           memref.store %[[v]], %[[buf]][%{{.+}}] : memref<?xf64>
+// CHECK:         scf.parallel ({{.+}}) = ({{.+}}) to ({{.+}}) step ({{.+}}) init ({{.+}}) -> f64 {
+// CHECK-NOT:       memref.load %[[m]]
+// CHECK:           %[[rv:.+]] = memref.load %[[buf]][%{{.+}}] : memref<?xf64>
+// CHECK-NOT:       memref.store %{{.+}}, %[[m]]
+// CHECK:           arith.mulf {{.*}}%[[rv]]
+// CHECK-NOT:       memref.store %{{.+}}, %[[m]]
+// CHECK:           scf.reduce
+// CHECK:         memref.dealloc %[[buf]] : memref<?xf64>
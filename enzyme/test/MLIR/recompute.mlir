@@ -0,0 +1,43 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @square(%x : f64) -> f64 {
+    %y = arith.mulf %x, %x : f64
+    %z = arith.mulf %y, %x : f64
+    return %z : f64
+  }
+  func.func @dsquare(%x : f64, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @square(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+
+  func.func @sinsq(%x : f64) -> f64 {
+    cf.br ^bb1(%x : f64)
+  ^bb1(%a : f64):
+    %s = math.sin %a : f64
+    %y = arith.mulf %s, %s : f64
+    return %y : f64
+  }
+  func.func @dsinsq(%x : f64, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @sinsq(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+}
+
+// Values of the entry block are available in the reverse pass and are never
+// cached.
+// CHECK-LABEL: func.func private @diffesquare
+// CHECK-NOT:     enzyme.push
+// CHECK-NOT:     enzyme.pop
+// CHECK:         return
+
+// Only the block argument is cached; sin is recomputed from it once.
+// CHECK-LABEL: func.func private @diffesinsq
+// CHECK:       ^bb1(%[[a:.+]]: f64):
+// CHECK:         enzyme.push{{.*}}%[[a]]
+// CHECK-NOT:     enzyme.push
+// CHECK:         enzyme.pop
+// CHECK-NOT:     enzyme.pop
+// CHECK:         math.sin
+// CHECK-NOT:     enzyme.pop
+// CHECK:         return
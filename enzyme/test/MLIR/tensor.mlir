@@ -0,0 +1,70 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @slice(%x : tensor<8xf64>) -> f64 {
+    %c0 = arith.constant 0 : index
+    %s = tensor.extract_slice %x[2] [4] [1] : tensor<8xf64> to tensor<4xf64>
+    %e = tensor.extract %s[%c0] : tensor<4xf64>
+    return %e : f64
+  }
+  func.func @dslice(%x : tensor<8xf64>, %dx : tensor<8xf64>) -> f64 {
+    %r = enzyme.fwddiff @slice(%x, %dx) { activity=[#enzyme<activity enzyme_dup>] } : (tensor<8xf64>, tensor<8xf64>) -> (f64)
+    return %r : f64
+  }
+
+  func.func @sum2(%x : tensor<8xf64>) -> f64 {
+    %c1 = arith.constant 1 : index
+    %c3 = arith.constant 3 : index
+    %a = tensor.extract %x[%c1] : tensor<8xf64>
+    %b = tensor.extract %x[%c3] : tensor<8xf64>
+    %r = arith.addf %a, %b : f64
+    return %r : f64
+  }
+  func.func @dsum2(%x : tensor<8xf64>, %dr : f64) -> tensor<8xf64> {
+    %r = enzyme.autodiff @sum2(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (tensor<8xf64>, f64) -> (tensor<8xf64>)
+    return %r : tensor<8xf64>
+  }
+
+  func.func @sum2dyn(%x : tensor<?xf64>) -> f64 {
+    %c1 = arith.constant 1 : index
+    %c3 = arith.constant 3 : index
+    %a = tensor.extract %x[%c1] : tensor<?xf64>
+    %b = tensor.extract %x[%c3] : tensor<?xf64>
+    %r = arith.addf %a, %b : f64
+    return %r : f64
+  }
+  func.func @dsum2dyn(%x : tensor<?xf64>, %dr : f64) -> tensor<?xf64> {
+    %r = enzyme.autodiff @sum2dyn(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (tensor<?xf64>, f64) -> (tensor<?xf64>)
+    return %r : tensor<?xf64>
+  }
+}
+
+// CHECK-LABEL: func.func private @fwddiffeslice
+// CHECK-SAME:      (%[[x:.+]]: tensor<8xf64>, %[[dx:.+]]: tensor<8xf64>) -> f64
+// CHECK:         %[[ds:.+]] = tensor.extract_slice %[[dx]][2] [4] [1]
+// CHECK:         %[[de:.+]] = tensor.extract %[[ds]][%{{.+}}]
+// CHECK-NOT:     memref
+// CHECK:         return %[[de]] : f64
+
+// The adjoint of a tensor is accumulated with tensor.insert into a zero
+// tensor, without introducing buffers.
+// CHECK-LABEL: func.func private @diffesum2
+// CHECK-SAME:      (%[[x:.+]]: tensor<8xf64>, %[[dr:.+]]: f64) -> tensor<8xf64>
+// CHECK:         %[[zero:.+]] = arith.constant dense<0.000000e+00> : tensor<8xf64>
+// CHECK:         %[[g1:.+]] = tensor.insert %{{.+}} into %[[zero]][%{{.+}}] : tensor<8xf64>
+// CHECK:         %[[e:.+]] = tensor.extract %[[g1]][%{{.+}}] : tensor<8xf64>
+// CHECK:         %[[s:.+]] = arith.addf %[[e]], %{{.+}} : f64
+// CHECK:         %[[g2:.+]] = tensor.insert %[[s]] into %[[g1]][%{{.+}}] : tensor<8xf64>
+// CHECK-NOT:     memref
+// CHECK:         return %[[g2]] : tensor<8xf64>
+
+// A dynamically shaped zero adjoint is sized from the cached primal sizes.
+// CHECK-LABEL: func.func private @diffesum2dyn
+// CHECK-SAME:      (%[[x:.+]]: tensor<?xf64>, %[[dr:.+]]: f64) -> tensor<?xf64>
+// CHECK:         tensor.dim %[[x]], %{{.+}} : tensor<?xf64>
+// CHECK:         %[[empty:.+]] = tensor.empty(%{{.+}}) : tensor<?xf64>
+// CHECK:         %[[zero:.+]] = linalg.fill ins(%{{.+}} : f64) outs(%[[empty]] : tensor<?xf64>) -> tensor<?xf64>
+// CHECK:         %[[g1:.+]] = tensor.insert %{{.+}} into %[[zero]][%{{.+}}] : tensor<?xf64>
+// CHECK:         %[[g2:.+]] = tensor.insert %{{.+}} into %[[g1]][%{{.+}}] : tensor<?xf64>
+// CHECK-NOT:     memref
+// CHECK:         return %[[g2]] : tensor<?xf64>
@@ -0,0 +1,38 @@
+// RUN: %eopt --enzyme %s | FileCheck %s
+
+module {
+  func.func @pow16(%x : f64) -> f64 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    %r:2 = scf.while (%i = %c0, %a = %x) : (index, f64) -> (index, f64) {
+      %cond = arith.cmpi slt, %i, %c4 : index
+      scf.condition(%cond) %i, %a : index, f64
+    } do {
+    ^bb0(%j : index, %b : f64):
+      %n = arith.addi %j, %c1 : index
+      %s = arith.mulf %b, %b : f64
+      scf.yield %n, %s : index, f64
+    }
+    return %r#1 : f64
+  }
+  func.func @dpow16(%x : f64, %dr : f64) -> f64 {
+    %r = enzyme.autodiff @pow16(%x, %dr) { activity=[#enzyme<activity enzyme_out>] } : (f64, f64) -> (f64)
+    return %r : f64
+  }
+}
+
+// The forward loop counts its iterations and caches the operand of each
+// square; the adjoint replays them in an scf.for carrying the gradient of %a.
+// CHECK-LABEL: func.func private @diffepow16
+// CHECK:         scf.while
+// CHECK:         } do {
+// CHECK:           enzyme.set
+// CHECK:           enzyme.push
+// CHECK:           arith.mulf
+// CHECK:           scf.yield
+// CHECK:         scf.for %{{.+}} = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%{{.+}} = %{{.+}}) -> (f64) {
+// CHECK:           %[[b:.+]] = enzyme.pop
+// CHECK:           arith.mulf {{.*}}%[[b]]
+// CHECK:           scf.yield %{{.+}} : f64
+// CHECK:         return
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -23,12 +24,14 @@
 
 using namespace llvm;
 
-enum ActionType { GenDerivatives };
+enum ActionType { GenDerivatives, GenMLIRDerivatives };
 
 static cl::opt<ActionType>
     action(cl::desc("Action to perform:"),
            cl::values(clEnumValN(GenDerivatives, "gen-derivatives",
-                                 "Generate instruction derivative")));
+                                 "Generate instruction derivative"),
+                      clEnumValN(GenMLIRDerivatives, "gen-mlir-derivatives",
+                                 "Generate MLIR op derivative interfaces")));
 
 bool hasDiffeRet(Init *resultTree) {
   if (DagInit *resultRoot = dyn_cast<DagInit>(resultTree)) {
@@ -510,11 +513,286 @@ static void emitDerivatives(const RecordKeeper &recordKeeper, raw_ostream &os) {
   }
 }
 
+// Collects the names of the matched operands and result that `tree` reads.
+static void collectUsedNames(Init *tree, StringSet<> &names) {
+  DagInit *root = dyn_cast<DagInit>(tree);
+  if (!root)
+    return;
+  for (auto zp : llvm::zip(root->getArgs(), root->getArgNames())) {
+    if (isa<UnsetInit>(std::get<0>(zp)) && std::get<1>(zp))
+      names.insert(std::get<1>(zp)->getAsUnquotedString());
+    else
+      collectUsedNames(std::get<0>(zp), names);
+  }
+}
+
+// Emits the MLIR ops computing `tree` with `builder` and returns the name of
+// the C++ variable holding the result.
+static std::string emitMLIRExpr(raw_ostream &os, Record *pattern, Init *tree,
+                                StringMap<std::string> &nameToValue,
+                                unsigned &tmpCount) {
+  DagInit *root = dyn_cast<DagInit>(tree);
+  if (!root)
+    PrintFatalError(pattern->getLoc(),
+                    Twine("unknown dag ") + tree->getAsString());
+  auto opName = root->getOperator()->getAsString();
+  auto Def = cast<DefInit>(root->getOperator())->getDef();
+
+  auto lookupName = [&](StringRef name) -> std::string {
+    auto found = nameToValue.find(name);
+    if (found == nameToValue.end())
+      PrintFatalError(pattern->getLoc(), Twine("unknown named operand '") +
+                                             name + "'" +
+                                             tree->getAsString());
+    return found->getValue();
+  };
+
+  if (opName == "DiffeRet" || Def->isSubClassOf("DiffeRet"))
+    return "dif";
+
+  std::string res = "tmp" + std::to_string(tmpCount++);
+  if (opName == "ConstantFP" || Def->isSubClassOf("ConstantFP")) {
+    if (root->getNumArgs() != 1 || !root->getArgName(0))
+      PrintFatalError(pattern->getLoc(),
+                      Twine("constantfp takes a single named operand ") +
+                          tree->getAsString());
+    os << "      Value " << res
+       << " = mlir::enzyme::detail::createConstantFP(builder, op->getLoc(), "
+       << lookupName(root->getArgNameStr(0)) << ".getType(), \""
+       << Def->getValueAsString("value") << "\");\n";
+    return res;
+  }
+
+  if (!Def->isSubClassOf("MLIRInst"))
+    PrintFatalError(pattern->getLoc(),
+                    Twine("unknown operation ") + tree->getAsString());
+
+  SmallVector<std::string, 3> args;
+  StringMap<std::string> oldNames;
+  for (auto zp : llvm::zip(root->getArgs(), root->getArgNames())) {
+    if (isa<UnsetInit>(std::get<0>(zp)) && std::get<1>(zp)) {
+      args.push_back(lookupName(std::get<1>(zp)->getAsUnquotedString()));
+      continue;
+    }
+    args.push_back(
+        emitMLIRExpr(os, pattern, std::get<0>(zp), nameToValue, tmpCount));
+    if (std::get<1>(zp)) {
+      auto name = std::get<1>(zp)->getAsUnquotedString();
+      oldNames.try_emplace(name, nameToValue.lookup(name));
+      nameToValue[name] = args.back();
+    }
+  }
+  for (auto &pair : oldNames) {
+    if (pair.second.size())
+      nameToValue[pair.getKey()] = pair.second;
+    else
+      nameToValue.erase(pair.getKey());
+  }
+
+  os << "      Value " << res << " = builder.create<"
+     << Def->getValueAsString("dialect") << "::"
+     << Def->getValueAsString("opName") << ">(op->getLoc()";
+  for (auto &arg : args)
+    os << ", " << arg;
+  os << ");\n";
+  return res;
+}
+
+// Emits forward and reverse AutoDiffOpInterface external models for every
+// MLIRDerivative, together with a `registerInterfaces` function attaching
+// them to their ops.
+static void emitMLIRDerivatives(const RecordKeeper &recordKeeper,
+                                raw_ostream &os) {
+  emitSourceFileHeader("MLIR Derivatives", os);
+  const auto &patterns =
+      recordKeeper.getAllDerivedDefinitions("MLIRDerivative");
+
+  std::vector<std::pair<std::string, std::string>> attachments;
+  for (Record *pattern : patterns) {
+    DagInit *tree = pattern->getValueAsDag("PatternToMatch");
+    for (auto arg : tree->getArgs()) {
+      if (isa<DagInit>(arg))
+        PrintFatalError(pattern->getLoc(),
+                        "only single pattern inputs supported");
+    }
+    ListInit *argOps = pattern->getValueAsListInit("ArgDerivatives");
+    if (argOps->size() != tree->getNumArgs())
+      PrintFatalError(pattern->getLoc(),
+                      "expected one derivative per operand");
+
+    auto dialect = pattern->getValueAsString("dialect");
+    auto opName = pattern->getValueAsString("opName");
+    std::string opType = (dialect + "::" + opName).str();
+    std::string structName =
+        (Twine(toUpper(dialect[0])) + dialect.drop_front() + opName).str();
+    std::string resultName = tree->getNameStr().str();
+
+    // Operand `i` is read by the derivatives of the listed operands.
+    StringMap<SmallVector<size_t, 2>> readers;
+    for (auto argOpEn : llvm::enumerate(*argOps)) {
+      StringSet<> used;
+      collectUsedNames(argOpEn.value(), used);
+      for (auto &name : used)
+        readers[name.getKey()].push_back(argOpEn.index());
+    }
+    auto emitNeeded = [&](StringRef name) {
+      bool first = true;
+      for (size_t reader : readers.lookup(name)) {
+        os << (first ? "" : " ||\n        ")
+           << "!gutils->isConstantValue(op->getOperand(" << reader << "))";
+        first = false;
+      }
+    };
+
+    // Forward mode.
+    os << "struct " << structName << "FwdDerivative\n"
+       << "    : public AutoDiffOpInterface::ExternalModel<" << structName
+       << "FwdDerivative,\n"
+       << "                                                " << opType
+       << "> {\n"
+       << "  LogicalResult createForwardModeTangent(Operation *op, "
+          "OpBuilder &builder,\n"
+       << "                                         MGradientUtils *gutils) "
+          "const {\n"
+       << "    if (!gutils->isConstantValue(op->getResult(0))) {\n";
+    if (!resultName.empty())
+      os << "      builder.setInsertionPointAfter("
+            "gutils->getNewFromOriginal(op));\n";
+    os << "      auto iface = op->getResult(0).getType()"
+          ".cast<AutoDiffTypeInterface>();\n"
+       << "      Value res = nullptr;\n";
+
+    StringMap<std::string> nameToValue;
+    for (size_t i = 0, e = tree->getNumArgs(); i != e; ++i)
+      nameToValue[tree->getArgNameStr(i)] =
+          "gutils->getNewFromOriginal(op->getOperand(" + std::to_string(i) +
+          "))";
+    if (!resultName.empty())
+      nameToValue[resultName] = "gutils->getNewFromOriginal(op->getResult(0))";
+
+    unsigned tmpCount = 0;
+    for (auto argOpEn : llvm::enumerate(*argOps)) {
+      size_t argIdx = argOpEn.index();
+      os << "      if (!gutils->isConstantValue(op->getOperand(" << argIdx
+         << "))) {\n"
+         << "      Value dif = gutils->invertPointerM(op->getOperand(" << argIdx
+         << "), builder);\n";
+      std::string tmp =
+          emitMLIRExpr(os, pattern, argOpEn.value(), nameToValue, tmpCount);
+      os << "      res = res ? iface.createAddOp(builder, op->getLoc(), res, "
+         << tmp << ") : " << tmp << ";\n"
+         << "      }\n";
+    }
+    os << "      if (!res)\n"
+       << "        res = iface.createNullValue(builder, op->getLoc());\n"
+       << "      gutils->setDiffe(op->getResult(0), res, builder);\n"
+       << "    }\n"
+       << "    gutils->eraseIfUnused(op);\n"
+       << "    return success();\n"
+       << "  }\n"
+       << "};\n\n";
+
+    // Reverse mode. Primal values read by the derivatives of active operands
+    // are cached in the forward pass and popped in the same order.
+    SmallVector<std::pair<std::string, std::string>, 3> cached;
+    for (size_t i = 0, e = tree->getNumArgs(); i != e; ++i)
+      if (readers.count(tree->getArgNameStr(i)))
+        cached.emplace_back(tree->getArgNameStr(i).str(),
+                            "gutils->getNewFromOriginal(op->getOperand(" +
+                                std::to_string(i) + "))");
+    if (!resultName.empty() && readers.count(resultName))
+      cached.emplace_back(resultName, "newOp->getResult(0)");
+
+    os << "struct " << structName << "RevDerivative\n"
+       << "    : public ReverseAutoDiffOpInterface::ExternalModel<\n"
+       << "          " << structName << "RevDerivative, " << opType
+       << "> {\n"
+       << "  void createReverseModeAdjoint(Operation *op, OpBuilder &builder,\n"
+       << "                                MGradientUtilsReverse *gutils,\n"
+       << "                                SmallVector<Value> caches) const "
+          "{\n"
+       << "    if (!gutils->hasInvertPointer(op->getResult(0)))\n"
+       << "      return;\n"
+       << "    Value dif = gutils->invertPointerM(op->getResult(0), builder);\n"
+       << "    unsigned cacheIdx = 0;\n";
+
+    nameToValue.clear();
+    for (auto &pair : cached) {
+      std::string var = "primal_" + pair.first;
+      nameToValue[pair.first] = var;
+      os << "    Value " << var << " = nullptr;\n"
+         << "    if (";
+      emitNeeded(pair.first);
+      os << ")\n"
+         << "      " << var
+         << " = gutils->popCache(caches[cacheIdx++], builder);\n";
+    }
+    os << "    (void)cacheIdx;\n";
+
+    tmpCount = 0;
+    for (auto argOpEn : llvm::enumerate(*argOps)) {
+      size_t argIdx = argOpEn.index();
+      std::string operand = "op->getOperand(" + std::to_string(argIdx) + ")";
+      os << "    if (!gutils->isConstantValue(" << operand << ")) {\n";
+      std::string tmp =
+          emitMLIRExpr(os, pattern, argOpEn.value(), nameToValue, tmpCount);
+      os << "      Value gradient = " << tmp << ";\n"
+         << "      if (gutils->hasInvertPointer(" << operand << "))\n"
+         << "        gradient = " << operand
+         << ".getType().cast<AutoDiffTypeInterface>().createAddOp(\n"
+         << "            builder, op->getLoc(),\n"
+         << "            gutils->invertPointerM(" << operand
+         << ", builder), gradient);\n"
+         << "      gutils->mapInvertPointer(" << operand
+         << ", gradient, builder);\n"
+         << "    }\n";
+    }
+    os << "  }\n\n"
+       << "  SmallVector<Value> cacheValues(Operation *op,\n"
+       << "                                 MGradientUtilsReverse *gutils) "
+          "const {\n"
+       << "    SmallVector<Value> caches;\n"
+       << "    if (!gutils->hasInvertPointer(op->getResult(0)))\n"
+       << "      return caches;\n"
+       << "    Operation *newOp = gutils->getNewFromOriginal(op);\n"
+       << "    OpBuilder cacheBuilder(newOp);\n"
+       << "    (void)cacheBuilder;\n";
+    for (auto &pair : cached) {
+      if (pair.first == resultName)
+        os << "    cacheBuilder.setInsertionPointAfter(newOp);\n";
+      os << "    if (";
+      emitNeeded(pair.first);
+      os << ")\n"
+         << "      caches.push_back(gutils->initAndPushCache(" << pair.second
+         << ", cacheBuilder));\n";
+    }
+    os << "    return caches;\n"
+       << "  }\n\n"
+       << "  void createShadowValues(Operation *op, OpBuilder &builder,\n"
+       << "                          MGradientUtilsReverse *gutils) const {}\n"
+       << "};\n\n";
+
+    attachments.emplace_back(opType, structName);
+  }
+
+  os << "void registerInterfaces(MLIRContext *context) {\n";
+  for (auto &pair : attachments) {
+    os << "  " << pair.first << "::attachInterface<" << pair.second
+       << "FwdDerivative>(*context);\n";
+    os << "  " << pair.first << "::attachInterface<" << pair.second
+       << "RevDerivative>(*context);\n";
+  }
+  os << "}\n";
+}
+
 static bool EnzymeTableGenMain(raw_ostream &os, RecordKeeper &records) {
   switch (action) {
   case GenDerivatives:
     emitDerivatives(records, os);
     return false;
+  case GenMLIRDerivatives:
+    emitMLIRDerivatives(records, os);
+    return false;
 
   default:
     llvm::errs() << "unknown tablegen action!\n";